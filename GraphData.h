@@ -3,6 +3,8 @@
 #include <QString>
 #include <QVector>
 #include <QMap>
+#include <algorithm>
+#include <cmath>
 
 // 1. 节点类型
 enum class NodeType {
@@ -17,8 +19,8 @@ enum class NodeCategory {
     Classroom, Hotel, BusStation
 };
 
-// 3. 边类型
-enum class EdgeType {
+// 3. 边类型（1 字节，邻接表里与量化后的长度、坡度挤在一起）
+enum class EdgeType : quint8 {
     Normal = 0, Main = 1, Path = 2, Indoor = 3, Stairs = 4
 };
 
@@ -56,6 +58,9 @@ namespace Config {
     
     // 阈值
     const double SLOPE_THRESHOLD = 0.05;    // 坡度阈值 5%
+
+    // 地图比例尺
+    const double METERS_PER_PIXEL = 0.91;   // 1 像素 = 0.91 米
 }
 
 struct Node {
@@ -117,4 +122,44 @@ struct Edge {
     double slope;
     QString name;
     QString description;
-};
\ No newline at end of file
+    int id = -1;            // 稳定的道路 ID（由 GraphModel 分配，-1 表示未入库或已删除）
+};
+
+// 8. 邻接表中的道路：只含寻路要用的字段，量化后 24 字节（原先两个 double 时 40 字节）
+//    名称、描述等显示用字符串只在道路表中存一份，需要时按 id 查
+//    长度按厘米、坡度按千分比取整：0.91 米/像素的地图用不到 double 的精度；
+//    寻路累加时换回 double，路径总长按厘米整数累加，结果在显示精度内不变
+//    是否陡坡在量化前判定，存在 type 后面的空闲字节里：0.0504 取整成 50‰ 后不再超过阈值
+struct AdjEdge {
+    int u, v;               // 本侧端点 -> 对侧端点（节点 ID）
+    int id;                 // 道路 ID（正反两份相同）
+    int to;                 // 对侧端点的稠密下标（见 NodeTable），对侧节点不在内存中时为 -1
+    quint32 distanceCm;     // 长度（厘米）
+    qint16 slopePermille;   // 沿 u -> v 方向的坡度（千分比）
+    EdgeType type;
+    bool steep;             // |坡度| 超过 Config::SLOPE_THRESHOLD（按原始坡度判定，正反两份相同）
+
+    double distance() const { return distanceCm * 0.01; }
+    double slope() const { return slopePermille * 0.001; }
+
+    static quint32 quantizeDistance(double meters) {
+        return static_cast<quint32>(std::lround(std::max(0.0, meters) * 100.0));
+    }
+    static qint16 quantizeSlope(double slope) {
+        return static_cast<qint16>(std::clamp(std::lround(slope * 1000.0), -32767L, 32767L));
+    }
+    static bool isSteep(double slope) {
+        return std::abs(slope) > Config::SLOPE_THRESHOLD;
+    }
+
+    static AdjEdge forward(const Edge& e) {
+        return { e.u, e.v, e.id, -1, quantizeDistance(e.distance), quantizeSlope(e.slope), e.type, isSteep(e.slope) };
+    }
+    static AdjEdge backward(const Edge& e) {
+        return { e.v, e.u, e.id, -1, quantizeDistance(e.distance), quantizeSlope(-e.slope), e.type, isSteep(e.slope) };
+    }
+};
+
+// 邻接表：节点稠密下标 -> 从该节点出发的道路（每条道路正反两个方向各一份）
+// 下标与 NodeTable 一致，空位（已删除的节点）对应空列表
+using AdjacencyList = QVector<QVector<AdjEdge>>;
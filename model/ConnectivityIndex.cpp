@@ -0,0 +1,287 @@
+// ============================================================
+// ConnectivityIndex.cpp - 按交通方式维护的连通分量
+// 增加道路增量合并，删除道路惰性重建；另提供孤岛与桥的线性时间分析
+// ============================================================
+
+#include "ConnectivityIndex.h"
+#include "EdgeAccess.h"
+#include <algorithm>
+
+// ============================================================
+// 档案划分（通行规则取自 EdgeAccess::profileMask，与寻路一致）
+// ============================================================
+ConnectivityProfile ConnectivityIndex::profileFor(TransportMode mode)
+{
+    if (mode == TransportMode::SharedBike || mode == TransportMode::EBike)
+    {
+        return ConnectivityProfile::Vehicle;
+    }
+    return ConnectivityProfile::Foot;
+}
+
+bool ConnectivityIndex::allows(ConnectivityProfile profile, EdgeType type)
+{
+    TransportMode mode = (profile == ConnectivityProfile::Vehicle) ? TransportMode::SharedBike : TransportMode::Walk;
+    return (EdgeAccess::profileMask(mode, Weather::Sunny) & edgeTypeBit(type)) != 0;
+}
+
+// ============================================================
+// 增量维护
+// ============================================================
+void ConnectivityIndex::edgeInserted(const AdjEdge& edge)
+{
+    for (int p = 0; p < kProfileCount; ++p)
+    {
+        UnionFind& uf = m_sets[p];
+        if (uf.stale || !allows(static_cast<ConnectivityProfile>(p), edge.type))
+        {
+            continue;
+        }
+
+        // 刚删掉的道路又插回来：连通关系与删除前相同，合并早已做过
+        if (uf.pendingRemovals.remove(pairKey(edge.u, edge.v)))
+        {
+            continue;
+        }
+        unite(uf, edge.u, edge.v);
+    }
+}
+
+void ConnectivityIndex::edgeRemoved(const AdjEdge& edge)
+{
+    for (int p = 0; p < kProfileCount; ++p)
+    {
+        UnionFind& uf = m_sets[p];
+        if (uf.stale || !allows(static_cast<ConnectivityProfile>(p), edge.type))
+        {
+            continue;
+        }
+        uf.pendingRemovals.insert(pairKey(edge.u, edge.v));
+    }
+}
+
+void ConnectivityIndex::invalidate()
+{
+    for (UnionFind& uf : m_sets)
+    {
+        uf.parent.clear();
+        uf.rank.clear();
+        uf.pendingRemovals.clear();
+        uf.stale = true;
+    }
+}
+
+// ============================================================
+// 查询
+// ============================================================
+int ConnectivityIndex::componentOf(ConnectivityProfile profile, int nodeId,
+                                   const AdjacencyList& adj)
+{
+    refresh(profile, adj);
+    return find(m_sets[static_cast<int>(profile)], nodeId);
+}
+
+bool ConnectivityIndex::connected(ConnectivityProfile profile, int a, int b,
+                                  const AdjacencyList& adj)
+{
+    if (a == b)
+    {
+        return true;
+    }
+    return componentOf(profile, a, adj) == componentOf(profile, b, adj);
+}
+
+QSet<int> ConnectivityIndex::islandNodes(ConnectivityProfile profile, const QList<int>& nodeIds,
+                                         const AdjacencyList& adj)
+{
+    refresh(profile, adj);
+    UnionFind& uf = m_sets[static_cast<int>(profile)];
+
+    // 统计各分量大小，找出最大的那个（主路网）
+    QHash<int, int> sizes;
+    for (int id : nodeIds)
+    {
+        sizes[find(uf, id)]++;
+    }
+
+    int mainRoot = -1;
+    int mainSize = 0;
+    for (auto it = sizes.cbegin(); it != sizes.cend(); ++it)
+    {
+        if (it.value() > mainSize)
+        {
+            mainSize = it.value();
+            mainRoot = it.key();
+        }
+    }
+
+    QSet<int> islands;
+    for (int id : nodeIds)
+    {
+        if (find(uf, id) != mainRoot)
+        {
+            islands.insert(id);
+        }
+    }
+    return islands;
+}
+
+// ============================================================
+// 桥（割边）检测：迭代式 Tarjan
+// low[x] = x 的 DFS 子树经过至多一条回边能到达的最小发现序；
+// 树边 p-x 满足 low[x] > disc[p] 时，x 子树只能经过这条边与外界相连
+// ============================================================
+QVector<int> ConnectivityIndex::findBridges(ConnectivityProfile profile,
+                                            const AdjacencyList& adj)
+{
+    struct Frame
+    {
+        int node;           ///< 当前节点（稠密下标）
+        int viaEdgeId;      ///< 进入该节点的树边（根为 -1）
+        int next;           ///< 下一个要检查的邻居下标
+    };
+
+    // 发现序与 low 值按稠密下标存放，-1 表示尚未访问
+    QVector<int> disc(adj.size(), -1);
+    QVector<int> low(adj.size(), -1);
+
+    QVector<int> bridges;
+    QVector<Frame> stack;
+    int timer = 0;
+
+    for (int root = 0; root < adj.size(); ++root)
+    {
+        if (disc[root] >= 0 || adj[root].isEmpty())
+        {
+            continue;
+        }
+
+        disc[root] = timer;
+        low[root] = timer;
+        ++timer;
+        stack.append({root, -1, 0});
+
+        while (!stack.isEmpty())
+        {
+            Frame& top = stack.last();
+            const QVector<AdjEdge>& list = adj[top.node];
+
+            if (top.next < list.size())
+            {
+                const AdjEdge& e = list[top.next++];
+                // 按道路 ID 跳过来时的那条边（正反两份共用同一个 ID）；对侧不在内存中的道路走不通
+                if (!allows(profile, e.type) || e.id == top.viaEdgeId || e.to < 0)
+                {
+                    continue;
+                }
+
+                if (disc[e.to] >= 0)
+                {
+                    low[top.node] = std::min(low[top.node], disc[e.to]);
+                }
+                else
+                {
+                    disc[e.to] = timer;
+                    low[e.to] = timer;
+                    ++timer;
+                    stack.append({e.to, e.id, 0});   // top 引用此后失效
+                }
+                continue;
+            }
+
+            // 子树处理完毕，把 low 回传给父节点
+            const Frame done = stack.takeLast();
+            if (stack.isEmpty())
+            {
+                continue;
+            }
+            int parent = stack.last().node;
+            low[parent] = std::min(low[parent], low[done.node]);
+            if (low[done.node] > disc[parent])
+            {
+                bridges.append(done.viaEdgeId);
+            }
+        }
+    }
+    return bridges;
+}
+
+// ============================================================
+// 并查集
+// ============================================================
+quint64 ConnectivityIndex::pairKey(int u, int v)
+{
+    if (u > v)
+    {
+        std::swap(u, v);
+    }
+    return (static_cast<quint64>(static_cast<quint32>(u)) << 32) | static_cast<quint32>(v);
+}
+
+int ConnectivityIndex::find(UnionFind& uf, int id)
+{
+    int root = id;
+    for (auto it = uf.parent.constFind(root); it != uf.parent.cend(); it = uf.parent.constFind(root))
+    {
+        root = it.value();
+    }
+
+    // 路径压缩
+    while (id != root)
+    {
+        auto it = uf.parent.find(id);
+        id = it.value();
+        it.value() = root;
+    }
+    return root;
+}
+
+void ConnectivityIndex::unite(UnionFind& uf, int a, int b)
+{
+    int ra = find(uf, a);
+    int rb = find(uf, b);
+    if (ra == rb)
+    {
+        return;
+    }
+
+    // 按秩合并
+    int rankA = uf.rank.value(ra);
+    int rankB = uf.rank.value(rb);
+    if (rankA < rankB)
+    {
+        std::swap(ra, rb);
+    }
+    uf.parent.insert(rb, ra);
+    uf.rank.remove(rb);
+    if (rankA == rankB)
+    {
+        uf.rank[ra] = rankA + 1;
+    }
+}
+
+void ConnectivityIndex::refresh(ConnectivityProfile profile, const AdjacencyList& adj)
+{
+    UnionFind& uf = m_sets[static_cast<int>(profile)];
+    if (!uf.stale && uf.pendingRemovals.isEmpty())
+    {
+        return;
+    }
+
+    uf.parent.clear();
+    uf.rank.clear();
+    uf.pendingRemovals.clear();
+
+    for (const QVector<AdjEdge>& list : adj)
+    {
+        for (const AdjEdge& e : list)
+        {
+            // 每条道路只处理 u < v 的那一份；对侧不在内存中时只有这一份
+            if ((e.u < e.v || e.to < 0) && allows(profile, e.type))
+            {
+                unite(uf, e.u, e.v);
+            }
+        }
+    }
+    uf.stale = false;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../GraphData.h"
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+/**
+ * @brief 连通性档案
+ *
+ * 不同交通方式能走的道路不同，连通分量也就不同：
+ * 步行、跑步、校车可以走全部道路；骑车不能走楼梯和室内（见 EdgeAccess::profileMask）。
+ * 临时的道路封闭不计入连通分量：封闭只会让路更少，"不连通"的判断仍然成立。
+ */
+enum class ConnectivityProfile
+{
+    Foot = 0,       ///< 全部道路
+    Vehicle = 1     ///< 不含楼梯、室内
+};
+
+/**
+ * @brief 按档案维护的连通分量标签
+ *
+ * 每个档案一份并查集：
+ * - 新增道路：直接合并两端，O(α(n))；
+ * - 删除道路：并查集无法拆分，只记下"有待确认的删除"，下次查询时整图重建（惰性）；
+ *   同一条道路删除后原样插回（修改道路属性就是这样实现的）会相互抵消，不触发重建。
+ *
+ * 不在并查集中的节点（没有任何道路）自成一个分量。
+ * 索引不持有图数据，需要重建时由调用方传入邻接表。
+ */
+class ConnectivityIndex
+{
+public:
+    /**
+     * @brief 交通方式对应的档案
+     */
+    static ConnectivityProfile profileFor(TransportMode mode);
+
+    /**
+     * @brief 某类道路在档案中是否可通行
+     */
+    static bool allows(ConnectivityProfile profile, EdgeType type);
+
+    /**
+     * @brief 邻接表中插入了一条道路
+     */
+    void edgeInserted(const AdjEdge& edge);
+
+    /**
+     * @brief 邻接表中删除了一条道路
+     */
+    void edgeRemoved(const AdjEdge& edge);
+
+    /**
+     * @brief 全部标签作废（整图重建邻接表后调用）
+     */
+    void invalidate();
+
+    /**
+     * @brief 节点所在分量的标签（分量代表节点 ID）
+     *
+     * 标签过期时先用 adj 重建，之后每次查询近似 O(1)。
+     */
+    int componentOf(ConnectivityProfile profile, int nodeId, const AdjacencyList& adj);
+
+    /**
+     * @brief 两个节点在档案下是否连通
+     */
+    bool connected(ConnectivityProfile profile, int a, int b, const AdjacencyList& adj);
+
+    /**
+     * @brief 不属于最大分量的节点（孤岛）
+     *
+     * @param nodeIds 参与统计的全部节点
+     */
+    QSet<int> islandNodes(ConnectivityProfile profile, const QList<int>& nodeIds,
+                          const AdjacencyList& adj);
+
+    /**
+     * @brief 桥（割边）：删掉后会让图多出一个分量的道路
+     *
+     * 迭代式 Tarjan 算法，O(V + E)，不受递归深度限制。
+     *
+     * @return QVector<int> 桥的道路 ID
+     */
+    static QVector<int> findBridges(ConnectivityProfile profile, const AdjacencyList& adj);
+
+private:
+    /**
+     * @brief 单个档案的并查集
+     */
+    struct UnionFind
+    {
+        QHash<int, int> parent;         ///< 节点 -> 父节点（不在表中即自身为根）
+        QHash<int, int> rank;           ///< 根节点的秩
+        QSet<quint64> pendingRemovals;  ///< 尚未被插回抵消的删除（端点对）
+        bool stale = true;              ///< 需要整图重建
+    };
+
+    static const int kProfileCount = 2;
+    UnionFind m_sets[kProfileCount];
+
+    static quint64 pairKey(int u, int v);
+    static int find(UnionFind& uf, int id);
+    static void unite(UnionFind& uf, int a, int b);
+
+    /**
+     * @brief 标签过期时重建
+     */
+    void refresh(ConnectivityProfile profile, const AdjacencyList& adj);
+};
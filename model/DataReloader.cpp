@@ -0,0 +1,216 @@
+// ============================================================
+// DataReloader.cpp - 数据文件热重载
+// 界面线程只负责"取基准"和"应用变化"，读取和比较都在后台线程完成
+// ============================================================
+
+#include "DataReloader.h"
+#include "GraphModel.h"
+
+#include <QFileInfo>
+#include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+
+DataReloader::DataReloader(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &DataReloader::onTimeout);
+    connect(&m_future, &QFutureWatcher<ReloadDiff>::finished, this, &DataReloader::onDiffFinished);
+    connect(&m_fsWatcher, &QFileSystemWatcher::fileChanged, this, &DataReloader::onPathChanged);
+    connect(&m_fsWatcher, &QFileSystemWatcher::directoryChanged, this, &DataReloader::onPathChanged);
+}
+
+DataReloader::~DataReloader()
+{
+    stop();
+}
+
+// ============================================================
+// 开始 / 停止监视
+// 同时监视文件和所在目录：编辑器和我们自己的保存都是"写临时文件再改名"，
+// 改名后旧文件从监视列表消失，只有目录事件能通知到
+// ============================================================
+void DataReloader::watch(const QString& nodesPath, const QString& edgesPath, const QString& schedulePath)
+{
+    stop();
+
+    m_nodesPath = nodesPath;
+    m_edgesPath = edgesPath;
+    m_schedulePath = schedulePath;
+
+    for (const QString& path : {m_nodesPath, m_edgesPath, m_schedulePath})
+    {
+        if (!path.isEmpty())
+        {
+            m_stamps.insert(path, stampOf(path));
+        }
+    }
+    rewatch();
+    qDebug() << "热重载: 开始监视" << m_fsWatcher.files();
+}
+
+void DataReloader::stop()
+{
+    m_timer.stop();
+    if (!m_fsWatcher.files().isEmpty())
+    {
+        m_fsWatcher.removePaths(m_fsWatcher.files());
+    }
+    if (!m_fsWatcher.directories().isEmpty())
+    {
+        m_fsWatcher.removePaths(m_fsWatcher.directories());
+    }
+
+    m_future.waitForFinished();
+    m_inFlight.clear();         // 结果作废，onDiffFinished 据此忽略
+    m_dirty.clear();
+    m_stamps.clear();
+}
+
+void DataReloader::rewatch()
+{
+    for (const QString& path : {m_nodesPath, m_edgesPath, m_schedulePath})
+    {
+        if (path.isEmpty())
+        {
+            continue;
+        }
+
+        QFileInfo info(path);
+        QString dir = info.absolutePath();
+        if (!m_fsWatcher.directories().contains(dir))
+        {
+            m_fsWatcher.addPath(dir);
+        }
+        if (info.exists() && !m_fsWatcher.files().contains(path))
+        {
+            m_fsWatcher.addPath(path);
+        }
+    }
+}
+
+DataReloader::FileStamp DataReloader::stampOf(const QString& path)
+{
+    FileStamp stamp;
+    QFileInfo info(path);
+    if (info.exists())
+    {
+        stamp.modified = info.lastModified();
+        stamp.size = info.size();
+    }
+    return stamp;
+}
+
+// ============================================================
+// 文件变化（防抖）
+// 目录里别的文件（日志、临时文件）变化也会触发，按修改时间和大小过滤
+// ============================================================
+void DataReloader::onPathChanged()
+{
+    rewatch();
+
+    for (auto it = m_stamps.cbegin(); it != m_stamps.cend(); ++it)
+    {
+        if (stampOf(it.key()) != it.value())
+        {
+            m_dirty.insert(it.key());
+        }
+    }
+
+    if (!m_dirty.isEmpty())
+    {
+        m_timer.start(m_debounceMs);
+    }
+}
+
+void DataReloader::onTimeout()
+{
+    if (!m_inFlight.isEmpty())
+    {
+        return;  // 等这次读完后在 onDiffFinished 里接着读
+    }
+    startDiff();
+}
+
+// ============================================================
+// 开始一次后台读取：只读变了的文件
+// ============================================================
+void DataReloader::startDiff()
+{
+    if (m_dirty.isEmpty() || !m_provider || !m_applier)
+    {
+        return;
+    }
+
+    ReloadSources sources;
+    if (m_dirty.contains(m_nodesPath))
+    {
+        sources.nodesPath = m_nodesPath;
+    }
+    if (m_dirty.contains(m_edgesPath))
+    {
+        sources.edgesPath = m_edgesPath;
+    }
+    if (m_dirty.contains(m_schedulePath))
+    {
+        sources.schedulePath = m_schedulePath;
+    }
+
+    m_inFlight = m_dirty;
+    m_dirty.clear();
+    m_inFlightStamps.clear();
+    for (const QString& path : m_inFlight)
+    {
+        FileStamp stamp = stampOf(path);
+        m_stamps.insert(path, stamp);
+        m_inFlightStamps.insert(path, stamp);
+    }
+
+    m_future.setFuture(QtConcurrent::run(&GraphModel::computeReloadDiff, m_provider(), sources));
+}
+
+// ============================================================
+// 后台读取完成：检查结果是否仍然有效，再交给模型应用
+// ============================================================
+void DataReloader::onDiffFinished()
+{
+    // stop() 可能已经丢弃了这次结果
+    if (m_inFlight.isEmpty())
+    {
+        return;
+    }
+
+    const QSet<QString> done = m_inFlight;
+    m_inFlight.clear();
+    ReloadDiff diff = m_future.result();
+
+    // 读取期间文件又被改写，读到的可能是写了一半的内容
+    bool torn = false;
+    for (const QString& path : done)
+    {
+        if (stampOf(path) != m_inFlightStamps.value(path))
+        {
+            torn = true;
+        }
+    }
+
+    // 基准已过期（期间模型保存过）时模型拒绝应用，与文件被改写一样重新读取
+    if (torn || (!diff.isEmpty() && !m_applier(diff)))
+    {
+        m_dirty.unite(done);
+        m_timer.start(m_debounceMs);
+        return;
+    }
+
+    if (!diff.isEmpty())
+    {
+        qDebug() << "热重载: 应用了" << diff.size() << "处外部修改";
+        emit reloaded(diff);
+    }
+
+    // 读取期间又有文件变化，且防抖窗口已经过去，就接着读
+    if (!m_dirty.isEmpty() && !m_timer.isActive())
+    {
+        startDiff();
+    }
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "../GraphData.h"
+#include "NodeTable.h"
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QDateTime>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QVector>
+#include <QPair>
+#include <QTime>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief 热重载的比较基准：模型认为磁盘上现在是什么内容
+ *
+ * 加载和每次保存时更新。外部修改 = 磁盘新内容 - 基准，
+ * 因此模型里尚未保存的编辑不会被误判为"被外部删掉"。
+ */
+struct ReloadBaseline
+{
+    quint64 generation = 0;                 ///< 基准版本，每次加载 / 保存 / 重载递增
+    NodeTable nodes;                        ///< 节点
+    QVector<Edge> edges;                    ///< 道路（id = -1 为墓碑，比较时跳过；从文件读到的道路 id 置 0）
+    QMap<int, QVector<QTime>> schedules;    ///< 时刻表
+};
+
+/**
+ * @brief 需要重新读取的文件（为空表示该文件没有变化）
+ */
+struct ReloadSources
+{
+    QString nodesPath;
+    QString edgesPath;
+    QString schedulePath;
+};
+
+/**
+ * @brief 磁盘内容相对基准的变化
+ */
+struct ReloadDiff
+{
+    quint64 baseGeneration = 0;                 ///< 计算时使用的基准版本
+    QVector<Node> upsertNodes;                  ///< 新增或字段变化的节点
+    QVector<int> removedNodes;                  ///< 删除的节点
+    QVector<Edge> upsertEdges;                  ///< 新增或字段变化的道路（按端点对匹配）
+    QVector<QPair<int, int>> removedEdges;      ///< 删除的道路（端点对）
+    QMap<int, QVector<QTime>> upsertSchedules;  ///< 新增或变化的车站时刻
+    QVector<int> removedStations;               ///< 删除的车站时刻
+    ReloadBaseline newBaseline;                 ///< 应用后的新基准（即磁盘当前内容）
+
+    /**
+     * @brief 变化条目总数
+     */
+    int size() const
+    {
+        return upsertNodes.size() + removedNodes.size() + upsertEdges.size() + removedEdges.size()
+             + upsertSchedules.size() + removedStations.size();
+    }
+
+    bool isEmpty() const { return size() == 0; }
+};
+
+/**
+ * @brief 数据文件热重载
+ *
+ * 监视 nodes.txt / edges.txt / bus_schedule.csv，文件变化后（防抖）在后台线程
+ * 只重新读取变了的文件并与基准比较，得到变化后回到界面线程交给模型整批应用。
+ *
+ * 自己保存产生的文件变化与基准一致，比较结果为空，不会触发应用。
+ * 读取期间文件又变了、或者期间模型保存过（基准已过期），结果作废并重新计算。
+ */
+class DataReloader : public QObject
+{
+    Q_OBJECT
+public:
+    /// 取比较基准：在界面线程、开始读取的那一刻调用
+    using BaselineProvider = std::function<ReloadBaseline()>;
+
+    /// 在界面线程应用变化；基准已过期时返回 false，稍后重新计算
+    using DiffApplier = std::function<bool(const ReloadDiff&)>;
+
+    explicit DataReloader(QObject* parent = nullptr);
+    ~DataReloader() override;
+
+    void setBaselineProvider(BaselineProvider provider) { m_provider = std::move(provider); }
+    void setDiffApplier(DiffApplier applier) { m_applier = std::move(applier); }
+
+    /**
+     * @brief 设置防抖窗口（毫秒），外部程序分几次写完一个文件时只读一次
+     */
+    void setDebounceInterval(int ms) { m_debounceMs = ms; }
+
+    /**
+     * @brief 开始监视（路径可为空，表示不监视该文件）
+     */
+    void watch(const QString& nodesPath, const QString& edgesPath, const QString& schedulePath);
+
+    /**
+     * @brief 停止监视，等待正在进行的读取结束
+     */
+    void stop();
+
+    bool isWatching() const { return !m_fsWatcher.directories().isEmpty(); }
+
+signals:
+    /**
+     * @brief 一次外部修改已应用到模型
+     */
+    void reloaded(const ReloadDiff& diff);
+
+private slots:
+    void onPathChanged();
+    void onTimeout();
+    void onDiffFinished();
+
+private:
+    /// 文件的修改时间和大小，用来判断是否真的变了
+    struct FileStamp
+    {
+        QDateTime modified;
+        qint64 size = -1;
+
+        bool operator==(const FileStamp& o) const { return modified == o.modified && size == o.size; }
+        bool operator!=(const FileStamp& o) const { return !(*this == o); }
+    };
+
+    QFileSystemWatcher m_fsWatcher;
+    QTimer m_timer;
+    QFutureWatcher<ReloadDiff> m_future;
+    BaselineProvider m_provider;
+    DiffApplier m_applier;
+
+    QString m_nodesPath;
+    QString m_edgesPath;
+    QString m_schedulePath;
+    QHash<QString, FileStamp> m_stamps;     ///< 最近一次读取时各文件的状态
+    QSet<QString> m_dirty;                  ///< 变化了、等待读取的文件
+    QSet<QString> m_inFlight;               ///< 正在读取的文件
+    QHash<QString, FileStamp> m_inFlightStamps;
+    int m_debounceMs = 300;
+
+    static FileStamp stampOf(const QString& path);
+
+    /**
+     * @brief 重新加入监视列表（原子替换后文件会从列表中消失）
+     */
+    void rewatch();
+
+    /**
+     * @brief 开始一次后台读取
+     */
+    void startDiff();
+};
@@ -0,0 +1,73 @@
+// ============================================================
+// DescriptionStore.cpp - 按需读取的描述
+// ============================================================
+
+#include "DescriptionStore.h"
+#include <QFile>
+#include <QDebug>
+
+DescriptionStore::DescriptionStore(int cacheSize)
+    : m_cache(cacheSize)
+{
+}
+
+int DescriptionStore::addFile(const QString& path)
+{
+    m_files.append(path);
+    return m_files.size() - 1;
+}
+
+void DescriptionStore::setNode(int id, int file, qint64 offset)
+{
+    m_nodes.insert(id, {file, offset});
+}
+
+void DescriptionStore::setEdge(int id, int file, qint64 offset)
+{
+    m_edges.insert(id, {file, offset});
+}
+
+QString DescriptionStore::node(int id)
+{
+    auto it = m_nodes.constFind(id);
+    return it == m_nodes.cend() ? QString() : read(it.value());
+}
+
+QString DescriptionStore::edge(int id)
+{
+    auto it = m_edges.constFind(id);
+    return it == m_edges.cend() ? QString() : read(it.value());
+}
+
+void DescriptionStore::clear()
+{
+    m_files.clear();
+    m_nodes.clear();
+    m_edges.clear();
+    m_cache.clear();
+}
+
+// ============================================================
+// 定位读取一行
+// 相同内容在描述文件里只写一次，缓存按位置为键，重复的描述也只占一项
+// ============================================================
+QString DescriptionStore::read(const Location& loc)
+{
+    quint64 key = (static_cast<quint64>(loc.file) << 40) | static_cast<quint64>(loc.offset);
+    if (const QString* hit = m_cache.object(key))
+    {
+        return *hit;
+    }
+
+    // 按字节偏移定位，不能用文本模式打开
+    QFile file(m_files.value(loc.file));
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(loc.offset))
+    {
+        qDebug() << "警告: 无法读取描述文件:" << file.fileName();
+        return QString();
+    }
+
+    QString text = QString::fromUtf8(file.readLine()).trimmed();
+    m_cache.insert(key, new QString(text));
+    return text;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QCache>
+
+/**
+ * @brief 按需读取的节点 / 道路描述
+ *
+ * 描述只在悬停气泡和编辑器属性面板里用到，却占了城市级地图文本的大头。
+ * 分区文件把描述单独写进描述文件（每条一行，相同内容只写一次），
+ * 节点、道路行的描述列改存该行在描述文件中的字节偏移。
+ *
+ * 加载分区时只记下 ID -> (文件, 偏移)，不读描述文件；
+ * 显示时再定位读取一行，最近用过的放在一个小的 LRU 缓存里。
+ * 只在模型所在的线程使用。
+ */
+class DescriptionStore
+{
+public:
+    explicit DescriptionStore(int cacheSize = 256);
+
+    /**
+     * @brief 登记一个描述文件
+     * @return int 文件下标，setNode / setEdge 时使用
+     */
+    int addFile(const QString& path);
+
+    /**
+     * @brief 记录描述的位置
+     */
+    void setNode(int id, int file, qint64 offset);
+    void setEdge(int id, int file, qint64 offset);
+
+    /**
+     * @brief 读取描述
+     * @return QString 未登记或读取失败时为空
+     */
+    QString node(int id);
+    QString edge(int id);
+
+    /**
+     * @brief 登记的描述个数（节点 + 道路）
+     */
+    int size() const { return m_nodes.size() + m_edges.size(); }
+
+    void clear();
+
+private:
+    struct Location
+    {
+        int file = -1;          ///< 描述文件下标
+        qint64 offset = 0;      ///< 描述所在行的字节偏移
+    };
+
+    QStringList m_files;                    ///< 文件下标 -> 路径
+    QHash<int, Location> m_nodes;           ///< 节点 ID -> 描述位置
+    QHash<int, Location> m_edges;           ///< 道路 ID -> 描述位置
+    QCache<quint64, QString> m_cache;       ///< (文件, 偏移) -> 描述，LRU
+
+    QString read(const Location& loc);
+};
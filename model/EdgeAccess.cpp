@@ -0,0 +1,199 @@
+// ============================================================
+// EdgeAccess.cpp - 道路可通行性（档案掩码与封闭集）
+// ============================================================
+
+#include "EdgeAccess.h"
+#include <algorithm>
+#include <utility>
+
+// ============================================================
+// 档案掩码
+// 骑行类不能走楼梯和室内；下雪天不能骑车，任何道路都不行
+// ============================================================
+EdgeTypeMask EdgeAccess::profileMask(TransportMode mode, Weather weather)
+{
+    const EdgeTypeMask all = 0xFF;
+    bool isVehicle = (mode == TransportMode::SharedBike || mode == TransportMode::EBike);
+    if (!isVehicle)
+    {
+        return all;
+    }
+    if (weather == Weather::Snowy)
+    {
+        return 0;
+    }
+    return static_cast<EdgeTypeMask>(all & ~(edgeTypeBit(EdgeType::Stairs) | edgeTypeBit(EdgeType::Indoor)));
+}
+
+// ============================================================
+// 封闭集管理
+// ============================================================
+void EdgeAccess::define(const QString& name, const QVector<int>& edgeIds, EdgeTypeMask types)
+{
+    ClosureSet set;
+    set.types = types;
+
+    int maxId = -1;
+    for (int id : edgeIds)
+    {
+        maxId = std::max(maxId, id);
+    }
+    set.edges.resize(maxId + 1);
+    for (int id : edgeIds)
+    {
+        if (id >= 0)
+        {
+            set.edges.setBit(id);
+        }
+    }
+
+    store(name, std::move(set));
+}
+
+void EdgeAccess::defineRoads(const QString& name, const QStringList& roadNames, EdgeTypeMask types)
+{
+    ClosureSet set;
+    set.types = types;
+    for (const QString& road : roadNames)
+    {
+        if (!road.isEmpty())
+        {
+            set.roadNames.insert(road);
+        }
+    }
+
+    store(name, std::move(set));
+}
+
+void EdgeAccess::store(const QString& name, ClosureSet set)
+{
+    auto old = m_sets.constFind(name);
+    if (old != m_sets.cend())
+    {
+        set.active = old.value().active;
+    }
+    m_sets.insert(name, std::move(set));
+    m_dirty = true;
+}
+
+bool EdgeAccess::setActive(const QString& name, bool active)
+{
+    auto it = m_sets.find(name);
+    if (it == m_sets.end())
+    {
+        return false;
+    }
+    if (it.value().active != active)
+    {
+        it.value().active = active;
+        m_dirty = true;
+    }
+    return true;
+}
+
+bool EdgeAccess::remove(const QString& name)
+{
+    if (m_sets.remove(name) == 0)
+    {
+        return false;
+    }
+    m_dirty = true;
+    return true;
+}
+
+bool EdgeAccess::isActive(const QString& name) const
+{
+    auto it = m_sets.constFind(name);
+    return it != m_sets.cend() && it.value().active;
+}
+
+// ============================================================
+// 道路 ID 作废
+// 重新加载后 ID 从 0 重新分配，旧 ID 会落到不相干的道路上，只能丢掉
+// ============================================================
+void EdgeAccess::forgetEdgeIds()
+{
+    for (auto it = m_sets.begin(); it != m_sets.end();)
+    {
+        ClosureSet& set = it.value();
+        if (set.roadNames.isEmpty() && set.types == 0)
+        {
+            it = m_sets.erase(it);
+            continue;
+        }
+        set.edges.clear();
+        ++it;
+    }
+    m_dirty = true;
+}
+
+// ============================================================
+// 解析启用的封闭集
+// 按 ID 的部分按位或；按路名的部分扫一遍道路表，代价与道路数成正比，
+// 只在封闭集改过、或有按路名的封闭且图版本变了时才重做。
+// 没有启用的封闭时返回空，寻路可以整段跳过检查
+// ============================================================
+ClosureMaskPtr EdgeAccess::resolve(const QVector<Edge>& edges, quint64 graphVersion)
+{
+    if (!m_dirty && (!m_byName || m_resolvedVersion == graphVersion))
+    {
+        return m_resolved;
+    }
+
+    std::shared_ptr<ClosureMask> mask;
+    QSet<QString> roadNames;
+    for (const ClosureSet& set : std::as_const(m_sets))
+    {
+        if (!set.active)
+        {
+            continue;
+        }
+        if (!mask)
+        {
+            mask = std::make_shared<ClosureMask>();
+        }
+        if (set.edges.size() > mask->m_edges.size())
+        {
+            mask->m_edges.resize(set.edges.size());
+        }
+        mask->m_edges |= set.edges;
+        mask->m_types |= set.types;
+        roadNames.unite(set.roadNames);
+    }
+
+    if (!roadNames.isEmpty())
+    {
+        int maxId = -1;
+        for (const Edge& e : edges)
+        {
+            if (e.id >= 0 && roadNames.contains(e.name))
+            {
+                maxId = std::max(maxId, e.id);
+            }
+        }
+        if (maxId >= mask->m_edges.size())
+        {
+            mask->m_edges.resize(maxId + 1);
+        }
+        for (const Edge& e : edges)
+        {
+            if (e.id >= 0 && roadNames.contains(e.name))
+            {
+                mask->m_edges.setBit(e.id);
+            }
+        }
+    }
+
+    // 结果没变时沿用旧对象，快照缓存可以继续复用
+    bool unchanged = mask && m_resolved
+                     && mask->m_types == m_resolved->m_types && mask->m_edges == m_resolved->m_edges;
+    if (!unchanged)
+    {
+        m_resolved = mask;
+    }
+
+    m_dirty = false;
+    m_byName = !roadNames.isEmpty();
+    m_resolvedVersion = graphVersion;
+    return m_resolved;
+}
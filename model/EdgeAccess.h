@@ -0,0 +1,154 @@
+#pragma once
+
+#include "../GraphData.h"
+#include <QBitArray>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+
+/// 按道路类型的位掩码：第 k 位对应 EdgeType 值为 k 的道路
+using EdgeTypeMask = quint8;
+
+static_assert(static_cast<int>(EdgeType::Stairs) < 8, "EdgeTypeMask 只有 8 位");
+
+/**
+ * @brief 道路类型对应的位
+ */
+inline EdgeTypeMask edgeTypeBit(EdgeType type)
+{
+    return static_cast<EdgeTypeMask>(1u << static_cast<int>(type));
+}
+
+/**
+ * @brief 启用中的封闭（全部封闭集按位或的结果，生成后不再修改）
+ *
+ * 随快照交给寻路，可被多个快照和后台线程同时持有。
+ */
+class ClosureMask
+{
+public:
+    /**
+     * @brief 被整类封闭的道路类型
+     */
+    EdgeTypeMask types() const { return m_types; }
+
+    /**
+     * @brief 道路是否在封闭名单上（不含按类型的封闭）
+     */
+    bool isClosed(int edgeId) const
+    {
+        return edgeId >= 0 && edgeId < m_edges.size() && m_edges.testBit(edgeId);
+    }
+
+private:
+    friend class EdgeAccess;
+
+    QBitArray m_edges;          ///< 道路 ID -> 是否封闭
+    EdgeTypeMask m_types = 0;   ///< 整类封闭的道路类型
+};
+
+/// 封闭表的共享引用；没有启用的封闭时为空
+using ClosureMaskPtr = std::shared_ptr<const ClosureMask>;
+
+/**
+ * @brief 道路的可通行性
+ *
+ * 两层位集，寻路对每条邻接边各做一次位测试：
+ * - 档案掩码：交通方式 + 天气 -> 允许的道路类型（骑车不走楼梯和室内，下雪不能骑车）；
+ * - 封闭集：用户定义、按名称管理的规则，可以封闭指定道路（道路 ID）、指定路名的全部道路，
+ *   或整类道路，如轮椅用户"避开楼梯"、"樱花节封闭樱花大道"、施工、积水的地下通道。
+ *
+ * 生成快照时把启用的封闭集解析成一张 ClosureMask（按道路 ID 的位集），由快照带给寻路。
+ * 开关封闭只重新合并位集，不改图数据、不增加图版本号，预计算缓存、连通分量等都保持有效。
+ *
+ * 道路 ID 不写入数据文件，重新加载地图后会重新分配：按 ID 的封闭在加载时丢弃（forgetEdgeIds），
+ * 按路名的封闭每次解析时对照当前道路表，之后新建、切分出的同名道路同样封闭。
+ * 只在模型所在的线程使用。
+ */
+class EdgeAccess
+{
+public:
+    /**
+     * @brief 交通方式 + 天气下允许通行的道路类型
+     */
+    static EdgeTypeMask profileMask(TransportMode mode, Weather weather);
+
+    /**
+     * @brief 定义（或替换）一个按道路 ID 的封闭集，保留原来的启用状态；新定义的默认启用
+     *
+     * @param name 名称
+     * @param edgeIds 封闭的道路 ID（只在本次加载的地图中有效）
+     * @param types 整类封闭的道路类型
+     */
+    void define(const QString& name, const QVector<int>& edgeIds, EdgeTypeMask types = 0);
+
+    /**
+     * @brief 定义（或替换）一个按路名的封闭集，启用状态同 define
+     *
+     * @param name 名称
+     * @param roadNames 封闭的路名（同名的全部道路）
+     * @param types 整类封闭的道路类型
+     */
+    void defineRoads(const QString& name, const QStringList& roadNames, EdgeTypeMask types = 0);
+
+    /**
+     * @brief 启用 / 停用封闭集
+     * @return bool 名称不存在时返回 false
+     */
+    bool setActive(const QString& name, bool active);
+
+    /**
+     * @brief 删除封闭集
+     * @return bool 名称不存在时返回 false
+     */
+    bool remove(const QString& name);
+
+    /**
+     * @brief 全部封闭集的名称（按名称排序）
+     */
+    QStringList names() const { return m_sets.keys(); }
+
+    /**
+     * @brief 封闭集是否启用
+     */
+    bool isActive(const QString& name) const;
+
+    /**
+     * @brief 道路 ID 作废（重新加载地图时调用）
+     *
+     * 丢弃各封闭集中按 ID 的部分；只剩 ID 的封闭集整个删除，按路名、按类型的保留。
+     */
+    void forgetEdgeIds();
+
+    /**
+     * @brief 按当前道路表解析启用的封闭
+     *
+     * 结果缓存到封闭集或（有按路名的封闭时）图版本变化为止；变化后换一个新对象，旧快照仍持有旧的。
+     *
+     * @return ClosureMaskPtr 没有启用的封闭时为空
+     */
+    ClosureMaskPtr resolve(const QVector<Edge>& edges, quint64 graphVersion);
+
+private:
+    struct ClosureSet
+    {
+        QBitArray edges;            ///< 道路 ID -> 是否封闭
+        QSet<QString> roadNames;    ///< 封闭的路名
+        EdgeTypeMask types = 0;     ///< 整类封闭的道路类型
+        bool active = true;         ///< 是否启用
+    };
+
+    QMap<QString, ClosureSet> m_sets;   ///< 名称 -> 封闭集
+    ClosureMaskPtr m_resolved;          ///< 最近一次解析的结果
+    quint64 m_resolvedVersion = 0;      ///< 解析时的图版本号
+    bool m_dirty = true;                ///< 封闭集改过，需要重新解析
+    bool m_byName = false;              ///< 上次解析含按路名的封闭（随图版本失效）
+
+    /**
+     * @brief 存入封闭集，沿用同名封闭集的启用状态
+     */
+    void store(const QString& name, ClosureSet set);
+};
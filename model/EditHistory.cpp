@@ -0,0 +1,514 @@
+// ============================================================
+// EditHistory.cpp - 撤销/重做历史
+// 增量编码、事务分组、内存预算与磁盘溢出
+// ============================================================
+
+#include "EditHistory.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QDebug>
+
+// ============================================================
+//                    增量字段工具
+// ============================================================
+
+quint8 EditDelta::diffNode(const Node& a, const Node& b)
+{
+    quint8 mask = 0;
+    if (a.name != b.name) mask |= FieldName;
+    if (a.description != b.description) mask |= FieldDesc;
+    if (a.type != b.type) mask |= FieldType;
+    if (a.x != b.x || a.y != b.y) mask |= FieldPos;
+    if (a.z != b.z) mask |= FieldZ;
+    if (a.category != b.category) mask |= FieldCategory;
+    return mask;
+}
+
+quint8 EditDelta::diffEdge(const Edge& a, const Edge& b)
+{
+    quint8 mask = 0;
+    if (a.name != b.name) mask |= FieldName;
+    if (a.description != b.description) mask |= FieldDesc;
+    if (a.type != b.type) mask |= FieldType;
+    if (a.distance != b.distance) mask |= FieldDistance;
+    if (a.slope != b.slope) mask |= FieldSlope;
+    return mask;
+}
+
+void EditDelta::copyNodeFields(Node& target, const Node& source, quint8 mask)
+{
+    if (mask & FieldName) target.name = source.name;
+    if (mask & FieldDesc) target.description = source.description;
+    if (mask & FieldType) target.type = source.type;
+    if (mask & FieldPos) { target.x = source.x; target.y = source.y; }
+    if (mask & FieldZ) target.z = source.z;
+    if (mask & FieldCategory) target.category = source.category;
+}
+
+void EditDelta::copyEdgeFields(Edge& target, const Edge& source, quint8 mask)
+{
+    if (mask & FieldName) target.name = source.name;
+    if (mask & FieldDesc) target.description = source.description;
+    if (mask & FieldType) target.type = source.type;
+    if (mask & FieldDistance) target.distance = source.distance;
+    if (mask & FieldSlope) target.slope = source.slope;
+}
+
+// ============================================================
+//                    二进制编码
+// 每条增量: kind(quint8) + 内容
+//   增删节点: 完整节点
+//   增删道路: 完整道路（含 ID）
+//   修改节点: id + mask + 每个字段的 (旧值, 新值)
+//   修改道路: id + u + v + mask + 每个字段的 (旧值, 新值)
+// ============================================================
+
+namespace {
+
+void writeNodeFields(QDataStream& out, const Node& n, quint8 mask)
+{
+    if (mask & EditDelta::FieldName) out << n.name;
+    if (mask & EditDelta::FieldDesc) out << n.description;
+    if (mask & EditDelta::FieldType) out << static_cast<quint8>(n.type);
+    if (mask & EditDelta::FieldPos) out << n.x << n.y;
+    if (mask & EditDelta::FieldZ) out << n.z;
+    if (mask & EditDelta::FieldCategory) out << static_cast<quint8>(n.category);
+}
+
+void readNodeFields(QDataStream& in, Node& n, quint8 mask)
+{
+    quint8 v = 0;
+    if (mask & EditDelta::FieldName) in >> n.name;
+    if (mask & EditDelta::FieldDesc) in >> n.description;
+    if (mask & EditDelta::FieldType) { in >> v; n.type = static_cast<NodeType>(v); }
+    if (mask & EditDelta::FieldPos) in >> n.x >> n.y;
+    if (mask & EditDelta::FieldZ) in >> n.z;
+    if (mask & EditDelta::FieldCategory) { in >> v; n.category = static_cast<NodeCategory>(v); }
+}
+
+void writeEdgeFields(QDataStream& out, const Edge& e, quint8 mask)
+{
+    if (mask & EditDelta::FieldName) out << e.name;
+    if (mask & EditDelta::FieldDesc) out << e.description;
+    if (mask & EditDelta::FieldType) out << static_cast<quint8>(e.type);
+    if (mask & EditDelta::FieldDistance) out << e.distance;
+    if (mask & EditDelta::FieldSlope) out << e.slope;
+}
+
+void readEdgeFields(QDataStream& in, Edge& e, quint8 mask)
+{
+    quint8 v = 0;
+    if (mask & EditDelta::FieldName) in >> e.name;
+    if (mask & EditDelta::FieldDesc) in >> e.description;
+    if (mask & EditDelta::FieldType) { in >> v; e.type = static_cast<EdgeType>(v); }
+    if (mask & EditDelta::FieldDistance) in >> e.distance;
+    if (mask & EditDelta::FieldSlope) in >> e.slope;
+}
+
+const quint8 kAllNodeFields = EditDelta::FieldName | EditDelta::FieldDesc | EditDelta::FieldType |
+                              EditDelta::FieldPos | EditDelta::FieldZ | EditDelta::FieldCategory;
+const quint8 kAllEdgeFields = EditDelta::FieldName | EditDelta::FieldDesc | EditDelta::FieldType |
+                              EditDelta::FieldDistance | EditDelta::FieldSlope;
+
+quint64 makeMergeKey(EditDelta::Kind kind, quint8 mask, int id)
+{
+    return (static_cast<quint64>(kind + 1) << 56) | (static_cast<quint64>(mask) << 40) | static_cast<quint32>(id);
+}
+
+} // namespace
+
+QByteArray EditHistory::encodeNodeFull(EditDelta::Kind kind, const Node& node)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out << static_cast<quint8>(kind) << static_cast<qint32>(node.id);
+    writeNodeFields(out, node, kAllNodeFields);
+    return bytes;
+}
+
+QByteArray EditHistory::encodeEdgeFull(EditDelta::Kind kind, const Edge& edge)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out << static_cast<quint8>(kind) << static_cast<qint32>(edge.id)
+        << static_cast<qint32>(edge.u) << static_cast<qint32>(edge.v);
+    writeEdgeFields(out, edge, kAllEdgeFields);
+    return bytes;
+}
+
+QVector<EditDelta> EditHistory::decode(const Transaction& t)
+{
+    QVector<EditDelta> deltas;
+    deltas.reserve(t.deltaCount);
+
+    QDataStream in(t.data);
+    for (int i = 0; i < t.deltaCount && !in.atEnd(); ++i)
+    {
+        EditDelta d;
+        quint8 kind = 0;
+        qint32 id = 0, u = 0, v = 0;
+        in >> kind >> id;
+        d.kind = static_cast<EditDelta::Kind>(kind);
+
+        switch (d.kind)
+        {
+        case EditDelta::AddNode:
+        case EditDelta::RemoveNode:
+        {
+            Node& n = (d.kind == EditDelta::AddNode) ? d.after : d.before;
+            n.id = id;
+            readNodeFields(in, n, kAllNodeFields);
+            d.mask = kAllNodeFields;
+            break;
+        }
+        case EditDelta::ChangeNode:
+            in >> d.mask;
+            d.before.id = d.after.id = id;
+            readNodeFields(in, d.before, d.mask);
+            readNodeFields(in, d.after, d.mask);
+            break;
+        case EditDelta::AddEdge:
+        case EditDelta::RemoveEdge:
+        {
+            Edge& e = (d.kind == EditDelta::AddEdge) ? d.edgeAfter : d.edgeBefore;
+            in >> u >> v;
+            e.id = id; e.u = u; e.v = v;
+            readEdgeFields(in, e, kAllEdgeFields);
+            d.mask = kAllEdgeFields;
+            break;
+        }
+        case EditDelta::ChangeEdge:
+            in >> u >> v >> d.mask;
+            d.edgeBefore.id = d.edgeAfter.id = id;
+            d.edgeBefore.u = d.edgeAfter.u = u;
+            d.edgeBefore.v = d.edgeAfter.v = v;
+            readEdgeFields(in, d.edgeBefore, d.mask);
+            readEdgeFields(in, d.edgeAfter, d.mask);
+            break;
+        }
+        deltas.append(d);
+    }
+    return deltas;
+}
+
+// ============================================================
+//                    事务
+// ============================================================
+
+EditHistory::EditHistory()
+{
+    m_clock.start();
+}
+
+EditHistory::~EditHistory()
+{
+}
+
+void EditHistory::begin(const QString& label)
+{
+    if (m_depth == 0)
+    {
+        m_current = Transaction();
+        m_current.label = label;
+        m_currentMergeKey = 0;
+    }
+    m_depth++;
+}
+
+void EditHistory::end()
+{
+    if (m_depth == 0)
+    {
+        return;
+    }
+    m_depth--;
+    if (m_depth > 0 || m_current.deltaCount == 0)
+    {
+        return;
+    }
+
+    // 只有一条修改记录的事务才可能和上一项合并
+    m_current.mergeKey = (m_current.deltaCount == 1) ? m_currentMergeKey : 0;
+    m_current.createdMs = m_clock.elapsed();
+
+    clearRedo();
+    if (!tryMerge())
+    {
+        m_memoryBytes += m_current.bytes();
+        m_undo.append(m_current);
+    }
+    m_current = Transaction();
+    enforceBudget();
+}
+
+// ============================================================
+// 合并连续修改
+// 同一对象、同一组字段、时间间隔很短：保留上一项的旧值，换成这一项的新值
+// ============================================================
+bool EditHistory::tryMerge()
+{
+    if (m_current.mergeKey == 0 || m_undo.isEmpty())
+    {
+        return false;
+    }
+
+    Transaction& top = m_undo.last();
+    if (top.mergeKey != m_current.mergeKey || m_current.createdMs - top.createdMs > kMergeWindowMs)
+    {
+        return false;
+    }
+
+    EditDelta older = decode(top).value(0);
+    EditDelta newer = decode(m_current).value(0);
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    if (older.kind == EditDelta::ChangeNode)
+    {
+        out << static_cast<quint8>(EditDelta::ChangeNode) << static_cast<qint32>(older.before.id) << older.mask;
+        writeNodeFields(out, older.before, older.mask);
+        writeNodeFields(out, newer.after, older.mask);
+    }
+    else
+    {
+        out << static_cast<quint8>(EditDelta::ChangeEdge) << static_cast<qint32>(older.edgeBefore.id)
+            << static_cast<qint32>(older.edgeBefore.u) << static_cast<qint32>(older.edgeBefore.v) << older.mask;
+        writeEdgeFields(out, older.edgeBefore, older.mask);
+        writeEdgeFields(out, newer.edgeAfter, older.mask);
+    }
+
+    m_memoryBytes -= top.bytes();
+    top.data = bytes;
+    top.createdMs = m_current.createdMs;
+    m_memoryBytes += top.bytes();
+    return true;
+}
+
+void EditHistory::appendDelta(const QByteArray& encoded, quint64 mergeKey)
+{
+    bool autoWrap = (m_depth == 0);
+    if (autoWrap)
+    {
+        begin(QString());
+    }
+
+    m_current.data.append(encoded);
+    m_current.deltaCount++;
+    m_currentMergeKey = mergeKey;
+
+    if (autoWrap)
+    {
+        end();
+    }
+}
+
+void EditHistory::recordNodeAdded(const Node& node)
+{
+    appendDelta(encodeNodeFull(EditDelta::AddNode, node), 0);
+}
+
+void EditHistory::recordNodeRemoved(const Node& node)
+{
+    appendDelta(encodeNodeFull(EditDelta::RemoveNode, node), 0);
+}
+
+void EditHistory::recordNodeChanged(const Node& before, const Node& after)
+{
+    quint8 mask = EditDelta::diffNode(before, after);
+    if (mask == 0)
+    {
+        return;
+    }
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out << static_cast<quint8>(EditDelta::ChangeNode) << static_cast<qint32>(after.id) << mask;
+    writeNodeFields(out, before, mask);
+    writeNodeFields(out, after, mask);
+    appendDelta(bytes, makeMergeKey(EditDelta::ChangeNode, mask, after.id));
+}
+
+void EditHistory::recordEdgeAdded(const Edge& edge)
+{
+    appendDelta(encodeEdgeFull(EditDelta::AddEdge, edge), 0);
+}
+
+void EditHistory::recordEdgeRemoved(const Edge& edge)
+{
+    appendDelta(encodeEdgeFull(EditDelta::RemoveEdge, edge), 0);
+}
+
+void EditHistory::recordEdgeChanged(const Edge& before, const Edge& after)
+{
+    quint8 mask = EditDelta::diffEdge(before, after);
+    if (mask == 0)
+    {
+        return;
+    }
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out << static_cast<quint8>(EditDelta::ChangeEdge) << static_cast<qint32>(after.id)
+        << static_cast<qint32>(after.u) << static_cast<qint32>(after.v) << mask;
+    writeEdgeFields(out, before, mask);
+    writeEdgeFields(out, after, mask);
+    appendDelta(bytes, makeMergeKey(EditDelta::ChangeEdge, mask, after.id));
+}
+
+// ============================================================
+//                    撤销 / 重做
+// ============================================================
+
+QVector<EditDelta> EditHistory::takeUndo(QString* label)
+{
+    Transaction t;
+    if (!m_undo.isEmpty())
+    {
+        t = m_undo.takeLast();
+        m_memoryBytes -= t.bytes();
+    }
+    else if (!readSpilled(t))
+    {
+        return {};
+    }
+
+    if (label)
+    {
+        *label = t.label;
+    }
+
+    QVector<EditDelta> deltas = decode(t);
+    t.mergeKey = 0;  // 撤销后重做回来的项不再与新编辑合并
+    m_memoryBytes += t.bytes();
+    m_redo.append(t);
+    enforceBudget();
+    return deltas;
+}
+
+QVector<EditDelta> EditHistory::takeRedo(QString* label)
+{
+    if (m_redo.isEmpty())
+    {
+        return {};
+    }
+
+    Transaction t = m_redo.takeLast();
+    if (label)
+    {
+        *label = t.label;
+    }
+
+    m_undo.append(t);
+    enforceBudget();
+    return decode(t);
+}
+
+void EditHistory::clear()
+{
+    m_undo.clear();
+    m_redo.clear();
+    m_spilled.clear();
+    m_spillFile.reset();
+    m_current = Transaction();
+    m_depth = 0;
+    m_memoryBytes = 0;
+}
+
+void EditHistory::clearRedo()
+{
+    for (const Transaction& t : std::as_const(m_redo))
+    {
+        m_memoryBytes -= t.bytes();
+    }
+    m_redo.clear();
+}
+
+// ============================================================
+//                    内存预算与磁盘溢出
+// ============================================================
+
+void EditHistory::setMemoryBudget(qint64 bytes)
+{
+    m_budget = std::max<qint64>(0, bytes);
+    enforceBudget();
+}
+
+void EditHistory::enforceBudget()
+{
+    // 至少保留最新的一项在内存里
+    while (m_memoryBytes > m_budget && m_undo.size() > 1)
+    {
+        if (!spillOldest())
+        {
+            // 临时文件不可用：只能丢弃最旧的历史
+            m_memoryBytes -= m_undo.first().bytes();
+            m_undo.removeFirst();
+        }
+    }
+
+    // 磁盘上的历史也有上限（文件空间在清空历史时回收）
+    while (m_spilled.size() > kMaxSpilled)
+    {
+        m_spilled.removeFirst();
+    }
+}
+
+bool EditHistory::spillOldest()
+{
+    if (!m_spillFile)
+    {
+        m_spillFile = std::make_unique<QTemporaryFile>(QDir::temp().filePath("whu_undo_XXXXXX.bin"));
+        if (!m_spillFile->open())
+        {
+            qDebug() << "警告: 无法创建撤销历史临时文件";
+            m_spillFile.reset();
+            return false;
+        }
+    }
+
+    const Transaction& t = m_undo.first();
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out << t.label << static_cast<qint32>(t.deltaCount) << t.data;
+
+    SpillEntry entry;
+    entry.offset = m_spillFile->size();
+    entry.size = bytes.size();
+    if (!m_spillFile->seek(entry.offset) || m_spillFile->write(bytes) != bytes.size())
+    {
+        return false;
+    }
+
+    m_spilled.append(entry);
+    m_memoryBytes -= t.bytes();
+    m_undo.removeFirst();
+    return true;
+}
+
+// ============================================================
+// 从磁盘读回最近溢出的事务，并截掉文件尾部
+// ============================================================
+bool EditHistory::readSpilled(Transaction& out)
+{
+    if (m_spilled.isEmpty() || !m_spillFile)
+    {
+        return false;
+    }
+
+    SpillEntry entry = m_spilled.takeLast();
+    if (!m_spillFile->seek(entry.offset))
+    {
+        return false;
+    }
+    QByteArray bytes = m_spillFile->read(entry.size);
+    m_spillFile->resize(entry.offset);
+
+    QDataStream in(bytes);
+    qint32 count = 0;
+    in >> out.label >> count >> out.data;
+    out.deltaCount = count;
+    out.mergeKey = 0;
+    return in.status() == QDataStream::Ok;
+}
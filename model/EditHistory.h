@@ -0,0 +1,195 @@
+#pragma once
+
+#include "../GraphData.h"
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+#include <QTemporaryFile>
+#include <QElapsedTimer>
+#include <memory>
+
+/**
+ * @brief 一条编辑增量（解码后的形式）
+ *
+ * 增删记录携带完整的节点/道路（撤销删除时需要完整恢复）；
+ * 修改记录只有 mask 标出的字段有意义，其余字段保持默认值。
+ */
+struct EditDelta
+{
+    /**
+     * @brief 增量类型
+     */
+    enum Kind : quint8
+    {
+        AddNode,    ///< 新增节点 (after)
+        RemoveNode, ///< 删除节点 (before)
+        ChangeNode, ///< 修改节点字段 (before/after)
+        AddEdge,    ///< 新增道路 (edgeAfter)
+        RemoveEdge, ///< 删除道路 (edgeBefore)
+        ChangeEdge  ///< 修改道路字段 (edgeBefore/edgeAfter)
+    };
+
+    /**
+     * @brief 字段位（节点和道路共用 Name / Desc / Type）
+     */
+    enum Field : quint8
+    {
+        FieldName     = 1 << 0, ///< 名称
+        FieldDesc     = 1 << 1, ///< 描述
+        FieldType     = 1 << 2, ///< 节点类型 / 道路类型
+        FieldPos      = 1 << 3, ///< 节点坐标 (x, y)
+        FieldZ        = 1 << 4, ///< 节点海拔
+        FieldCategory = 1 << 5, ///< 节点分类
+        FieldDistance = 1 << 6, ///< 道路长度
+        FieldSlope    = 1 << 7  ///< 道路坡度
+    };
+
+    Kind kind = AddNode;
+    quint8 mask = 0;        ///< 修改记录中变化的字段
+    Node before;            ///< 节点修改前（RemoveNode / ChangeNode）
+    Node after;             ///< 节点修改后（AddNode / ChangeNode）
+    Edge edgeBefore;        ///< 道路修改前（RemoveEdge / ChangeEdge）
+    Edge edgeAfter;         ///< 道路修改后（AddEdge / ChangeEdge）
+
+    /**
+     * @brief 计算两个节点之间变化的字段
+     */
+    static quint8 diffNode(const Node& a, const Node& b);
+
+    /**
+     * @brief 计算两条道路之间变化的字段
+     */
+    static quint8 diffEdge(const Edge& a, const Edge& b);
+
+    /**
+     * @brief 把 source 中 mask 标出的字段复制到 target
+     */
+    static void copyNodeFields(Node& target, const Node& source, quint8 mask);
+    static void copyEdgeFields(Edge& target, const Edge& source, quint8 mask);
+};
+
+/**
+ * @brief 撤销/重做历史
+ *
+ * 每个事务（一次拖动、一次多选删除、一次导入……）是历史中的一项，
+ * 内部由若干条增量组成，以紧凑的二进制形式保存，修改记录只包含变化的字段。
+ *
+ * 内存中的历史超过预算时，最旧的事务依次写入临时文件；
+ * 撤销到那里时再从文件末尾读回，因此文件始终按栈的方式使用。
+ *
+ * 连续修改同一对象同一组字段（例如逐字输入名称）会合并为一项。
+ */
+class EditHistory
+{
+public:
+    EditHistory();
+    ~EditHistory();
+
+    /**
+     * @brief 开始一个事务（可嵌套，最外层结束时才入栈）
+     * @param label 事务名称，用于界面提示
+     */
+    void begin(const QString& label);
+
+    /**
+     * @brief 结束事务
+     *
+     * 空事务直接丢弃；非空事务入撤销栈并清空重做栈。
+     */
+    void end();
+
+    /**
+     * @brief 是否处于事务中
+     */
+    bool inTransaction() const { return m_depth > 0; }
+
+    // ---- 记录增量（必须在事务中调用，否则自动包成单独的事务）----
+    void recordNodeAdded(const Node& node);
+    void recordNodeRemoved(const Node& node);
+    void recordNodeChanged(const Node& before, const Node& after);
+    void recordEdgeAdded(const Edge& edge);
+    void recordEdgeRemoved(const Edge& edge);
+    void recordEdgeChanged(const Edge& before, const Edge& after);
+
+    bool canUndo() const { return !m_undo.isEmpty() || !m_spilled.isEmpty(); }
+    bool canRedo() const { return !m_redo.isEmpty(); }
+
+    /**
+     * @brief 取出最近一个事务用于撤销（移入重做栈）
+     * @param label 可选，返回事务名称
+     * @return QVector<EditDelta> 按记录顺序排列的增量，调用方应逆序反向应用
+     */
+    QVector<EditDelta> takeUndo(QString* label = nullptr);
+
+    /**
+     * @brief 取出最近撤销的事务用于重做（移回撤销栈）
+     * @param label 可选，返回事务名称
+     * @return QVector<EditDelta> 按记录顺序排列的增量，调用方应顺序正向应用
+     */
+    QVector<EditDelta> takeRedo(QString* label = nullptr);
+
+    /**
+     * @brief 清空全部历史（重新加载地图时调用）
+     */
+    void clear();
+
+    /**
+     * @brief 设置内存预算（字节），超出部分写入临时文件
+     */
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const { return m_budget; }
+
+    qint64 memoryUsage() const { return m_memoryBytes; }               ///< 内存中历史占用的字节数
+    int undoCount() const { return m_undo.size() + m_spilled.size(); } ///< 可撤销的事务数
+    int redoCount() const { return m_redo.size(); }                    ///< 可重做的事务数
+    int spilledCount() const { return m_spilled.size(); }              ///< 已写入磁盘的事务数
+
+private:
+    /// 一个已编码的事务
+    struct Transaction
+    {
+        QString label;
+        QByteArray data;            ///< 增量的二进制编码
+        int deltaCount = 0;
+        quint64 mergeKey = 0;       ///< 单条修改记录的合并键（0 表示不可合并）
+        qint64 createdMs = 0;
+
+        qint64 bytes() const { return data.size() + label.size() * 2 + 64; }
+    };
+
+    /// 写入磁盘的事务在临时文件中的位置
+    struct SpillEntry
+    {
+        qint64 offset = 0;
+        qint64 size = 0;
+    };
+
+    QVector<Transaction> m_undo;            ///< 内存中的撤销栈（旧 -> 新）
+    QVector<Transaction> m_redo;            ///< 重做栈（旧 -> 新）
+    QVector<SpillEntry> m_spilled;          ///< 磁盘上的撤销栈（旧 -> 新，比 m_undo 更旧）
+    std::unique_ptr<QTemporaryFile> m_spillFile;
+
+    Transaction m_current;                  ///< 正在记录的事务
+    int m_depth = 0;                        ///< 事务嵌套深度
+    quint64 m_currentMergeKey = 0;          ///< 当前事务唯一一条修改记录的合并键
+
+    qint64 m_memoryBytes = 0;
+    qint64 m_budget = 8 * 1024 * 1024;
+    QElapsedTimer m_clock;
+
+    /// 连续修改在多长时间内可以合并
+    static const qint64 kMergeWindowMs = 1500;
+    /// 磁盘上最多保留的事务数，超出后丢弃最旧的
+    static const int kMaxSpilled = 100000;
+
+    void appendDelta(const QByteArray& encoded, quint64 mergeKey);
+    bool tryMerge();
+    void enforceBudget();
+    bool spillOldest();
+    bool readSpilled(Transaction& out);
+    void clearRedo();
+
+    static QVector<EditDelta> decode(const Transaction& t);
+    static QByteArray encodeNodeFull(EditDelta::Kind kind, const Node& node);
+    static QByteArray encodeEdgeFull(EditDelta::Kind kind, const Edge& edge);
+};
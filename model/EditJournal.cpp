@@ -0,0 +1,218 @@
+// ============================================================
+// EditJournal.cpp - 追加式编辑日志
+// 负责把单次编辑追加到日志文件，按批 fsync，并支持封存/清空
+// ============================================================
+
+#include "EditJournal.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QStringConverter>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+EditJournal::EditJournal()
+{
+}
+
+EditJournal::~EditJournal()
+{
+    close();
+}
+
+// ============================================================
+// 打开日志（追加模式）
+// 已有的记录条数会被统计进 recordCount，用于决定何时压缩
+// ============================================================
+bool EditJournal::open(const QString& path)
+{
+    close();
+    m_path = path;
+
+    // 确保目录存在
+    QDir dir = QFileInfo(path).absoluteDir();
+    if (!dir.exists())
+    {
+        dir.mkpath(".");
+    }
+
+    m_recordCount = readRecords(path).size();
+    return reopen();
+}
+
+bool EditJournal::reopen()
+{
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qDebug() << "错误: 无法打开编辑日志:" << m_path;
+        return false;
+    }
+    m_unsynced = 0;
+    m_syncTimer.start();
+    return true;
+}
+
+void EditJournal::close()
+{
+    if (m_file.isOpen())
+    {
+        sync();
+        m_file.close();
+    }
+}
+
+// ============================================================
+// 追加一条记录
+// write + flush 只是一次系统调用，真正昂贵的 fsync 按批执行
+// ============================================================
+void EditJournal::append(const QString& record)
+{
+    if (!m_file.isOpen())
+    {
+        return;
+    }
+
+    QByteArray line = record.toUtf8();
+    line.append('\n');
+    m_file.write(line);
+    m_file.flush();
+
+    m_recordCount++;
+    m_unsynced++;
+
+    // 攒够一批，或距上次同步太久，就 fsync 一次
+    if (m_unsynced >= kSyncBatch || m_syncTimer.elapsed() >= kSyncIntervalMs)
+    {
+        sync();
+    }
+}
+
+void EditJournal::sync()
+{
+    if (!m_file.isOpen() || m_unsynced == 0)
+    {
+        return;
+    }
+    m_file.flush();
+    fsyncFile(m_file);
+    m_unsynced = 0;
+    m_syncTimer.restart();
+}
+
+// ============================================================
+// 封存活动段
+// 封存段不存在时直接改名（O(1)）；
+// 若上一次压缩失败遗留了封存段，则把活动段内容追加到它后面，保证顺序不乱
+// ============================================================
+bool EditJournal::seal()
+{
+    if (m_path.isEmpty())
+    {
+        return false;
+    }
+
+    close();
+
+    bool ok = true;
+    if (!QFile::exists(sealedPath()))
+    {
+        ok = QFile::rename(m_path, sealedPath());
+    }
+    else
+    {
+        QFile active(m_path);
+        QFile sealed(sealedPath());
+        if (active.open(QIODevice::ReadOnly) && sealed.open(QIODevice::WriteOnly | QIODevice::Append))
+        {
+            sealed.write(active.readAll());
+            sealed.flush();
+            fsyncFile(sealed);
+            sealed.close();
+            active.close();
+            ok = QFile::remove(m_path);
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+
+    if (!ok)
+    {
+        qDebug() << "警告: 编辑日志封存失败:" << m_path;
+    }
+    else
+    {
+        m_recordCount = 0;
+    }
+
+    reopen();
+    return ok;
+}
+
+// ============================================================
+// 清空日志（完整快照已写入磁盘，日志中的记录都已失效）
+// ============================================================
+void EditJournal::reset()
+{
+    if (m_path.isEmpty())
+    {
+        return;
+    }
+
+    m_file.close();
+    QFile::remove(sealedPath());
+    if (m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        m_file.close();
+    }
+    m_recordCount = 0;
+    reopen();
+}
+
+// ============================================================
+// 读取日志记录（用于启动时回放）
+// ============================================================
+QStringList EditJournal::readRecords(const QString& path)
+{
+    QStringList records;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return records;
+    }
+
+    QTextStream in(&file);
+    in.setEncoding(QStringConverter::Utf8);
+    while (!in.atEnd())
+    {
+        QString line = in.readLine();
+        if (!line.trimmed().isEmpty())
+        {
+            records.append(line);
+        }
+    }
+    return records;
+}
+
+bool EditJournal::fsyncFile(QFile& file)
+{
+    int fd = file.handle();
+    if (fd < 0)
+    {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(fd) == 0;
+#else
+    return ::fsync(fd) == 0;
+#endif
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QElapsedTimer>
+
+/**
+ * @brief 追加式编辑日志
+ *
+ * 每次编辑只在日志末尾追加一条紧凑记录，而不是重写整份地图文件。
+ * 记录先写入系统缓存，fsync 按批执行（攒够条数或超过时间间隔）。
+ *
+ * 日志分为两段：
+ * - 活动段 (edits.journal)：当前正在追加的记录
+ * - 封存段 (edits.journal.sealed)：正在被后台压缩进快照的旧记录
+ *
+ * 所有记录都是"最终状态"式的（整行节点/边数据或删除），重复回放是幂等的。
+ */
+class EditJournal
+{
+public:
+    EditJournal();
+    ~EditJournal();
+
+    /**
+     * @brief 打开（或创建）日志文件，以追加模式写入
+     * @param path 活动日志路径
+     * @return bool 是否打开成功
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief 同步并关闭日志
+     */
+    void close();
+
+    /**
+     * @brief 日志是否处于打开状态
+     */
+    bool isOpen() const { return m_file.isOpen(); }
+
+    /**
+     * @brief 追加一条记录
+     *
+     * 记录立即写入文件（进程崩溃不丢失），fsync 按批执行。
+     *
+     * @param record 单行记录文本（不含换行）
+     */
+    void append(const QString& record);
+
+    /**
+     * @brief 立即把所有已写记录 fsync 到磁盘
+     */
+    void sync();
+
+    /**
+     * @brief 活动段中的记录条数
+     */
+    int recordCount() const { return m_recordCount; }
+
+    /**
+     * @brief 封存活动段
+     *
+     * 把活动段的内容移入封存段（若封存段已存在则追加在其后），
+     * 然后重新打开一个空的活动段。
+     *
+     * @return bool 是否封存成功
+     */
+    bool seal();
+
+    /**
+     * @brief 清空活动段和封存段（完整快照已落盘后调用）
+     */
+    void reset();
+
+    QString path() const { return m_path; }
+    QString sealedPath() const { return m_path + QStringLiteral(".sealed"); }
+
+    /**
+     * @brief 读取日志文件中的全部记录
+     * @param path 日志文件路径
+     * @return QStringList 按写入顺序排列的记录
+     */
+    static QStringList readRecords(const QString& path);
+
+private:
+    QFile m_file;
+    QString m_path;
+    int m_recordCount = 0;      ///< 活动段记录数
+    int m_unsynced = 0;         ///< 尚未 fsync 的记录数
+    QElapsedTimer m_syncTimer;  ///< 距上次 fsync 的时间
+
+    static const int kSyncBatch = 32;          ///< 攒够多少条记录 fsync 一次
+    static const qint64 kSyncIntervalMs = 1000; ///< 最长多久 fsync 一次
+
+    bool reopen();
+    static bool fsyncFile(QFile& file);
+};
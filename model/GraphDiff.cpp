@@ -0,0 +1,87 @@
+// ============================================================
+// GraphDiff.cpp - 批量编辑的变化集合
+// 同一对象在一批中的多次变化在这里归并成最终结果
+// ============================================================
+
+#include "GraphDiff.h"
+
+// ============================================================
+// 通用归并规则（节点和道路相同）
+// ============================================================
+static void markAdded(QSet<int>& added, QSet<int>& removed, QSet<int>& modified, int id)
+{
+    // 先删后增：对外看是同一个对象变了
+    if (removed.remove(id))
+    {
+        modified.insert(id);
+    }
+    else
+    {
+        added.insert(id);
+    }
+}
+
+static void markRemoved(QSet<int>& added, QSet<int>& removed, QSet<int>& modified, int id)
+{
+    // 本批新增又删除：对外看什么都没发生
+    if (added.remove(id))
+    {
+        return;
+    }
+    modified.remove(id);
+    removed.insert(id);
+}
+
+static void markModified(const QSet<int>& added, const QSet<int>& removed, QSet<int>& modified, int id)
+{
+    if (!added.contains(id) && !removed.contains(id))
+    {
+        modified.insert(id);
+    }
+}
+
+void GraphDiff::nodeAdded(int id)
+{
+    markAdded(addedNodes, removedNodes, modifiedNodes, id);
+}
+
+void GraphDiff::nodeRemoved(int id)
+{
+    markRemoved(addedNodes, removedNodes, modifiedNodes, id);
+}
+
+void GraphDiff::nodeModified(int id)
+{
+    markModified(addedNodes, removedNodes, modifiedNodes, id);
+}
+
+void GraphDiff::edgeAdded(int id)
+{
+    markAdded(addedEdges, removedEdges, modifiedEdges, id);
+}
+
+void GraphDiff::edgeRemoved(int id)
+{
+    markRemoved(addedEdges, removedEdges, modifiedEdges, id);
+}
+
+void GraphDiff::edgeModified(int id)
+{
+    markModified(addedEdges, removedEdges, modifiedEdges, id);
+}
+
+bool GraphDiff::isEmpty() const
+{
+    return addedNodes.isEmpty() && removedNodes.isEmpty() && modifiedNodes.isEmpty()
+        && addedEdges.isEmpty() && removedEdges.isEmpty() && modifiedEdges.isEmpty();
+}
+
+void GraphDiff::clear()
+{
+    addedNodes.clear();
+    removedNodes.clear();
+    modifiedNodes.clear();
+    addedEdges.clear();
+    removedEdges.clear();
+    modifiedEdges.clear();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QObject>
+#include <QSet>
+
+/**
+ * @brief 一次批量编辑带来的变化
+ *
+ * 只记录 ID：节点用节点 ID，道路用稳定的道路 ID。
+ * 同一对象在一批中的多次变化会被归并——先增后删等于没变，
+ * 先删后增视为修改，新增后再修改仍算新增。
+ */
+struct GraphDiff
+{
+    QSet<int> addedNodes;       ///< 新增的节点
+    QSet<int> removedNodes;     ///< 删除的节点
+    QSet<int> modifiedNodes;    ///< 字段发生变化的节点
+    QSet<int> addedEdges;       ///< 新增的道路
+    QSet<int> removedEdges;     ///< 删除的道路
+    QSet<int> modifiedEdges;    ///< 字段发生变化的道路
+
+    void nodeAdded(int id);
+    void nodeRemoved(int id);
+    void nodeModified(int id);
+    void edgeAdded(int id);
+    void edgeRemoved(int id);
+    void edgeModified(int id);
+
+    /**
+     * @brief 是否没有任何变化
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief 清空
+     */
+    void clear();
+};
+
+/**
+ * @brief 图数据变化通知
+ *
+ * GraphModel 本身不是 QObject，由它持有一个通知器对外发信号，
+ * 用法与 saveScheduler() 相同。
+ */
+class GraphNotifier : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GraphNotifier(QObject* parent = nullptr) : QObject(parent) {}
+
+signals:
+    /**
+     * @brief 一批编辑提交后发出（每批一次）
+     */
+    void graphChanged(const GraphDiff& diff);
+};
@@ -3,8 +3,8 @@
 // 
 // 这个文件负责：
 // 1. 加载和保存地图数据（节点和道路）
-// 2. 实现 Dijkstra 最短路径算法
-// 3. 处理不同天气、不同交通方式的路径规划
+// 2. 提供编辑接口、撤销历史和批量提交
+// 3. 生成只读快照，寻路算法在快照上执行（见 GraphSnapshot.cpp）
 // ============================================================
 
 #include "GraphModel.h"
@@ -13,11 +13,13 @@
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
-#include <queue>
 #include <limits>
 #include <cmath>
 #include <algorithm>
 #include <QStringConverter>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QPromise>
 
 // ============================================================
 // 构造函数
@@ -28,6 +30,57 @@ GraphModel::GraphModel()
     maxBuildingId = 100;
     // 路口ID从10000开始编号（避免与建筑ID冲突）
     maxRoadId = 10000;
+
+    // 后台保存：真正写盘时才向模型要快照
+    m_saveScheduler = new SaveScheduler();
+    m_saveScheduler->setSnapshotProvider([this]() { return takeSaveSnapshot(); });
+
+    // 写盘成功后磁盘内容才真正变成快照，此时再更新热重载的基准
+    QObject::connect(m_saveScheduler, &SaveScheduler::saveFinished, m_saveScheduler, [this](bool ok, qint64) {
+        if (ok)
+        {
+            setDiskBaseline(m_savingNodes, m_savingEdges);
+        }
+        m_savingNodes.clear();
+        m_savingEdges.clear();
+    });
+
+    m_notifier = new GraphNotifier();
+
+    // 预计算：每批编辑后在后台重新准备，结果只在版本一致时装上
+    m_precompute = new PrecomputeCache();
+    m_precompute->setSnapshotProvider([this]() { return snapshot(); });
+    m_precompute->setInstaller([this](const RideMatrixPtr& matrix, quint64 version) {
+        if (version != m_graphVersion)
+        {
+            requestPrecompute();  // 准备期间图又变了
+            return;
+        }
+        m_rideMatrix = matrix;
+        m_rideMatrixVersion = version;
+        m_snapshotCache.reset();  // 同一版本的旧快照没有矩阵
+    });
+    QObject::connect(m_notifier, &GraphNotifier::graphChanged, m_precompute, [this]() { requestPrecompute(); });
+}
+
+// ============================================================
+// 析构函数
+// 写完排队中的保存，再把日志刷到磁盘
+// ============================================================
+GraphModel::~GraphModel()
+{
+    delete m_reloader;
+    delete m_precompute;
+    flushPendingSaves();
+    delete m_saveScheduler;
+    delete m_notifier;
+    m_journal.close();
+}
+
+void GraphModel::flushPendingSaves()
+{
+    m_saveScheduler->flush();
+    m_journal.sync();
 }
 
 // ============================================================
@@ -42,8 +95,13 @@ bool GraphModel::loadData(const QString& nodesPath, const QString& edgesPath)
     m_edgesPath = edgesPath;
 
     // 清空旧数据
-    nodesMap.clear();
-    edgesList.clear();
+    nodeTable.clear();
+    m_strings.clear();
+    m_descriptions.clear();
+    clearEdges();
+    m_history.clear();
+    m_regions.clear();
+    m_boundaryNodeRegion.clear();
     maxBuildingId = 100;
     maxRoadId = 10000;
 
@@ -83,14 +141,37 @@ bool GraphModel::loadData(const QString& nodesPath, const QString& edgesPath)
 
     // ---- 第3步：构建邻接表（用于后续寻路） ----
     buildAdjacencyList();
+    setDiskBaseline(nodeTable, edgesList);  // 日志回放前的内容才是磁盘上的
+
+    // ---- 第4步：回放编辑日志（快照之后的增量修改，邻接表同步增量更新） ----
+    openJournal();
     
-    // ---- 第4步：校准ID计数器 ----
-    // 确保新建节点的ID不会与已有节点冲突
-    for (auto it = nodesMap.begin(); it != nodesMap.end(); ++it)
+    // ---- 第5步：校准ID计数器 ----
+    calibrateIdCounters();
+
+    // 已启用热重载时改为监视新地图
+    if (m_reloader)
+    {
+        m_reloader->watch(m_nodesPath, m_edgesPath, m_schedulePath);
+    }
+
+    requestPrecompute();
+
+    qDebug() << "数据加载完毕: 节点数=" << nodeTable.size() << " 道路数=" << edgeCount();
+    return true;
+}
+
+// ============================================================
+// 校准ID计数器
+// 确保新建节点的ID不会与已有节点冲突
+// ============================================================
+void GraphModel::calibrateIdCounters()
+{
+    for (const Node& n : nodeTable)
     {
-        int id = it.key();
+        int id = n.id;
         
-        if (it.value().type == NodeType::Visible)
+        if (n.type == NodeType::Visible)
         {
             // 可见节点（建筑）
             if (id >= maxBuildingId)
@@ -107,17 +188,414 @@ bool GraphModel::loadData(const QString& nodesPath, const QString& edgesPath)
             }
         }
     }
+}
+
+// ============================================================
+//                    分区加载
+// 索引文件格式 (index.txt):
+//   cell,<网格边长>
+//   R,<分区ID>,<minX>,<minY>,<maxX>,<maxY>,<节点文件>,<道路文件>,<节点数>,<道路数>[,<描述文件>]
+//   B,<节点ID>,<分区ID>          跨区道路端点所在的分区
+//   boundary,<跨区道路文件>[,<描述文件>]
+// 有描述文件时，对应节点、道路行的描述列是描述在该文件中的字节偏移
+// ============================================================
+
+// ============================================================
+// 打开分区索引
+// 只读取索引和跨区道路（都很小），分区本身按需加载
+// ============================================================
+bool GraphModel::loadRegionIndex(const QString& indexPath)
+{
+    QFile file(indexPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug() << "警告: 无法打开分区索引:" << indexPath;
+        return false;
+    }
+
+    // 分区模式下地图只读：先写完旧地图的保存，再关闭日志
+    flushPendingSaves();
+    m_journal.close();
+    m_nodesPath.clear();
+    m_edgesPath.clear();
+
+    // 清空旧数据
+    nodeTable.clear();
+    m_strings.clear();
+    m_descriptions.clear();
+    clearEdges();
+    m_history.clear();
+    m_regions.clear();
+    m_boundaryNodeRegion.clear();
+    maxBuildingId = 100;
+    maxRoadId = 10000;
+
+    QDir dir = QFileInfo(indexPath).absoluteDir();
+    QHash<int, int> regionIndexById;
+    QVector<QPair<int, int>> boundaryNodes;
+    QVector<QPair<QString, QString>> boundaryFiles;     // 跨区道路文件, 描述文件
+
+    QTextStream in(&file);
+    in.setEncoding(QStringConverter::Utf8);
+    while (!in.atEnd())
+    {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith("#"))
+        {
+            continue;
+        }
+
+        QStringList parts = line.split(",");
+        QString tag = parts[0].trimmed();
+
+        if (tag == "R" && parts.size() >= 8)
+        {
+            RegionInfo region;
+            region.id = parts[1].toInt();
+            QPointF topLeft(parts[2].toDouble(), parts[3].toDouble());
+            QPointF bottomRight(parts[4].toDouble(), parts[5].toDouble());
+            region.bounds = QRectF(topLeft, bottomRight);
+            region.nodesFile = dir.filePath(parts[6].trimmed());
+            region.edgesFile = dir.filePath(parts[7].trimmed());
+            if (parts.size() >= 11)
+            {
+                region.descFile = dir.filePath(parts[10].trimmed());
+            }
+
+            regionIndexById.insert(region.id, m_regions.size());
+            m_regions.append(region);
+        }
+        else if (tag == "B" && parts.size() >= 3)
+        {
+            boundaryNodes.append(qMakePair(parts[1].toInt(), parts[2].toInt()));
+        }
+        else if (tag == "boundary" && parts.size() >= 2)
+        {
+            QString descFile = (parts.size() >= 3) ? dir.filePath(parts[2].trimmed()) : QString();
+            boundaryFiles.append(qMakePair(dir.filePath(parts[1].trimmed()), descFile));
+        }
+    }
+    file.close();
+
+    // 跨区道路端点 -> 分区下标
+    for (const auto& b : boundaryNodes)
+    {
+        if (regionIndexById.contains(b.second))
+        {
+            m_boundaryNodeRegion.insert(b.first, regionIndexById.value(b.second));
+        }
+    }
+
+    // 跨区道路常驻内存：端点所在分区加载后即可通行
+    for (const auto& files : boundaryFiles)
+    {
+        QFile edgeFile(files.first);
+        if (edgeFile.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            int descFile = files.second.isEmpty() ? -1 : m_descriptions.addFile(files.second);
+            QTextStream edgeIn(&edgeFile);
+            while (!edgeIn.atEnd())
+            {
+                parseEdgeLine(edgeIn.readLine().trimmed(), descFile);
+            }
+        }
+    }
+
+    buildAdjacencyList();
+
+    // 分区模式下地图只读，不再监视单文件地图
+    if (m_reloader)
+    {
+        m_reloader->stop();
+    }
+
+    qDebug() << "分区索引加载完毕: 分区数=" << m_regions.size() << " 跨区道路数=" << edgeCount();
+    return !m_regions.isEmpty();
+}
+
+// ============================================================
+// 加载与指定区域相交的分区
+// 分区数量很少，线性扫描索引即可
+// ============================================================
+int GraphModel::ensureRegionsLoaded(const QRectF& area)
+{
+    int loadedCount = 0;
+    for (int i = 0; i < m_regions.size(); ++i)
+    {
+        if (!m_regions[i].loaded && m_regions[i].bounds.intersects(area))
+        {
+            if (loadRegion(i))
+            {
+                loadedCount++;
+            }
+        }
+    }
+
+    if (loadedCount > 0)
+    {
+        buildAdjacencyList();
+        calibrateIdCounters();
+        qDebug() << "按需加载分区:" << loadedCount << " 当前节点数=" << nodeTable.size();
+    }
+    return loadedCount;
+}
+
+// ============================================================
+// 加载单个分区的节点和内部道路
+// ============================================================
+bool GraphModel::loadRegion(int index)
+{
+    if (index < 0 || index >= m_regions.size() || m_regions[index].loaded)
+    {
+        return false;
+    }
+
+    RegionInfo& region = m_regions[index];
+    region.loaded = true;  // 文件缺失也视为已加载，避免反复重试
+
+    // 描述文件此时不读，只登记路径，显示时按偏移取
+    int descFile = region.descFile.isEmpty() ? -1 : m_descriptions.addFile(region.descFile);
+
+    QFile nodeFile(region.nodesFile);
+    if (nodeFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QTextStream in(&nodeFile);
+        while (!in.atEnd())
+        {
+            parseNodeLine(in.readLine().trimmed(), descFile);
+        }
+    }
+    else
+    {
+        qDebug() << "警告: 无法打开分区节点文件:" << region.nodesFile;
+    }
 
-    qDebug() << "数据加载完毕: 节点数=" << nodesMap.size() << " 道路数=" << edgesList.size();
+    QFile edgeFile(region.edgesFile);
+    if (edgeFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QTextStream in(&edgeFile);
+        while (!in.atEnd())
+        {
+            parseEdgeLine(in.readLine().trimmed(), descFile);
+        }
+    }
     return true;
 }
 
+// ============================================================
+// 加载查询走廊：起点、终点、途经点的包围盒再向外留白
+// ============================================================
+void GraphModel::ensureQueryCorridorLoaded(int startId, int endId, const QVector<int>& waypoints)
+{
+    QVector<int> ids = waypoints;
+    ids.append(startId);
+    ids.append(endId);
+
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+    for (int id : ids)
+    {
+        const Node* n = std::as_const(nodeTable).find(id);
+        if (!n)
+        {
+            continue;
+        }
+        minX = std::min(minX, n->x);
+        minY = std::min(minY, n->y);
+        maxX = std::max(maxX, n->x);
+        maxY = std::max(maxY, n->y);
+    }
+    if (minX > maxX)
+    {
+        return;  // 起终点都不在内存中
+    }
+
+    double m = kQueryCorridorMargin;
+    ensureRegionsLoaded(QRectF(QPointF(minX - m, minY - m), QPointF(maxX + m, maxY + m)));
+}
+
+// ============================================================
+// 按网格切分地图，写出分区文件和索引
+// ============================================================
+static bool writeLines(const QString& path, const QStringList& lines)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qDebug() << "错误: 无法写入文件:" << path;
+        return false;
+    }
+    QTextStream out(&file);
+    out.setEncoding(QStringConverter::Utf8);
+    for (const QString& line : lines)
+    {
+        out << line << "\n";
+    }
+    out.flush();
+    return file.commit();
+}
+
+// 描述文件：每条描述一行，相同内容只写一次
+struct DescriptionWriter
+{
+    QByteArray data;
+    QHash<QString, qint64> offsets;     ///< 描述 -> 所在行的字节偏移
+
+    qint64 add(const QString& text)
+    {
+        auto it = offsets.constFind(text);
+        if (it != offsets.cend())
+        {
+            return it.value();
+        }
+        qint64 offset = data.size();
+        data += text.toUtf8();
+        data += '\n';
+        offsets.insert(text, offset);
+        return offset;
+    }
+
+    // 按二进制写出：文本模式在 Windows 上会把换行换成 \r\n，偏移就对不上了
+    bool write(const QString& path) const
+    {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qDebug() << "错误: 无法写入文件:" << path;
+            return false;
+        }
+        file.write(data);
+        return file.commit();
+    }
+};
+
+bool GraphModel::saveRegions(const QString& outDir, double cellSize) const
+{
+    if (cellSize <= 0)
+    {
+        return false;
+    }
+
+    QDir dir(outDir);
+    if (!dir.exists())
+    {
+        dir.mkpath(".");
+    }
+
+    // ---- 第1步：按坐标把节点放进网格，描述换成描述文件中的偏移 ----
+    QMap<QPair<int, int>, QStringList> cellNodeLines;   // (列, 行) -> 节点行
+    QMap<QPair<int, int>, DescriptionWriter> cellDescs; // (列, 行) -> 描述文件内容
+    QHash<int, QPair<int, int>> nodeCell;
+    for (const Node& n : nodeTable.values())
+    {
+        QPair<int, int> cell(static_cast<int>(std::floor(n.x / cellSize)),
+                             static_cast<int>(std::floor(n.y / cellSize)));
+        Node stored = n;
+        stored.description = QString::number(cellDescs[cell].add(n.description));
+        cellNodeLines[cell].append(formatNodeLine(stored));
+        nodeCell.insert(n.id, cell);
+    }
+
+    // 分区ID按网格顺序连续编号
+    QMap<QPair<int, int>, int> regionIdOf;
+    for (auto it = cellNodeLines.begin(); it != cellNodeLines.end(); ++it)
+    {
+        regionIdOf.insert(it.key(), regionIdOf.size());
+    }
+
+    // ---- 第2步：同一格内的道路归该分区，跨格道路单独存放 ----
+    QMap<int, QStringList> regionEdgeLines;
+    QStringList boundaryEdgeLines;
+    DescriptionWriter boundaryDescs;
+    QMap<int, int> boundaryNodes;   // 节点ID -> 分区ID
+    for (const Edge& e : edgesList)
+    {
+        if (e.id < 0 || !nodeCell.contains(e.u) || !nodeCell.contains(e.v))
+        {
+            continue;
+        }
+        int ru = regionIdOf.value(nodeCell.value(e.u));
+        int rv = regionIdOf.value(nodeCell.value(e.v));
+        Edge stored = e;
+        if (ru == rv)
+        {
+            stored.description = QString::number(cellDescs[nodeCell.value(e.u)].add(e.description));
+            regionEdgeLines[ru].append(formatEdgeLine(stored));
+        }
+        else
+        {
+            stored.description = QString::number(boundaryDescs.add(e.description));
+            boundaryEdgeLines.append(formatEdgeLine(stored));
+            boundaryNodes.insert(e.u, ru);
+            boundaryNodes.insert(e.v, rv);
+        }
+    }
+
+    // ---- 第3步：写分区文件和索引 ----
+    QStringList indexLines;
+    indexLines.append("# WHU-Rush 分区索引");
+    indexLines.append(QString("cell,%1").arg(cellSize));
+
+    for (auto it = regionIdOf.begin(); it != regionIdOf.end(); ++it)
+    {
+        int col = it.key().first;
+        int row = it.key().second;
+        int regionId = it.value();
+
+        QString nodesName = QString("r_%1_%2_nodes.txt").arg(col).arg(row);
+        QString edgesName = QString("r_%1_%2_edges.txt").arg(col).arg(row);
+        QString descName = QString("r_%1_%2_desc.txt").arg(col).arg(row);
+        const QStringList& nodeLines = cellNodeLines[it.key()];
+        QStringList edgeLines = regionEdgeLines.value(regionId);
+
+        if (!writeLines(dir.filePath(nodesName), nodeLines) ||
+            !writeLines(dir.filePath(edgesName), edgeLines) ||
+            !cellDescs[it.key()].write(dir.filePath(descName)))
+        {
+            return false;
+        }
+
+        QStringList fields = {
+            "R",
+            QString::number(regionId),
+            QString::number(col * cellSize),
+            QString::number(row * cellSize),
+            QString::number((col + 1) * cellSize),
+            QString::number((row + 1) * cellSize),
+            nodesName,
+            edgesName,
+            QString::number(nodeLines.size()),
+            QString::number(edgeLines.size()),
+            descName
+        };
+        indexLines.append(fields.join(','));
+    }
+
+    if (!writeLines(dir.filePath("boundary_edges.txt"), boundaryEdgeLines) ||
+        !boundaryDescs.write(dir.filePath("boundary_desc.txt")))
+    {
+        return false;
+    }
+    indexLines.append("boundary,boundary_edges.txt,boundary_desc.txt");
+
+    for (auto it = boundaryNodes.begin(); it != boundaryNodes.end(); ++it)
+    {
+        indexLines.append(QString("B,%1,%2").arg(it.key()).arg(it.value()));
+    }
+
+    return writeLines(dir.filePath("index.txt"), indexLines);
+}
+
 // ============================================================
 // 加载校车时刻表
 // ============================================================
 bool GraphModel::loadSchedule(const QString& csvPath)
 {
     stationSchedules.clear();
+    m_graphVersion++;  // 快照中带有时刻表
+    m_schedulePath = csvPath;
     
     QFile file(csvPath);
     bool opened = file.open(QIODevice::ReadOnly | QIODevice::Text);
@@ -131,6 +609,9 @@ bool GraphModel::loadSchedule(const QString& csvPath)
             parseScheduleLine(line);
         }
         file.close();
+        m_diskBaseline.schedules = stationSchedules;
+        m_diskBaseline.generation++;
+        requestPrecompute();
         qDebug() << "时刻表加载完毕: 包含" << stationSchedules.size() << "个站点";
         return true;
     }
@@ -143,8 +624,32 @@ bool GraphModel::loadSchedule(const QString& csvPath)
 
 // ============================================================
 // 保存地图数据到文件
+// 如果保存的就是当前地图，日志中的记录都已包含在快照里，可以清空
 // ============================================================
 bool GraphModel::saveData(const QString& nodesPath, const QString& edgesPath)
+{
+    // 先等后台写盘结束，避免两次写同一个文件
+    m_saveScheduler->waitForIdle();
+
+    bool ok = writeSnapshot(nodeTable, edgesList, nodesPath, edgesPath);
+
+    bool isCurrentMap = (QFileInfo(nodesPath) == QFileInfo(m_nodesPath) &&
+                         QFileInfo(edgesPath) == QFileInfo(m_edgesPath));
+    if (ok && isCurrentMap)
+    {
+        m_journal.reset();
+        m_saveScheduler->cancelPending();
+        setDiskBaseline(nodeTable, edgesList);
+    }
+    return ok;
+}
+
+// ============================================================
+// 把节点和边完整写入文件（可在后台线程调用）
+// QSaveFile 先写临时文件，commit() 时原子替换目标文件
+// ============================================================
+bool GraphModel::writeSnapshot(const NodeTable& nodes, const QVector<Edge>& edges,
+                               const QString& nodesPath, const QString& edgesPath)
 {
     // 确保目录存在
     QFileInfo fileInfo(nodesPath);
@@ -155,7 +660,7 @@ bool GraphModel::saveData(const QString& nodesPath, const QString& edgesPath)
     }
 
     // ---- 保存节点 ----
-    QFile nodeFile(nodesPath);
+    QSaveFile nodeFile(nodesPath);
     bool nodeOpened = nodeFile.open(QIODevice::WriteOnly | QIODevice::Text);
     
     if (!nodeOpened)
@@ -167,23 +672,15 @@ bool GraphModel::saveData(const QString& nodesPath, const QString& edgesPath)
     QTextStream outNode(&nodeFile);
     outNode.setEncoding(QStringConverter::Utf8);
     
-    // 按ID排序后写入
-    QList<int> keys = nodesMap.keys();
-    std::sort(keys.begin(), keys.end());
-    
-    for (int id : keys)
+    // 按 ID 排序后写出，文件内容与节点表的存放顺序无关
+    for (const Node& n : nodes.values())
     {
-        const Node& n = nodesMap[id];
-        int typeInt = (n.type == NodeType::Visible) ? 0 : 9;
-        QString catStr = Node::categoryToString(n.category);
-        
-        outNode << n.id << "," << n.name << "," << n.x << "," << n.y << "," << n.z << ","
-                << typeInt << "," << n.description << "," << catStr << "\n";
+        outNode << formatNodeLine(n) << "\n";
     }
-    nodeFile.close();
+    outNode.flush();
 
     // ---- 保存道路 ----
-    QFile edgeFile(edgesPath);
+    QSaveFile edgeFile(edgesPath);
     bool edgeOpened = edgeFile.open(QIODevice::WriteOnly | QIODevice::Text);
     
     if (!edgeOpened)
@@ -195,38 +692,97 @@ bool GraphModel::saveData(const QString& nodesPath, const QString& edgesPath)
     QTextStream outEdge(&edgeFile);
     outEdge.setEncoding(QStringConverter::Utf8);
     
-    for (const Edge& e : edgesList)
+    for (const Edge& e : edges)
+    {
+        if (e.id < 0)
+        {
+            continue;  // 已删除（墓碑）
+        }
+        outEdge << formatEdgeLine(e) << "\n";
+    }
+    outEdge.flush();
+
+    // 两个文件都写完整后再一起替换
+    if (!nodeFile.commit() || !edgeFile.commit())
     {
-        outEdge << e.u << "," << e.v << "," << e.distance << ","
-                << static_cast<int>(e.type) << "," << e.slope << ","
-                << e.name << "," << e.description << "\n";
+        qDebug() << "错误: 地图文件替换失败:" << nodesPath << edgesPath;
+        return false;
     }
-    edgeFile.close();
     
     return true;
 }
 
+// ============================================================
+// 节点 / 边的单行文本格式（文件、日志共用）
+// ============================================================
+QString GraphModel::formatNodeLine(const Node& n)
+{
+    int typeInt = (n.type == NodeType::Visible) ? 0 : 9;
+    QStringList fields = {
+        QString::number(n.id),
+        n.name,
+        QString::number(n.x),
+        QString::number(n.y),
+        QString::number(n.z),
+        QString::number(typeInt),
+        n.description,
+        Node::categoryToString(n.category)
+    };
+    return fields.join(',');
+}
+
+QString GraphModel::formatEdgeLine(const Edge& e)
+{
+    QStringList fields = {
+        QString::number(e.u),
+        QString::number(e.v),
+        QString::number(e.distance),
+        QString::number(static_cast<int>(e.type)),
+        QString::number(e.slope),
+        e.name,
+        e.description
+    };
+    return fields.join(',');
+}
+
 // ============================================================
 // 解析节点文件的一行数据
 // 格式: id, name, x, y, z, type, description, category
 // ============================================================
-void GraphModel::parseNodeLine(const QString& line)
+void GraphModel::parseNodeLine(const QString& line, int descFile)
+{
+    Node node;
+    if (parseNodeFields(line, node))
+    {
+        if (descFile >= 0)
+        {
+            // 描述列是描述文件中的偏移：只记位置，用到时再读
+            m_descriptions.setNode(node.id, descFile, node.description.toLongLong());
+            node.description.clear();
+        }
+
+        // 存入节点表（整批加载，之后统一重建邻接表）
+        internStrings(node);
+        nodeTable.insert(node);
+    }
+}
+
+bool GraphModel::parseNodeFields(const QString& line, Node& node)
 {
     // 跳过空行和注释行
     if (line.isEmpty() || line.startsWith("#"))
     {
-        return;
+        return false;
     }
     
     // 按逗号分割
     QStringList parts = line.split(",");
     if (parts.size() < 6)
     {
-        return;  // 数据不完整，跳过
+        return false;  // 数据不完整，跳过
     }
     
     // 填充节点数据
-    Node node;
     node.id = parts[0].toInt();
     node.name = parts[1].trimmed();
     node.x = parts[2].toDouble();
@@ -254,29 +810,43 @@ void GraphModel::parseNodeLine(const QString& line)
         node.description = "无";
         node.category = NodeCategory::None;
     }
-    
-    // 存入哈希表
-    nodesMap.insert(node.id, node);
+    return true;
 }
 
 // ============================================================
 // 解析道路文件的一行数据
 // 格式: u, v, distance, type, slope, name, description
 // ============================================================
-void GraphModel::parseEdgeLine(const QString& line)
+void GraphModel::parseEdgeLine(const QString& line, int descFile)
+{
+    Edge edge;
+    if (parseEdgeFields(line, edge))
+    {
+        if (descFile < 0)
+        {
+            storeEdge(edge);
+            return;
+        }
+
+        qint64 offset = edge.description.toLongLong();
+        edge.description.clear();
+        m_descriptions.setEdge(storeEdge(edge), descFile, offset);
+    }
+}
+
+bool GraphModel::parseEdgeFields(const QString& line, Edge& edge)
 {
     if (line.isEmpty() || line.startsWith("#"))
     {
-        return;
+        return false;
     }
     
     QStringList parts = line.split(",");
     if (parts.size() < 3)
     {
-        return;
+        return false;
     }
 
-    Edge edge;
     edge.u = parts[0].toInt();          // 起点ID
     edge.v = parts[1].toInt();          // 终点ID
     edge.distance = parts[2].toDouble(); // 距离（米）
@@ -308,8 +878,7 @@ void GraphModel::parseEdgeLine(const QString& line)
     {
         edge.description = parts[6].trimmed();
     }
-    
-    edgesList.append(edge);
+    return true;
 }
 
 // ============================================================
@@ -317,20 +886,30 @@ void GraphModel::parseEdgeLine(const QString& line)
 // 格式: stationId, time1, time2, time3, ...
 // ============================================================
 void GraphModel::parseScheduleLine(const QString& line)
+{
+    int stationId;
+    QVector<QTime> times;
+    if (parseScheduleFields(line, stationId, times))
+    {
+        stationSchedules.insert(stationId, times);
+    }
+}
+
+bool GraphModel::parseScheduleFields(const QString& line, int& stationId, QVector<QTime>& times)
 {
     if (line.isEmpty() || line.startsWith("#"))
     {
-        return;
+        return false;
     }
     
     QStringList parts = line.split(",");
     if (parts.size() < 2)
     {
-        return;
+        return false;
     }
 
-    int stationId = parts[0].toInt();
-    QVector<QTime> times;
+    stationId = parts[0].toInt();
+    times.clear();
     
     // 从第2列开始都是发车时间
     for (int i = 1; i < parts.size(); ++i)
@@ -352,7 +931,7 @@ void GraphModel::parseScheduleLine(const QString& line)
     
     // 按时间排序
     std::sort(times.begin(), times.end());
-    stationSchedules.insert(stationId, times);
+    return true;
 }
 
 // ============================================================
@@ -361,19 +940,179 @@ void GraphModel::parseScheduleLine(const QString& line)
 // ============================================================
 void GraphModel::buildAdjacencyList()
 {
+    // 整体重建时顺带按坐标重排节点下标：相邻节点在距离表、邻接表里也相邻
+    // 之后的增量编辑只占空位或追加，局部性逐渐变差，到下次整体重建时恢复
+    nodeTable.sortByLocation();
+
     adj.clear();
+    adj.resize(nodeTable.slotCount());
+    m_adjPending.clear();
+    m_connectivity.invalidate();
+    m_graphVersion++;
     
     // 遍历所有边，为每个节点建立"邻居列表"
     for (const Edge& edge : edgesList)
     {
+        if (edge.id < 0)
+        {
+            continue;  // 已删除（墓碑）
+        }
+
         // 正向：从u到v
-        adj[edge.u].append(edge);
+        adjAppend(edge.u, edge.v, edge);
         
-        // 反向：从v到u（无向图需要双向）
-        Edge reverseEdge = edge;
-        std::swap(reverseEdge.u, reverseEdge.v);
-        reverseEdge.slope = -edge.slope;  // 坡度取反
-        adj[edge.v].append(reverseEdge);
+        // 反向：从v到u（无向图需要双向，坡度取反）
+        adjAppend(edge.v, edge.u, edge);
+    }
+}
+
+// ============================================================
+// 邻接表增量维护
+// 编辑时只改动涉及的两个端点的邻居列表，代价是 O(度数) 而不是 O(E)
+// ============================================================
+void GraphModel::adjInsertEdge(const Edge& edge)
+{
+    adjAppend(edge.u, edge.v, edge);
+    adjAppend(edge.v, edge.u, edge);
+
+    m_connectivity.edgeInserted(AdjEdge::forward(edge));
+    m_graphVersion++;
+}
+
+void GraphModel::adjRemoveEdge(int u, int v)
+{
+    // 两侧都要取出；哪一侧在内存中就用哪一侧的记录通知连通性
+    AdjEdge removed;
+    bool forwardFound = adjTake(u, v, &removed);
+    bool backwardFound = adjTake(v, u, forwardFound ? nullptr : &removed);
+    if (forwardFound || backwardFound)
+    {
+        m_connectivity.edgeRemoved(removed);
+    }
+    m_graphVersion++;
+}
+
+void GraphModel::adjRemoveNode(int id)
+{
+    // 先拷贝邻居 ID：adjRemoveEdge 会修改邻接表
+    const QVector<int> neighbors = adjNeighborIds(id);
+    for (int other : neighbors)
+    {
+        adjRemoveEdge(id, other);
+    }
+    m_graphVersion++;
+}
+
+QVector<int> GraphModel::adjNeighborIds(int id) const
+{
+    int dense = nodeTable.denseOf(id);
+    if (dense < 0)
+    {
+        return m_adjPending.value(id);
+    }
+
+    QVector<int> ids;
+    ids.reserve(adj[dense].size());
+    for (const AdjEdge& e : adj[dense])
+    {
+        ids.append(e.v);
+    }
+    return ids;
+}
+
+// ============================================================
+// 单侧的加入与取出
+// 邻接表按稠密下标存放，只有在内存中的节点才有邻居列表；
+// 端点缺席（分区未加载、文件里的道路指向不存在的节点）的一侧记在 m_adjPending
+// ============================================================
+void GraphModel::adjAppend(int from, int to, const Edge& edge)
+{
+    int dense = nodeTable.denseOf(from);
+    if (dense < 0)
+    {
+        m_adjPending[from].append(to);
+        return;
+    }
+
+    AdjEdge half = (edge.u == from) ? AdjEdge::forward(edge) : AdjEdge::backward(edge);
+    half.to = nodeTable.denseOf(to);
+    adj[dense].append(half);
+}
+
+bool GraphModel::adjTake(int from, int to, AdjEdge* removed)
+{
+    int dense = nodeTable.denseOf(from);
+    if (dense < 0)
+    {
+        auto pending = m_adjPending.find(from);
+        if (pending != m_adjPending.end())
+        {
+            pending.value().removeOne(to);
+            if (pending.value().isEmpty())
+            {
+                m_adjPending.erase(pending);
+            }
+        }
+        return false;
+    }
+
+    QVector<AdjEdge>& list = adj[dense];
+    for (int i = 0; i < list.size(); ++i)
+    {
+        if (list[i].v == to)
+        {
+            if (removed)
+            {
+                *removed = list[i];
+            }
+            list.removeAt(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================
+// 存入节点
+// 新节点的下标可能是刚空出来的，邻居列表一定已被清空；
+// 先前指向这个 ID 的道路（缺席时记在 m_adjPending）此时补进邻接表
+// ============================================================
+void GraphModel::insertNode(const Node& node)
+{
+    bool isNew = !nodeTable.contains(node.id);
+    int dense = nodeTable.insert(node);
+    m_graphVersion++;  // 快照中带有节点的名称、坐标、分类
+    if (!isNew)
+    {
+        return;
+    }
+    if (adj.size() < nodeTable.slotCount())
+    {
+        adj.resize(nodeTable.slotCount());
+    }
+
+    const QVector<int> partners = m_adjPending.take(node.id);
+    for (int other : partners)
+    {
+        const Edge* edge = findEdge(node.id, other);
+        if (!edge)
+        {
+            continue;
+        }
+        adjAppend(node.id, other, *edge);
+
+        // 对侧早已在内存中：把它那一份指向新下标
+        int otherDense = nodeTable.denseOf(other);
+        if (otherDense >= 0)
+        {
+            for (AdjEdge& e : adj[otherDense])
+            {
+                if (e.v == node.id)
+                {
+                    e.to = dense;
+                }
+            }
+        }
     }
 }
 
@@ -400,7 +1139,7 @@ int GraphModel::addNode(double x, double y, NodeType type)
     }
 
     // 找到一个没被使用的ID
-    while (nodesMap.contains(*pCounter))
+    while (nodeTable.contains(*pCounter))
     {
         (*pCounter)++;
     }
@@ -428,16 +1167,18 @@ int GraphModel::addNode(double x, double y, NodeType type)
         n.name = QString("路口_%1").arg(id);
         n.category = NodeCategory::Road;
     }
-    // 存入哈希表
-    nodesMap.insert(id, n);
+    internStrings(n);
+    beginBatch();
+
+    // 存入节点表
+    insertNode(n);
+    m_pendingDiff.nodeAdded(id);
     
     // 记录操作，用于撤销
-    HistoryAction act;
-    act.type = HistoryAction::AddNode;
-    act.nodeData = n;
-    undoStack.push(act);
+    m_history.recordNodeAdded(n);
     
-    autoSave();
+    journalNode(n);
+    commit();
     return id;
 }
 
@@ -446,46 +1187,58 @@ int GraphModel::addNode(double x, double y, NodeType type)
 // ============================================================
 void GraphModel::deleteNode(int id)
 {
-    if (!nodesMap.contains(id))
+    const Node* found = std::as_const(nodeTable).find(id);
+    if (!found)
     {
         return;
     }
     
-    Node target = nodesMap[id];
+    Node target = *found;
     
-    // 删除与该节点相连的所有边
-    for (int i = edgesList.size() - 1; i >= 0; --i)
+    // 删除节点以及与它相连的所有边（邻接表同步增量更新）
+    QVector<Edge> removedEdges;
+    removeNodeAndEdges(id, &removedEdges);
+    
+    // 相连的边和节点作为一个事务记录，撤销时一起恢复
+    beginBatch("删除节点");
+    for (const Edge& e : removedEdges)
     {
-        bool connectedToTarget = (edgesList[i].u == id || edgesList[i].v == id);
-        if (connectedToTarget)
-        {
-            edgesList.removeAt(i);
-        }
+        m_history.recordEdgeRemoved(e);
+        m_pendingDiff.edgeRemoved(e.id);
     }
-    
-    // 删除节点
-    nodesMap.remove(id);
-    buildAdjacencyList();
-    
-    // 记录操作
-    HistoryAction act;
-    act.type = HistoryAction::DeleteNode;
-    act.nodeData = target;
-    undoStack.push(act);
+    m_history.recordNodeRemoved(target);
+    m_pendingDiff.nodeRemoved(id);
 
-    autoSave();
+    journalNodeRemoved(id);
+    commit();
 }
 
 // ============================================================
 // 更新节点属性
 // ============================================================
-void GraphModel::updateNode(const Node& n)
+void GraphModel::updateNode(const Node& changed)
 {
-    if (nodesMap.contains(n.id))
+    Node* stored = nodeTable.find(changed.id);
+    if (!stored)
+    {
+        return;
+    }
+    Node n = changed;
+    internStrings(n);
+
+    // 只记录变化的字段；连续输入同一字段会在历史中合并
+    Node before = *stored;
+    if (EditDelta::diffNode(before, n) == 0)
     {
-        nodesMap[n.id] = n;
-        autoSave();
+        return;
     }
+    beginBatch();
+    *stored = n;
+    m_graphVersion++;
+    m_history.recordNodeChanged(before, n);
+    m_pendingDiff.nodeModified(n.id);
+    journalNode(n);
+    commit();
 }
 
 // ============================================================
@@ -493,35 +1246,36 @@ void GraphModel::updateNode(const Node& n)
 // ============================================================
 void GraphModel::addOrUpdateEdge(const Edge& edge)
 {
-    // 检查是否已存在
-    bool found = false;
-    for (int i = 0; i < edgesList.size(); ++i)
+    beginBatch();
+
+    // 哈希索引查找是否已存在（无向）
+    const Edge* existing = findEdge(edge.u, edge.v);
+    bool found = (existing != nullptr);
+    Edge before;
+    if (found)
     {
-        bool sameEdge = (edgesList[i].u == edge.u && edgesList[i].v == edge.v);
-        bool reverseEdge = (edgesList[i].u == edge.v && edgesList[i].v == edge.u);
-        
-        if (sameEdge || reverseEdge)
-        {
-            // 更新已有边
-            edgesList[i] = edge;
-            found = true;
-            break;
-        }
+        before = *existing;
+        adjRemoveEdge(edge.u, edge.v);
     }
-    
-    if (!found)
+
+    // 已存在则原位更新并保留 ID，否则分配新 ID
+    Edge stored = edge;
+    storeEdge(stored);
+
+    if (found)
     {
-        // 添加新边
-        edgesList.append(edge);
-        
-        HistoryAction act;
-        act.type = HistoryAction::AddEdge;
-        act.edgeData = edge;
-        undoStack.push(act);
+        m_history.recordEdgeChanged(before, stored);
+        m_pendingDiff.edgeModified(stored.id);
+    }
+    else
+    {
+        m_history.recordEdgeAdded(stored);
+        m_pendingDiff.edgeAdded(stored.id);
     }
     
-    buildAdjacencyList();
-    autoSave();
+    adjInsertEdge(stored);
+    journalEdge(stored);
+    commit();
 }
 
 // ============================================================
@@ -529,566 +1283,1204 @@ void GraphModel::addOrUpdateEdge(const Edge& edge)
 // ============================================================
 void GraphModel::deleteEdge(int u, int v)
 {
-    for (int i = 0; i < edgesList.size(); ++i)
+    Edge removed;
+    if (!unstoreEdge(u, v, &removed))
     {
-        const Edge& e = edgesList[i];
-        bool sameEdge = (e.u == u && e.v == v);
-        bool reverseEdge = (e.u == v && e.v == u);
-        
-        if (sameEdge || reverseEdge)
-        {
-            // 记录操作
-            HistoryAction act;
-            act.type = HistoryAction::DeleteEdge;
-            act.edgeData = e;
-            undoStack.push(act);
-            
-            edgesList.removeAt(i);
-            buildAdjacencyList();
-            
-            autoSave();
-            return;
-        }
+        return;
     }
+
+    beginBatch();
+
+    // 记录操作
+    m_history.recordEdgeRemoved(removed);
+    m_pendingDiff.edgeRemoved(removed.id);
+
+    adjRemoveEdge(u, v);
+    journalEdgeRemoved(u, v);
+    commit();
 }
 
 // ============================================================
-// 撤销操作
+// 导入过的草稿改名保留（覆盖上一次导入留下的），原路径空出来给下一次会话
 // ============================================================
-void GraphModel::undo()
+void GraphModel::rotateDraft(const QString& path)
 {
-    if (undoStack.isEmpty())
+    if (!QFile::exists(path))
     {
         return;
     }
-    
-    HistoryAction act = undoStack.pop();
-    
-    switch (act.type)
+    const QString imported = path + ".imported";
+    QFile::remove(imported);
+    if (!QFile::rename(path, imported))
     {
-    case HistoryAction::AddNode:
-        // 撤销添加 = 删除
-        nodesMap.remove(act.nodeData.id);
-        break;
-        
-    case HistoryAction::DeleteNode:
-        // 撤销删除 = 恢复
-        nodesMap.insert(act.nodeData.id, act.nodeData);
-        break;
-        
-    case HistoryAction::AddEdge:
-        // 撤销添加边 = 删除边
-        deleteEdge(act.edgeData.u, act.edgeData.v);
-        undoStack.pop();  // deleteEdge会再次入栈，需要弹出
-        break;
-        
-    case HistoryAction::DeleteEdge:
-        // 撤销删除边 = 恢复边
-        edgesList.append(act.edgeData);
-        buildAdjacencyList();
-        break;
-        
-    case HistoryAction::MoveNode:
-        // 撤销移动 = 恢复原位置
-        nodesMap[act.nodeData.id] = act.nodeData;
-        break;
+        qDebug() << "警告: 无法改名已导入的草稿:" << path;
     }
-    
-    autoSave();
 }
 
-bool GraphModel::canUndo() const
-{
-    return !undoStack.isEmpty();
-}
-
-void GraphModel::pushAction(const HistoryAction& action)
-{
-    undoStack.push(action);
-}
-
-// ============================================================
-//             核心物理与寻路逻辑
 // ============================================================
-
-// ============================================================
-// 获取实际行进速度（米/秒）
-// 根据交通方式和天气计算实际速度
+// 批量导入草稿会话
+// 草稿里的 ID 是 MapEditor 自己的计数器分配的，和当前地图可能冲突，
+// 所以节点统一重新分配 ID，道路端点按映射表改写
 // ============================================================
-double GraphModel::getRealSpeed(TransportMode mode, Weather weather) const
+int GraphModel::importDraft(const QString& nodesDraftPath, const QString& edgesDraftPath)
 {
-    double speed = 0.0;
-    
-    switch (mode)
+    QFile nodesFile(nodesDraftPath);
+    if (!nodesFile.open(QIODevice::ReadOnly | QIODevice::Text))
     {
-    case TransportMode::Walk:
-        speed = Config::SPEED_WALK;  // 基础步行速度
-        if (weather == Weather::Rainy)
-        {
-            speed = speed * 0.8;  // 下雨减速20%
-        }
-        if (weather == Weather::Snowy)
+        qDebug() << "错误: 无法打开节点草稿:" << nodesDraftPath;
+        return -1;
+    }
+
+    // 整个草稿作为一批：一次撤销全部回退，一次通知、一次保存
+    beginBatch("导入草稿");
+
+    // ---- 第1步：导入节点，记录 草稿ID -> 新ID ----
+    QHash<int, int> idMap;
+    QTextStream nodesIn(&nodesFile);
+    nodesIn.setEncoding(QStringConverter::Utf8);
+    while (!nodesIn.atEnd())
+    {
+        Node node;
+        if (!parseNodeFields(nodesIn.readLine().trimmed(), node) || idMap.contains(node.id))
         {
-            speed = speed * 0.6;  // 下雪减速40%
+            continue;
         }
-        break;
-        
-    case TransportMode::Run:
-        speed = Config::SPEED_RUN;
-        if (weather != Weather::Sunny)
+
+        int* pCounter = (node.type == NodeType::Visible) ? &maxBuildingId : &maxRoadId;
+        while (nodeTable.contains(*pCounter))
         {
-            speed = speed * 0.7;  // 非晴天减速30%
+            (*pCounter)++;
         }
-        break;
-        
-    case TransportMode::SharedBike:
-        if (weather == Weather::Snowy)
+        int newId = (*pCounter)++;
+        idMap.insert(node.id, newId);
+
+        node.id = newId;
+        if (node.type == NodeType::Ghost && node.category == NodeCategory::None)
         {
-            return 0.0001;  // 下雪不能骑车
+            node.category = NodeCategory::Road;
         }
-        speed = Config::SPEED_SHARED_BIKE;
-        break;
-        
-    case TransportMode::EBike:
-        if (weather == Weather::Snowy)
+        internStrings(node);
+        insertNode(node);
+        m_pendingDiff.nodeAdded(newId);
+
+        m_history.recordNodeAdded(node);
+        m_journal.append("N," + formatNodeLine(node));
+    }
+    nodesFile.close();
+
+    // ---- 第2步：导入道路（道路草稿可以不存在）----
+    QFile edgesFile(edgesDraftPath);
+    int edgeCount = 0;
+    if (edgesFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QSet<QPair<int, int>> seen;
+        QTextStream edgesIn(&edgesFile);
+        edgesIn.setEncoding(QStringConverter::Utf8);
+        while (!edgesIn.atEnd())
         {
-            return 0.0001;  // 下雪不能骑电动车
+            Edge edge;
+            if (!parseEdgeFields(edgesIn.readLine().trimmed(), edge))
+            {
+                continue;
+            }
+            if (!idMap.contains(edge.u) || !idMap.contains(edge.v))
+            {
+                continue;  // 端点不在这次草稿里
+            }
+            edge.u = idMap.value(edge.u);
+            edge.v = idMap.value(edge.v);
+
+            QPair<int, int> key(std::min(edge.u, edge.v), std::max(edge.u, edge.v));
+            if (edge.u == edge.v || seen.contains(key))
+            {
+                continue;
+            }
+            seen.insert(key);
+
+            if (edge.distance <= 0.0)
+            {
+                const Node& a = *std::as_const(nodeTable).find(edge.u);
+                const Node& b = *std::as_const(nodeTable).find(edge.v);
+                edge.distance = std::hypot(a.x - b.x, a.y - b.y) * Config::METERS_PER_PIXEL;
+            }
+            if (edge.description.isEmpty())
+            {
+                edge.description = "无";
+            }
+            storeEdge(edge);
+            adjInsertEdge(edge);
+
+            m_history.recordEdgeAdded(edge);
+            m_pendingDiff.edgeAdded(edge.id);
+            m_journal.append("E," + formatEdgeLine(edge));
+            edgeCount++;
         }
-        speed = Config::SPEED_EBIKE;
-        break;
-        
-    case TransportMode::Bus:
-        speed = Config::SPEED_BUS;
-        break;
+        edgesFile.close();
     }
-    
-    return speed;
+
+    // ---- 第3步：整批只请求一次保存 ----
+    if (!idMap.isEmpty())
+    {
+        m_graphVersion++;
+        scheduleSnapshotSave();
+    }
+    commit();
+
+    // ---- 第4步：草稿改名为 *.imported，再次导入不会重复添加 ----
+    rotateDraft(nodesDraftPath);
+    rotateDraft(edgesDraftPath);
+
+    qDebug() << "草稿导入完毕: 节点数=" << idMap.size() << " 道路数=" << edgeCount;
+    return idMap.size();
 }
 
 // ============================================================
-// 计算边的权重（用于路径搜索）
-// 权重可以是距离、时间或综合代价
+// 执行拓扑清理方案
+// 先合并重叠节点，再建交叉路口、切开道路（方案中道路端点已是合并后的 ID）
 // ============================================================
-double GraphModel::getEdgeWeight(
-    const Edge& edge,
-    WeightMode weightMode,
-    TransportMode transportMode,
-    Weather weather) const
+GraphDiff GraphModel::applyTopologyPlan(const TopologyPlan& plan)
 {
-    // 判断是否是骑行类交通
-    bool isVehicle = (transportMode == TransportMode::SharedBike || 
-                      transportMode == TransportMode::EBike);
-    
-    // ---- 特殊情况处理：返回极大值表示"不可通行" ----
-    // 下雪天不能骑车
-    if (weather == Weather::Snowy && isVehicle)
-    {
-        return std::numeric_limits<double>::max();
-    }
-    
-    // 骑车不能走楼梯和室内
-    if (isVehicle)
-    {
-        bool cannotPass = (edge.type == EdgeType::Stairs || edge.type == EdgeType::Indoor);
-        if (cannotPass)
-        {
-            return std::numeric_limits<double>::max();
-        }
-    }
-    
-    // ---- 根据权重模式计算 ----
-    if (weightMode == WeightMode::DISTANCE)
+    auto lengthBetween = [this](int a, int b) {
+        const Node& na = *std::as_const(nodeTable).find(a);
+        const Node& nb = *std::as_const(nodeTable).find(b);
+        return std::hypot(na.x - nb.x, na.y - nb.y) * Config::METERS_PER_PIXEL;
+    };
+
+    beginBatch("拓扑清理");
+
+    // ---- 第1步：合并节点，道路改接到保留节点 ----
+    QHash<int, int> keepOf;
+    for (const TopologyPlan::NodeMerge& m : plan.merges)
     {
-        return edge.distance;  // 只考虑距离
+        keepOf.insert(m.dropId, m.keepId);
     }
 
-    // 获取基础速度
-    double speed = getRealSpeed(transportMode, weather);
-    
-    // 坡道减速
-    if (std::abs(edge.slope) > Config::SLOPE_THRESHOLD)
+    for (const TopologyPlan::NodeMerge& m : plan.merges)
     {
-        if (transportMode == TransportMode::SharedBike)
-        {
-            speed = speed * 0.3;  // 单车爬坡很慢
-        }
-        else if (transportMode == TransportMode::Walk)
+        if (!nodeTable.contains(m.keepId) || !nodeTable.contains(m.dropId))
         {
-            speed = speed * 0.8;
+            continue;
         }
-        else if (transportMode == TransportMode::Run)
+
+        // 先拷贝邻居列表：改接和删除都会修改邻接表
+        const QVector<AdjEdge> incident = adj.value(nodeTable.denseOf(m.dropId));
+        for (const AdjEdge& e : incident)
         {
-            speed = speed * 0.6;
+            // 另一端也并入同一个节点：改接后成了自环，直接丢弃
+            if (keepOf.value(e.v, e.v) == m.keepId || findEdge(m.keepId, e.v))
+            {
+                continue;
+            }
+            const Edge& original = *edgeById(e.id);   // 名称、描述、原始精度的坡度只在道路表中
+            Edge moved = original;
+            moved.id = -1;
+            moved.u = m.keepId;     // 邻接表里 u 一侧的方向即 dropId -> e.v，坡度方向不变
+            moved.v = e.v;
+            moved.slope = (original.u == e.u) ? original.slope : -original.slope;
+            moved.distance = lengthBetween(m.keepId, e.v);
+            addOrUpdateEdge(moved);
         }
+        deleteNode(m.dropId);
     }
 
-    // 雨天骑车额外惩罚
-    double penaltyMultiplier = 1.0;
-    if (weather == Weather::Rainy && isVehicle)
+    // ---- 第2步：交叉处新建路口 ----
+    QHash<int, int> junctionNode;
+    for (const TopologyPlan::Junction& j : plan.junctions)
     {
-        penaltyMultiplier = 1.5;
+        junctionNode.insert(j.key, addNode(j.pos.x(), j.pos.y(), NodeType::Ghost));
     }
 
-    // 计算通过时间
-    double time = (edge.distance / speed) * penaltyMultiplier;
-    
-    if (weightMode == WeightMode::TIME)
+    // ---- 第3步：在路口处切开道路，各段重算长度 ----
+    for (const TopologyPlan::EdgeSplit& split : plan.splits)
     {
-        return time;
-    }
+        const Edge* found = findEdge(split.u, split.v);
+        if (!found)
+        {
+            continue;
+        }
+        const Edge base = *found;
 
-    // 综合代价模式（懒人路线）
-    if (weightMode == WeightMode::COST)
-    {
-        double cost = edge.distance;
-        
-        // 坡道很累，大幅增加代价
-        if (std::abs(edge.slope) > Config::SLOPE_THRESHOLD)
+        QVector<int> chain;
+        chain.append(split.u);
+        for (int key : split.junctionKeys)
         {
-            cost = cost * 20.0;
+            chain.append(junctionNode.value(key));
         }
-        
-        // 楼梯也很累
-        if (edge.type == EdgeType::Stairs)
+        chain.append(split.v);
+
+        // 各段沿用原道路的方向（坡度的正负与方向有关）
+        if (base.u != split.u)
         {
-            cost = cost * 10.0;
+            std::reverse(chain.begin(), chain.end());
         }
-        
-        // 下雪天走楼梯超级危险
-        if (weather == Weather::Snowy && edge.type == EdgeType::Stairs)
+
+        deleteEdge(base.u, base.v);
+        for (int i = 0; i + 1 < chain.size(); ++i)
         {
-            cost = cost * 100.0;
+            Edge piece = base;
+            piece.id = -1;
+            piece.u = chain[i];
+            piece.v = chain[i + 1];
+            piece.distance = lengthBetween(piece.u, piece.v);
+            addOrUpdateEdge(piece);
         }
-        
-        return cost;
     }
-    
-    return edge.distance;
+
+    GraphDiff diff = commit();
+    qDebug() << "拓扑清理完毕: 合并节点" << plan.merges.size()
+             << " 新路口" << plan.junctions.size() << " 切开道路" << plan.splits.size();
+    return diff;
 }
 
 // ============================================================
-// Dijkstra 最短路径算法 - 核心寻路函数
-// 
-// 这是计算机科学中的经典算法，用于找两点之间的最短路径
-// 返回：从起点到终点的节点ID列表
+//             热重载
 // ============================================================
-QVector<int> GraphModel::findPath(
-    int startId,
-    int endId,
-    TransportMode mode,
-    Weather weather,
-    WeightMode weightMode)
+
+void GraphModel::setDiskBaseline(const NodeTable& nodes, const QVector<Edge>& edges)
+{
+    m_diskBaseline.nodes = nodes;
+    m_diskBaseline.edges = edges;
+    m_diskBaseline.generation++;
+}
+
+bool GraphModel::enableHotReload()
 {
-    // ---- 第1步：检查起点和终点是否存在 ----
-    if (!nodesMap.contains(startId) || !nodesMap.contains(endId))
+    if (isRegionMode() || m_nodesPath.isEmpty() || m_edgesPath.isEmpty())
     {
-        return {};  // 返回空路径
+        qDebug() << "热重载: 分区模式或未加载地图，不启用";
+        return false;
     }
 
-    // ---- 第2步：初始化距离表和父节点表 ----
-    QMap<int, double> dist;  // 存储每个节点到起点的最短距离
-    QMap<int, int> parent;   // 存储每个节点的前驱节点（用于回溯路径）
-    
-    // 所有节点初始距离设为无穷大
-    for (int id : nodesMap.keys())
+    if (!m_reloader)
     {
-        dist[id] = std::numeric_limits<double>::max();
+        m_reloader = new DataReloader();
+        m_reloader->setBaselineProvider([this]() { return m_diskBaseline; });
+        m_reloader->setDiffApplier([this](const ReloadDiff& diff) { return applyReload(diff); });
     }
-    
-    // ---- 第3步：初始化优先队列 ----
-    // 优先队列会自动按距离从小到大排序
-    std::priority_queue<
-        std::pair<double, int>,
-        std::vector<std::pair<double, int>>,
-        std::greater<>
-    > pq;
-    
-    dist[startId] = 0;
-    pq.push({0, startId});
+    m_reloader->watch(m_nodesPath, m_edgesPath, m_schedulePath);
+    return true;
+}
 
-    // ---- 第4步：Dijkstra 主循环 ----
-    while (!pq.empty())
+// ============================================================
+// 读取变化了的文件并与基准比较（后台线程）
+// 按格式化后的文本比较：内存里的坐标、长度精度比文件高，
+// 直接比较数值会把自己刚保存的文件也当成修改
+// ============================================================
+ReloadDiff GraphModel::computeReloadDiff(const ReloadBaseline& base, const ReloadSources& sources)
+{
+    ReloadDiff diff;
+    diff.baseGeneration = base.generation;
+    diff.newBaseline = base;
+
+    // ---- 节点：按 ID 比较 ----
+    QFile nodeFile(sources.nodesPath);
+    if (!sources.nodesPath.isEmpty() && nodeFile.open(QIODevice::ReadOnly | QIODevice::Text))
     {
-        // 取出当前距离最小的节点
-        double d = pq.top().first;
-        int u = pq.top().second;
-        pq.pop();
-        
-        // 如果这个距离已经过时，跳过
-        if (d > dist[u])
+        NodeTable fresh;
+        QTextStream in(&nodeFile);
+        in.setEncoding(QStringConverter::Utf8);
+        while (!in.atEnd())
         {
-            continue;
+            Node node;
+            if (parseNodeFields(in.readLine().trimmed(), node))
+            {
+                fresh.insert(node);
+            }
         }
-        
-        // 找到终点，提前结束
-        if (u == endId)
+
+        for (const Node& n : fresh)
         {
-            break;
+            const Node* old = base.nodes.find(n.id);
+            if (!old || formatNodeLine(*old) != formatNodeLine(n))
+            {
+                diff.upsertNodes.append(n);
+            }
         }
-        
-        // 如果这个节点没有邻居，跳过
-        if (!adj.contains(u))
+        for (const Node& n : base.nodes)
         {
-            continue;
+            if (!fresh.contains(n.id))
+            {
+                diff.removedNodes.append(n.id);
+            }
         }
+        diff.newBaseline.nodes = fresh;
+    }
 
-        // 遍历所有相邻的边
-        for (const Edge& e : adj[u])
+    // ---- 道路：文件里没有道路 ID，按端点对（不分方向）比较 ----
+    QFile edgeFile(sources.edgesPath);
+    if (!sources.edgesPath.isEmpty() && edgeFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QHash<quint64, Edge> before;
+        for (const Edge& e : base.edges)
         {
-            // 计算这条边的权重
-            double weight = getEdgeWeight(e, weightMode, mode, weather);
-            
-            // 如果这条路不通（权重为无穷大），跳过
-            if (weight >= std::numeric_limits<double>::max())
+            if (e.id >= 0)
             {
+                before.insert(edgePairKey(e.u, e.v), e);
+            }
+        }
+
+        QVector<Edge> fresh;
+        QSet<quint64> seen;
+        QTextStream in(&edgeFile);
+        in.setEncoding(QStringConverter::Utf8);
+        while (!in.atEnd())
+        {
+            Edge edge;
+            if (!parseEdgeFields(in.readLine().trimmed(), edge))
+            {
+                continue;
+            }
+            quint64 key = edgePairKey(edge.u, edge.v);
+            if (seen.contains(key))
+            {
+                continue;  // 与加载时一样，重复的端点对只取第一条
+            }
+            edge.id = 0;
+            seen.insert(key);
+            fresh.append(edge);
+
+            auto old = before.constFind(key);
+            if (old == before.cend())
+            {
+                diff.upsertEdges.append(edge);
                 continue;
             }
-            
-            // 松弛操作：如果经过u到v的距离更短，就更新
-            double newDist = dist[u] + weight;
-            if (newDist < dist[e.v])
+
+            // 方向相反时换到基准的方向再比较（坡度随方向取反）
+            Edge aligned = edge;
+            if (aligned.u != old.value().u)
+            {
+                std::swap(aligned.u, aligned.v);
+                aligned.slope = (aligned.slope == 0.0) ? 0.0 : -aligned.slope;
+            }
+            if (formatEdgeLine(old.value()) != formatEdgeLine(aligned))
+            {
+                diff.upsertEdges.append(edge);
+            }
+        }
+
+        for (auto it = before.cbegin(); it != before.cend(); ++it)
+        {
+            if (!seen.contains(it.key()))
             {
-                dist[e.v] = newDist;
-                parent[e.v] = u;
-                pq.push({dist[e.v], e.v});
+                diff.removedEdges.append(qMakePair(it.value().u, it.value().v));
             }
         }
+        diff.newBaseline.edges = fresh;
     }
 
-    // ---- 第5步：回溯路径 ----
-    QVector<int> path;
-    
-    // 如果终点不可达，返回空路径
-    if (dist[endId] == std::numeric_limits<double>::max())
+    // ---- 时刻表：按车站比较 ----
+    QFile scheduleFile(sources.schedulePath);
+    if (!sources.schedulePath.isEmpty() && scheduleFile.open(QIODevice::ReadOnly | QIODevice::Text))
     {
-        return path;
+        QMap<int, QVector<QTime>> fresh;
+        QTextStream in(&scheduleFile);
+        while (!in.atEnd())
+        {
+            int stationId;
+            QVector<QTime> times;
+            if (parseScheduleFields(in.readLine().trimmed(), stationId, times))
+            {
+                fresh.insert(stationId, times);
+            }
+        }
+
+        for (auto it = fresh.cbegin(); it != fresh.cend(); ++it)
+        {
+            auto old = base.schedules.constFind(it.key());
+            if (old == base.schedules.cend() || old.value() != it.value())
+            {
+                diff.upsertSchedules.insert(it.key(), it.value());
+            }
+        }
+        for (auto it = base.schedules.cbegin(); it != base.schedules.cend(); ++it)
+        {
+            if (!fresh.contains(it.key()))
+            {
+                diff.removedStations.append(it.key());
+            }
+        }
+        diff.newBaseline.schedules = fresh;
     }
-    
-    // 从终点往回走，构建路径
-    int curr = endId;
-    while (curr != startId)
+
+    return diff;
+}
+
+// ============================================================
+// 应用外部修改
+// 先节点后道路（新道路的端点要先存在），删除节点放在最后（连带删除其道路）；
+// 走普通编辑接口，邻接表、连通性、快照和场景都只按变化增量更新
+// ============================================================
+bool GraphModel::applyReload(const ReloadDiff& diff)
+{
+    if (diff.baseGeneration != m_diskBaseline.generation)
     {
-        path.append(curr);
-        curr = parent[curr];
+        return false;
     }
-    path.append(startId);
-    
-    // 反转路径（因为我们是从终点往起点走的）
-    std::reverse(path.begin(), path.end());
-    
-    return path;
+
+    beginBatch("重新加载数据");
+
+    // ---- 第1步：新增或修改节点 ----
+    for (const Node& n : diff.upsertNodes)
+    {
+        if (nodeTable.contains(n.id))
+        {
+            updateNode(n);
+            continue;
+        }
+        Node stored = n;
+        internStrings(stored);
+        insertNode(stored);
+        m_pendingDiff.nodeAdded(stored.id);
+        m_history.recordNodeAdded(stored);
+        journalNode(stored);
+    }
+
+    // ---- 第2步：道路 ----
+    QSet<int> doomed(diff.removedNodes.cbegin(), diff.removedNodes.cend());
+    for (const QPair<int, int>& pair : diff.removedEdges)
+    {
+        deleteEdge(pair.first, pair.second);
+    }
+    for (const Edge& e : diff.upsertEdges)
+    {
+        // 文件不一致（端点不存在或即将删除）的道路跳过
+        if (!nodeTable.contains(e.u) || !nodeTable.contains(e.v) || doomed.contains(e.u) || doomed.contains(e.v))
+        {
+            continue;
+        }
+        Edge stored = e;
+        stored.id = -1;     // 已有同端点道路时保留原 ID
+        addOrUpdateEdge(stored);
+    }
+
+    // ---- 第3步：删除节点 ----
+    for (int id : diff.removedNodes)
+    {
+        deleteNode(id);
+    }
+
+    // ---- 第4步：时刻表（不进撤销历史，快照版本号递增即可让寻路看到新时刻）----
+    for (auto it = diff.upsertSchedules.cbegin(); it != diff.upsertSchedules.cend(); ++it)
+    {
+        stationSchedules.insert(it.key(), it.value());
+    }
+    for (int stationId : diff.removedStations)
+    {
+        stationSchedules.remove(stationId);
+    }
+    if (!diff.upsertSchedules.isEmpty() || !diff.removedStations.isEmpty())
+    {
+        m_graphVersion++;
+        requestPrecompute();  // 只改时刻表时不会有 graphChanged
+    }
+
+    calibrateIdCounters();
+
+    quint64 generation = m_diskBaseline.generation + 1;
+    m_diskBaseline = diff.newBaseline;
+    m_diskBaseline.generation = generation;
+
+    commit();
+    qDebug() << "热重载完毕: 节点" << diff.upsertNodes.size() << "/" << diff.removedNodes.size()
+             << " 道路" << diff.upsertEdges.size() << "/" << diff.removedEdges.size()
+             << " 车站" << diff.upsertSchedules.size() << "/" << diff.removedStations.size();
+    return true;
 }
 
 // ============================================================
-// 校车相关逻辑
+// 撤销操作
+// 逆序反向应用最近一个事务的增量，只触及变化的节点和道路
 // ============================================================
+void GraphModel::undo()
+{
+    if (!m_history.canUndo())
+    {
+        return;
+    }
+
+    // 回放不入历史（takeUndo 之后的批次是空事务），但照常汇总变化、合并保存
+    QString label;
+    const QVector<EditDelta> deltas = m_history.takeUndo(&label);
+    beginBatch(label);
+    for (int i = deltas.size() - 1; i >= 0; --i)
+    {
+        applyDelta(deltas[i], false);
+    }
+    commit();
+}
 
 // ============================================================
-// 获取下一班车时间
-// 根据当前时刻和天气，返回最近的一班车发车时间
+// 重做操作
+// 顺序正向应用最近撤销的事务
 // ============================================================
-QTime GraphModel::getNextBusTime(int stationId, QTime arrivalTime, Weather weather) const
+void GraphModel::redo()
 {
-    // 检查这个站点是否有时刻表
-    if (!stationSchedules.contains(stationId))
+    if (!m_history.canRedo())
     {
-        return QTime();  // 返回无效时间
+        return;
     }
-    
-    // 计算天气导致的延误时间
-    int delayMinutes = 0;
-    if (weather == Weather::Rainy)
+
+    QString label;
+    const QVector<EditDelta> deltas = m_history.takeRedo(&label);
+    beginBatch(label);
+    for (const EditDelta& d : deltas)
+    {
+        applyDelta(d, true);
+    }
+    commit();
+}
+
+bool GraphModel::canUndo() const
+{
+    return m_history.canUndo();
+}
+
+bool GraphModel::canRedo() const
+{
+    return m_history.canRedo();
+}
+
+void GraphModel::beginUndoGroup(const QString& label)
+{
+    m_history.begin(label);
+}
+
+void GraphModel::endUndoGroup()
+{
+    m_history.end();
+}
+
+// ============================================================
+// 开始一批编辑
+// 同时打开一个撤销事务，批内所有编辑合并为历史中的一项
+// ============================================================
+void GraphModel::beginBatch(const QString& label)
+{
+    m_history.begin(label);
+    m_batchDepth++;
+}
+
+// ============================================================
+// 提交批次
+// 最外层提交时：关闭撤销事务、请求一次保存、发出一次变化通知
+// ============================================================
+GraphDiff GraphModel::commit()
+{
+    if (m_batchDepth == 0)
     {
-        delayMinutes = 5;   // 下雨延误5分钟
+        qWarning() << "GraphModel::commit 没有对应的 beginBatch";
+        return GraphDiff();
     }
-    if (weather == Weather::Snowy)
+
+    m_history.end();
+    m_batchDepth--;
+    if (m_batchDepth > 0)
     {
-        delayMinutes = 15;  // 下雪延误15分钟
+        return GraphDiff();
     }
 
-    // 遍历时刻表，找第一班晚于到达时间的车
-    const QVector<QTime>& rawTimes = stationSchedules[stationId];
-    for (const QTime& rawT : rawTimes)
+    GraphDiff diff = m_pendingDiff;
+    m_pendingDiff.clear();
+
+    if (m_batchSaveRequested)
     {
-        // 加上延误时间得到实际发车时间
-        QTime effectiveT = rawT.addSecs(delayMinutes * 60);
-        
-        // 如果这班车在我们到达之后发车，就坐这班
-        if (effectiveT >= arrivalTime)
+        m_batchSaveRequested = false;
+        scheduleSnapshotSave();
+    }
+
+    if (!diff.isEmpty())
+    {
+        // 兜底：经 getNodePtr 等途径直接改动的数据也要让旧快照失效
+        m_graphVersion++;
+        emit m_notifier->graphChanged(diff);
+    }
+    return diff;
+}
+
+// ============================================================
+// 应用一条增量（不入历史）
+// forward=true 为重做方向，false 为撤销方向
+// ============================================================
+void GraphModel::applyDelta(const EditDelta& d, bool forward)
+{
+    // 增删类增量：撤销时方向相反
+    bool addingNode = (d.kind == EditDelta::AddNode) == forward;
+    bool addingEdge = (d.kind == EditDelta::AddEdge) == forward;
+
+    switch (d.kind)
+    {
+    case EditDelta::AddNode:
+    case EditDelta::RemoveNode:
+    {
+        const Node& n = (d.kind == EditDelta::AddNode) ? d.after : d.before;
+        if (addingNode)
+        {
+            insertNode(n);
+            m_pendingDiff.nodeAdded(n.id);
+            journalNode(n);
+        }
+        else
+        {
+            // 相连的边已由同一事务中更早（撤销时更晚）的增量处理
+            removeNodeAndEdges(n.id);
+            m_pendingDiff.nodeRemoved(n.id);
+            journalNodeRemoved(n.id);
+        }
+        break;
+    }
+
+    case EditDelta::ChangeNode:
+    {
+        Node* stored = nodeTable.find(d.after.id);
+        if (stored)
         {
-            return effectiveT;
+            EditDelta::copyNodeFields(*stored, forward ? d.after : d.before, d.mask);
+            m_graphVersion++;
+            m_pendingDiff.nodeModified(stored->id);
+            journalNode(*stored);
         }
+        break;
+    }
+
+    case EditDelta::AddEdge:
+    case EditDelta::RemoveEdge:
+    {
+        Edge e = (d.kind == EditDelta::AddEdge) ? d.edgeAfter : d.edgeBefore;
+        if (addingEdge)
+        {
+            storeEdge(e);  // 沿用原来的道路 ID
+            adjInsertEdge(e);
+            m_pendingDiff.edgeAdded(e.id);
+            journalEdge(e);
+        }
+        else
+        {
+            int removedId = edgeIdBetween(e.u, e.v);
+            if (removeEdgeBetween(e.u, e.v))
+            {
+                m_pendingDiff.edgeRemoved(removedId);
+                journalEdgeRemoved(e.u, e.v);
+            }
+        }
+        break;
+    }
+
+    case EditDelta::ChangeEdge:
+    {
+        const Edge* current = edgeById(d.edgeAfter.id);
+        if (current)
+        {
+            Edge e = *current;
+            EditDelta::copyEdgeFields(e, forward ? d.edgeAfter : d.edgeBefore, d.mask);
+            adjRemoveEdge(e.u, e.v);
+            storeEdge(e);
+            adjInsertEdge(e);
+            m_pendingDiff.edgeModified(e.id);
+            journalEdge(e);
+        }
+        break;
+    }
     }
-    
-    return QTime();  // 没有合适的班次
 }
 
 // ============================================================
-// 计算最佳校车路线
-// 会尝试所有可能的上车站和下车站组合，找最快的
+//                    编辑日志
 // ============================================================
-GraphModel::BusRouteResult GraphModel::calculateBestBusRoute(
-    int startId,
-    int endId,
-    QTime currentTime,
-    Weather weather)
+
+// ============================================================
+// 打开日志并回放
+// 日志放在节点文件同目录下，启动时按 "快照 + 封存段 + 活动段" 的顺序恢复
+// ============================================================
+void GraphModel::openJournal()
 {
-    BusRouteResult bestResult;
-    bestResult.valid = false;
-    bestResult.totalDuration = std::numeric_limits<double>::max();
+    m_saveScheduler->waitForIdle();
+    m_saveScheduler->cancelPending();
 
-    // 找出所有公交站
-    QVector<int> stations;
-    for (auto it = nodesMap.begin(); it != nodesMap.end(); ++it)
+    QString journalPath = QFileInfo(m_nodesPath).absoluteDir().filePath("edits.journal");
+
+    // 先回放封存段（上次压缩没完成时才会残留），再回放活动段
+    int replayed = 0;
+    const QStringList paths = { journalPath + ".sealed", journalPath };
+    for (const QString& path : paths)
     {
-        if (it.value().category == NodeCategory::BusStation)
+        const QStringList records = EditJournal::readRecords(path);
+        for (const QString& record : records)
         {
-            stations.append(it.key());
+            applyJournalRecord(record);
         }
+        replayed += records.size();
     }
-    
-    if (stations.isEmpty())
+
+    if (replayed > 0)
     {
-        return bestResult;
+        qDebug() << "编辑日志回放完毕: 记录数=" << replayed;
     }
 
-    // 遍历所有上车站
-    for (int startStation : stations)
+    m_journal.open(journalPath);
+}
+
+// ============================================================
+// 应用一条日志记录
+// 格式:
+//   N,<节点行>   新增/修改节点
+//   n,<id>       删除节点（连带相连的边）
+//   E,<道路行>   新增/修改道路
+//   e,<u>,<v>    删除道路
+// ============================================================
+void GraphModel::applyJournalRecord(const QString& record)
+{
+    if (record.size() < 2 || record[1] != ',')
+    {
+        return;
+    }
+
+    QChar op = record[0];
+    QString body = record.mid(2);
+
+    if (op == 'N')
     {
-        // 第1段：步行到上车站
-        QVector<int> walk1Path = findPath(startId, startStation, TransportMode::Walk, weather);
-        if (walk1Path.isEmpty())
+        Node node;
+        if (parseNodeFields(body, node))
         {
-            continue;
+            internStrings(node);
+            insertNode(node);
         }
-        
-        double walk1Time = calculateDuration(walk1Path, TransportMode::Walk, weather);
-        QTime arrivalAtStation = currentTime.addSecs((int)walk1Time);
-        
-        // 查询下一班车
-        QTime busTime = getNextBusTime(startStation, arrivalAtStation, weather);
-        if (!busTime.isValid())
+    }
+    else if (op == 'n')
+    {
+        removeNodeAndEdges(body.toInt());
+    }
+    else if (op == 'E')
+    {
+        Edge edge;
+        if (parseEdgeFields(body, edge))
         {
-            continue;
+            removeEdgeBetween(edge.u, edge.v);
+            storeEdge(edge);
+            adjInsertEdge(edge);
+        }
+    }
+    else if (op == 'e')
+    {
+        QStringList parts = body.split(",");
+        if (parts.size() >= 2)
+        {
+            removeEdgeBetween(parts[0].toInt(), parts[1].toInt());
+        }
+    }
+}
+
+void GraphModel::removeNodeAndEdges(int id, QVector<Edge>* removedEdges)
+{
+    // 通过邻接表只访问相连的边：O(度数)
+    const QVector<int> neighbors = adjNeighborIds(id);
+    for (int other : neighbors)
+    {
+        Edge removed;
+        if (unstoreEdge(id, other, &removed) && removedEdges)
+        {
+            removedEdges->append(removed);
+        }
+    }
+    adjRemoveNode(id);      // 先按下标清理邻接表，再让出下标
+    nodeTable.remove(id);
+}
+
+bool GraphModel::removeEdgeBetween(int u, int v)
+{
+    if (!unstoreEdge(u, v))
+    {
+        return false;
+    }
+    adjRemoveEdge(u, v);
+    return true;
+}
+
+// ============================================================
+//                    道路存储（稳定 ID + 墓碑）
+// edgesList 中的位置不等于 ID：删除只打墓碑（id = -1），
+// 墓碑积累到一定比例再整体压缩，压缩时只更新 ID -> 位置 的映射
+// ============================================================
+
+quint64 GraphModel::edgePairKey(int u, int v)
+{
+    quint32 a = static_cast<quint32>(std::min(u, v));
+    quint32 b = static_cast<quint32>(std::max(u, v));
+    return (static_cast<quint64>(a) << 32) | b;
+}
+
+int GraphModel::storeEdge(Edge& edge)
+{
+    internStrings(edge);
+
+    // 同一对端点已有道路：原位覆盖，ID 不变
+    auto existing = m_edgePairIndex.constFind(edgePairKey(edge.u, edge.v));
+    if (existing != m_edgePairIndex.constEnd())
+    {
+        edge.id = existing.value();
+        edgesList[m_edgeSlot.value(edge.id)] = edge;
+        return edge.id;
+    }
+
+    // 撤销删除时沿用原 ID（只要它没被占用）
+    if (edge.id < 0 || m_edgeSlot.contains(edge.id))
+    {
+        edge.id = m_nextEdgeId++;
+    }
+    else if (edge.id >= m_nextEdgeId)
+    {
+        m_nextEdgeId = edge.id + 1;
+    }
+
+    m_edgeSlot.insert(edge.id, edgesList.size());
+    m_edgePairIndex.insert(edgePairKey(edge.u, edge.v), edge.id);
+    edgesList.append(edge);
+    return edge.id;
+}
+
+bool GraphModel::unstoreEdge(int u, int v, Edge* removed)
+{
+    auto it = m_edgePairIndex.find(edgePairKey(u, v));
+    if (it == m_edgePairIndex.end())
+    {
+        return false;
+    }
+
+    int id = it.value();
+    int slot = m_edgeSlot.value(id);
+    if (removed)
+    {
+        *removed = edgesList[slot];
+    }
+
+    m_edgePairIndex.erase(it);
+    m_edgeSlot.remove(id);
+    edgesList[slot].id = -1;
+    edgesList[slot].name.clear();
+    edgesList[slot].description.clear();
+    m_edgeTombstones++;
+
+    // 墓碑超过四分之一时压缩，均摊 O(1)
+    if (m_edgeTombstones > kEdgeCompactMin && m_edgeTombstones * 4 > edgesList.size())
+    {
+        compactEdges();
+    }
+    return true;
+}
+
+void GraphModel::compactEdges()
+{
+    QVector<Edge> live;
+    live.reserve(edgesList.size() - m_edgeTombstones);
+    m_edgeSlot.clear();
+    for (const Edge& e : std::as_const(edgesList))
+    {
+        if (e.id >= 0)
+        {
+            m_edgeSlot.insert(e.id, live.size());
+            live.append(e);
         }
+    }
+    edgesList = live;
+    m_edgeTombstones = 0;
+}
+
+void GraphModel::internStrings(Node& n)
+{
+    n.name = m_strings.intern(n.name);
+    n.description = m_strings.intern(n.description);
+}
 
-        double waitTime = arrivalAtStation.secsTo(busTime);
+void GraphModel::internStrings(Edge& e)
+{
+    e.name = m_strings.intern(e.name);
+    e.description = m_strings.intern(e.description);
+}
+
+void GraphModel::clearEdges()
+{
+    edgesList.clear();
+    m_edgeSlot.clear();
+    m_edgePairIndex.clear();
+    m_edgeTombstones = 0;
+    m_nextEdgeId = 0;
+    m_access.forgetEdgeIds();   // ID 从 0 重新分配，旧的按 ID 封闭不再对应原来的道路
+}
 
-        // 遍历所有下车站
-        for (int endStation : stations)
+int GraphModel::edgeIdBetween(int u, int v) const
+{
+    return m_edgePairIndex.value(edgePairKey(u, v), -1);
+}
+
+const Edge* GraphModel::edgeById(int id) const
+{
+    auto it = m_edgeSlot.constFind(id);
+    if (it == m_edgeSlot.constEnd())
+    {
+        return nullptr;
+    }
+    return &edgesList[it.value()];
+}
+
+void GraphModel::journalNode(const Node& n)
+{
+    m_graphVersion++;
+    m_journal.append("N," + formatNodeLine(n));
+    scheduleSnapshotSave();
+}
+
+void GraphModel::journalNodeRemoved(int id)
+{
+    m_graphVersion++;
+    m_journal.append(QString("n,%1").arg(id));
+    scheduleSnapshotSave();
+}
+
+void GraphModel::journalEdge(const Edge& e)
+{
+    m_journal.append("E," + formatEdgeLine(e));
+    scheduleSnapshotSave();
+}
+
+void GraphModel::journalEdgeRemoved(int u, int v)
+{
+    m_journal.append(QString("e,%1,%2").arg(u).arg(v));
+    scheduleSnapshotSave();
+}
+
+// ============================================================
+// 请求后台保存
+// 连续编辑在防抖窗口内合并；日志太长则立即写
+// ============================================================
+void GraphModel::scheduleSnapshotSave()
+{
+    if (m_nodesPath.isEmpty() || m_edgesPath.isEmpty())
+    {
+        return;
+    }
+
+    // 批次中只做标记，提交时再请求
+    if (m_batchDepth > 0)
+    {
+        m_batchSaveRequested = true;
+        return;
+    }
+
+    if (m_journal.recordCount() >= kJournalCompactThreshold)
+    {
+        m_saveScheduler->requestSaveNow();
+    }
+    else
+    {
+        m_saveScheduler->requestSave();
+    }
+}
+
+// ============================================================
+// 准备后台保存的快照
+// 节点表与 QVector 都是隐式共享的，拷贝给后台线程只是增加引用计数；
+// 界面线程之后的修改会自动分离，不影响正在写盘的那份数据
+// ============================================================
+SaveSnapshot GraphModel::takeSaveSnapshot()
+{
+    // 封存当前日志：之后的编辑写入新的活动段
+    m_journal.sync();
+    bool sealed = m_journal.seal();
+
+    SaveSnapshot snapshot;
+    snapshot.nodes = nodeTable;
+    snapshot.edges = edgesList;
+    m_savingNodes = nodeTable;
+    m_savingEdges = edgesList;
+    snapshot.nodesPath = m_nodesPath;
+    snapshot.edgesPath = m_edgesPath;
+    if (sealed)
+    {
+        snapshot.sealedJournalPath = m_journal.sealedPath();
+    }
+    return snapshot;
+}
+
+// ============================================================
+//             只读快照与寻路
+// ============================================================
+
+// ============================================================
+// 获取当前版本的只读快照
+// 容器都是隐式共享的，生成快照只增加引用计数；
+// 版本没变且上一个快照还有人持有时直接复用
+// ============================================================
+GraphSnapshotPtr GraphModel::snapshot()
+{
+    ClosureMaskPtr closures = m_access.resolve(edgesList, m_graphVersion);
+    GraphSnapshotPtr cached = m_snapshotCache.lock();
+    if (cached && cached->version() == m_graphVersion)
+    {
+        if (cached->m_closures == closures)
         {
-            if (startStation == endStation)
-            {
-                continue;
-            }
-            
-            // 第2段：坐校车
-            QVector<int> ridePath = findPath(startStation, endStation, TransportMode::Bus, weather);
-            if (ridePath.isEmpty())
-            {
-                continue;
-            }
-            
-            double rideTime = calculateDuration(ridePath, TransportMode::Bus, weather);
-            
-            // 第3段：从下车站步行到终点
-            QVector<int> walk2Path = findPath(endStation, endId, TransportMode::Walk, weather);
-            if (walk2Path.isEmpty())
-            {
-                continue;
-            }
-            
-            double walk2Time = calculateDuration(walk2Path, TransportMode::Walk, weather);
-
-            // 计算总时间
-            double total = walk1Time + waitTime + rideTime + walk2Time;
-            
-            // 如果比当前最优解更好，更新
-            if (total < bestResult.totalDuration)
-            {
-                bestResult.valid = true;
-                bestResult.totalDuration = total;
-                bestResult.stationStartId = startStation;
-                bestResult.stationEndId = endStation;
-                bestResult.nextBusTime = busTime;
-                
-                // 拼接完整路径
-                bestResult.fullPath = walk1Path;
-                if (!ridePath.isEmpty())
-                {
-                    for (int k = 1; k < ridePath.size(); ++k)
-                    {
-                        bestResult.fullPath.append(ridePath[k]);
-                    }
-                }
-                if (!walk2Path.isEmpty())
-                {
-                    for (int k = 1; k < walk2Path.size(); ++k)
-                    {
-                        bestResult.fullPath.append(walk2Path[k]);
-                    }
-                }
-            }
+            return cached;
         }
+
+        // 只有封闭变了：复制快照同样只增加引用计数，换上新的封闭表
+        std::shared_ptr<GraphSnapshot> snap(new GraphSnapshot(*cached));
+        snap->m_closures = closures;
+        m_snapshotCache = snap;
+        return snap;
     }
-    
-    return bestResult;
+
+    std::shared_ptr<GraphSnapshot> snap(new GraphSnapshot());
+    snap->m_version = m_graphVersion;
+    snap->m_nodes = nodeTable;
+    snap->m_edges = edgesList;
+    snap->m_edgeSlot = m_edgeSlot;
+    snap->m_adj = adj;
+    snap->m_schedules = stationSchedules;
+    snap->m_boundaryNodeRegion = m_boundaryNodeRegion;
+    snap->m_closures = closures;
+    if (m_rideMatrix && m_rideMatrixVersion == m_graphVersion)
+    {
+        snap->m_rideMatrix = m_rideMatrix;
+    }
+
+    // 模型自己只留弱引用：没有读者时编辑不会触发容器分离
+    m_snapshotCache = snap;
+    return snap;
+}
+
+// ============================================================
+// 请求后台准备预计算结果
+// 分区模式下图只加载了一部分，不做预计算
+// ============================================================
+void GraphModel::requestPrecompute()
+{
+    if (isRegionMode() || m_nodesPath.isEmpty())
+    {
+        m_precompute->setCacheDirectory(QString());
+        return;
+    }
+
+    QString dataDir = QFileInfo(m_nodesPath).absolutePath();
+    m_precompute->setCacheDirectory(QDir::cleanPath(dataDir + "/../cache"));
+    m_precompute->requestRebuild();
 }
 
 // ============================================================
-// 判断是否会迟到
+//                    连通性
 // ============================================================
-bool GraphModel::isLate(double durationSeconds, QTime current, QTime target) const
+
+// 一次查询依次经过的点：起点、途经点、终点
+static QVector<int> routeStops(int startId, int endId, const QVector<int>& waypoints)
+{
+    QVector<int> stops;
+    stops.reserve(waypoints.size() + 2);
+    stops.append(startId);
+    stops += waypoints;
+    stops.append(endId);
+    return stops;
+}
+
+// ============================================================
+// 寻路前的快速拒绝
+// 只比较分量标签；不存在的节点交给搜索本身处理
+// ============================================================
+bool GraphModel::canReach(const QVector<int>& stops, TransportMode mode)
+{
+    if (isRegionMode() || stops.isEmpty())
+    {
+        return true;
+    }
+
+    ConnectivityProfile profile = ConnectivityIndex::profileFor(mode);
+    int label = -1;
+    for (int id : stops)
+    {
+        if (!nodeTable.contains(id))
+        {
+            return true;
+        }
+        int component = m_connectivity.componentOf(profile, id, adj);
+        if (label != -1 && component != label)
+        {
+            return false;
+        }
+        label = component;
+    }
+    return true;
+}
+
+int GraphModel::componentOf(int nodeId, ConnectivityProfile profile)
+{
+    return m_connectivity.componentOf(profile, nodeId, adj);
+}
+
+QSet<int> GraphModel::islandNodes(ConnectivityProfile profile)
+{
+    return m_connectivity.islandNodes(profile, nodeTable.keys(), adj);
+}
+
+QVector<int> GraphModel::bridgeEdges(ConnectivityProfile profile) const
+{
+    return ConnectivityIndex::findBridges(profile, adj);
+}
+
+// ============================================================
+// 加载寻路时碰到的分区
+// 返回：新加载的分区数量（有新分区时已重建邻接表）
+// ============================================================
+int GraphModel::loadWantedRegions(const QSet<int>& wanted)
 {
-    QTime arrival = current.addSecs((int)durationSeconds);
-    return arrival > target;
+    int newlyLoaded = 0;
+    for (int index : wanted)
+    {
+        if (loadRegion(index))
+        {
+            newlyLoaded++;
+        }
+    }
+    if (newlyLoaded > 0)
+    {
+        buildAdjacencyList();
+        calibrateIdCounters();
+    }
+    return newlyLoaded;
 }
 
 // ============================================================
-// 多段路径拼接（支持途经点）
+// 寻找路径
+// 整图模式直接在快照上搜索；
+// 分区模式：搜索 -> 加载搜索中碰到的分区 -> 重试，直到不再需要新的分区
 // ============================================================
-QVector<int> GraphModel::findMultiStagePath(
+QVector<int> GraphModel::findPath(
     int startId,
     int endId,
-    const QVector<int>& waypoints,
     TransportMode mode,
     Weather weather,
     WeightMode weightMode)
 {
-    QVector<int> fullPath;
-    int currentStart = startId;
-    
-    // 构建目标点列表：途经点 + 终点
-    QVector<int> targets = waypoints;
-    targets.append(endId);
+    if (!canReach({startId, endId}, mode))
+    {
+        return QVector<int>();
+    }
 
-    // 逐段规划路径
-    for (int target : targets)
+    if (!isRegionMode())
     {
-        QVector<int> segment = findPath(currentStart, target, mode, weather, weightMode);
-        
-        // 如果某一段不可达，整个路径失败
-        if (segment.isEmpty())
-        {
-            return {};
-        }
-        
-        // 避免重复节点：如果不是第一段，去掉起点
-        if (!fullPath.isEmpty())
+        return snapshot()->findPath(startId, endId, mode, weather, weightMode);
+    }
+
+    while (true)
+    {
+        QSet<int> wanted;
+        QVector<int> path = snapshot()->findPath(startId, endId, mode, weather, weightMode, &wanted);
+        if (loadWantedRegions(wanted) == 0)
         {
-            segment.removeFirst();
+            return path;
         }
-        
-        fullPath.append(segment);
-        currentStart = target;
     }
-    
-    return fullPath;
 }
 
 // ============================================================
-// 多策略路径推荐 - 核心函数
-// 为用户提供3种不同策略的路线选择
+// 多策略路径推荐（同步）
 // ============================================================
 QVector<PathRecommendation> GraphModel::getMultiStrategyRoutes(
     int startId,
@@ -1100,183 +2492,148 @@ QVector<PathRecommendation> GraphModel::getMultiStrategyRoutes(
     QTime classTime,
     bool enableLateCheck)
 {
-    QVector<PathRecommendation> results;
+    if (!canReach(routeStops(startId, endId, waypoints), mode))
+    {
+        return QVector<PathRecommendation>();
+    }
 
-    // ---- 校车模式：特殊处理 ----
-    if (mode == TransportMode::Bus)
+    if (!isRegionMode())
     {
-        BusRouteResult busRes = calculateBestBusRoute(startId, endId, currentTime, weather);
-        
-        if (busRes.valid)
-        {
-            bool late = enableLateCheck && isLate(busRes.totalDuration, currentTime, classTime);
-            double dist = calculateDistance(busRes.fullPath);
-            
-            results.append(PathRecommendation(
-                RouteType::FASTEST,
-                "校车通勤",
-                QString("班次 %1").arg(busRes.nextBusTime.toString("HH:mm")),
-                busRes.fullPath,
-                dist,
-                busRes.totalDuration,
-                0,
-                late
-            ));
-        }
-        
-        return results;
+        return snapshot()->getMultiStrategyRoutes(startId, endId, waypoints, mode, weather,
+                                                  currentTime, classTime, enableLateCheck);
     }
 
-    // ---- 策略A：极限冲刺（最快到达）----
+    // 分区模式：先把查询走廊内的分区加载进来，走廊外碰到的分区按需加载后重试
+    ensureQueryCorridorLoaded(startId, endId, waypoints);
+    while (true)
     {
-        QVector<int> path = findMultiStagePath(startId, endId, waypoints, mode, weather, WeightMode::TIME);
-        
-        if (!path.isEmpty())
-        {
-            double dist = calculateDistance(path);
-            double dur = calculateDuration(path, mode, weather);
-            bool late = enableLateCheck && isLate(dur, currentTime, classTime);
-            
-            results.append(PathRecommendation(
-                RouteType::FASTEST,
-                "极限冲刺",
-                "最快到达",
-                path,
-                dist,
-                dur,
-                0,
-                late
-            ));
-        }
-    }
-
-    // ---- 策略B：懒人养生（避开楼梯和坡道）----
-    if (mode != TransportMode::Run) {
-        QVector<int> path = findMultiStagePath(startId, endId, waypoints, mode, weather, WeightMode::COST);
-        // 简单去重：如果路径和“极限冲刺”不一样才加
-        if (!path.isEmpty() && (results.isEmpty() || path != results.last().pathNodeIds)) {
-            double dist = calculateDistance(path);
-            double dur = calculateDuration(path, mode, weather);
-            bool late = enableLateCheck && isLate(dur, currentTime, classTime);
-            results.append(PathRecommendation(RouteType::EASIEST, "懒人养生", "平坦舒适", path, dist, dur, 0, late));
-        }
-    }
-
-    // 策略C: 经济适用 (Distance) - 仅步行
-    if (mode == TransportMode::Walk) {
-        QVector<int> path = findMultiStagePath(startId, endId, waypoints, mode, weather, WeightMode::DISTANCE);
-        // 去重
-        bool isUnique = true;
-        for(const auto& r : results) if(r.pathNodeIds == path) isUnique = false;
-        
-        if (!path.isEmpty() && isUnique) {
-            double dist = calculateDistance(path);
-            double dur = calculateDuration(path, mode, weather);
-            bool late = enableLateCheck && isLate(dur, currentTime, classTime);
-            results.append(PathRecommendation(RouteType::SHORTEST, "经济适用", "路程最短", path, dist, dur, 0, late));
+        QSet<int> wanted;
+        QVector<PathRecommendation> routes = snapshot()->getMultiStrategyRoutes(
+            startId, endId, waypoints, mode, weather, currentTime, classTime, enableLateCheck, &wanted);
+        if (loadWantedRegions(wanted) == 0)
+        {
+            return routes;
         }
     }
-
-    return results;
 }
 
 // ============================================================
-// 计算路径总时长（秒）
-// 遍历路径上的每条边，累加时间权重
+// 多策略路径推荐（后台线程）
+// 搜索在调用时刻的快照上进行，期间的编辑不影响它，也不被它阻塞。
+// 分区模式下走廊外还有分区要加载时，回到界面线程补齐后同步重算（少见）
 // ============================================================
-double GraphModel::calculateDuration(const QVector<int>& pathNodeIds, TransportMode mode, Weather weather) const
+QFuture<QVector<PathRecommendation>> GraphModel::getMultiStrategyRoutesAsync(
+    int startId,
+    int endId,
+    const QVector<int>& waypoints,
+    TransportMode mode,
+    Weather weather,
+    QTime currentTime,
+    QTime classTime,
+    bool enableLateCheck)
 {
-    double total = 0;
-    
-    // 遍历路径上每一条边
-    for (int i = 0; i < pathNodeIds.size() - 1; ++i)
+    // 不连通：不必启动后台搜索，直接给出已完成的空结果
+    if (!canReach(routeStops(startId, endId, waypoints), mode))
     {
-        const Edge* edge = findEdge(pathNodeIds[i], pathNodeIds[i + 1]);
-        
-        if (edge)
+        QPromise<QVector<PathRecommendation>> rejected;
+        rejected.start();
+        rejected.addResult(QVector<PathRecommendation>());
+        rejected.finish();
+        return rejected.future();
+    }
+
+    if (isRegionMode())
+    {
+        ensureQueryCorridorLoaded(startId, endId, waypoints);
+    }
+
+    using RoutesAndRegions = std::pair<QVector<PathRecommendation>, QSet<int>>;
+    GraphSnapshotPtr snap = snapshot();
+
+    QFuture<RoutesAndRegions> search = QtConcurrent::run([=]() {
+        QSet<int> wanted;
+        QVector<PathRecommendation> routes = snap->getMultiStrategyRoutes(
+            startId, endId, waypoints, mode, weather, currentTime, classTime, enableLateCheck, &wanted);
+        return RoutesAndRegions(routes, wanted);
+    });
+
+    // 续体在通知器所在的界面线程执行；模型析构时通知器随之销毁，续体自动取消
+    return search.then(m_notifier, [this, startId, endId, waypoints, mode, weather,
+                                    currentTime, classTime, enableLateCheck](const RoutesAndRegions& result) {
+        if (loadWantedRegions(result.second) == 0)
         {
-            // 使用TIME权重模式计算这条边的通行时间
-            total += getEdgeWeight(*edge, WeightMode::TIME, mode, weather);
+            return result.first;
         }
-    }
-    
-    return total;
+        return getMultiStrategyRoutes(startId, endId, waypoints, mode, weather,
+                                      currentTime, classTime, enableLateCheck);
+    });
 }
 
 // ============================================================
-// 计算路径总距离（米）
-// 遍历路径上的每条边，累加物理距离
+// 查找两个节点之间的边
+// 支持无向边：u->v 和 v->u 都会被找到
 // ============================================================
-double GraphModel::calculateDistance(const QVector<int>& pathNodeIds) const
+const Edge* GraphModel::findEdge(int u, int v) const
 {
-    double total = 0;
-    
-    for (int i = 0; i < pathNodeIds.size() - 1; ++i)
-    {
-        const Edge* edge = findEdge(pathNodeIds[i], pathNodeIds[i + 1]);
-        
-        if (edge)
-        {
-            total += edge->distance;
-        }
-    }
-    
-    return total;
+    return edgeById(edgeIdBetween(u, v));
 }
 
 // ============================================================
-// 计算路径总成本
-// 目前成本等同于距离，未来可扩展（如考虑楼梯数量等）
+// 简单的getter函数
 // ============================================================
-double GraphModel::calculateCost(const QVector<int>& pathNodeIds) const
+Node GraphModel::getNode(int id)
 {
-    return calculateDistance(pathNodeIds);
+    return nodeTable.value(id);
 }
 
 // ============================================================
-// 查找两个节点之间的边
-// 支持无向边：u->v 和 v->u 都会被找到
+// 描述：内存里有（整图模式、编辑过）就用内存里的，否则按需读描述文件
 // ============================================================
-const Edge* GraphModel::findEdge(int u, int v) const
+QString GraphModel::nodeDescription(int id)
 {
-    for (const auto& edge : edgesList)
+    const Node* n = std::as_const(nodeTable).find(id);
+    if (!n)
     {
-        // 检查正向或反向
-        bool match = (edge.u == u && edge.v == v);
-        bool reverseMatch = (edge.u == v && edge.v == u);
-        
-        if (match || reverseMatch)
-        {
-            return &edge;
-        }
+        return QString();
     }
-    
-    return nullptr;  // 未找到
+    return n->description.isEmpty() ? m_descriptions.node(id) : n->description;
 }
 
-// ============================================================
-// 简单的getter函数
-// ============================================================
-Node GraphModel::getNode(int id)
+QString GraphModel::edgeDescription(int id)
 {
-    return nodesMap.value(id);
+    const Edge* e = edgeById(id);
+    if (!e)
+    {
+        return QString();
+    }
+    return e->description.isEmpty() ? m_descriptions.edge(id) : e->description;
 }
 
 Node* GraphModel::getNodePtr(int id)
 {
-    if (nodesMap.contains(id))
-    {
-        return &nodesMap[id];
-    }
-    return nullptr;
+    return nodeTable.find(id);
 }
 
 QVector<Node> GraphModel::getAllNodes() const
 {
-    return nodesMap.values();
+    return nodeTable.values();
 }
 
 QVector<Edge> GraphModel::getAllEdges() const
 {
-    return edgesList;
+    if (m_edgeTombstones == 0)
+    {
+        return edgesList;  // 没有墓碑时直接共享
+    }
+
+    QVector<Edge> live;
+    live.reserve(edgesList.size() - m_edgeTombstones);
+    for (const Edge& e : edgesList)
+    {
+        if (e.id >= 0)
+        {
+            live.append(e);
+        }
+    }
+    return live;
 }
\ No newline at end of file
@@ -2,36 +2,27 @@
 
 #include "../GraphData.h"
 #include "PathRecommendation.h"
+#include "EditJournal.h"
+#include "EditHistory.h"
+#include "SaveScheduler.h"
+#include "DataReloader.h"
+#include "PrecomputeCache.h"
+#include "GraphDiff.h"
+#include "GraphSnapshot.h"
+#include "ConnectivityIndex.h"
+#include "TopologyCleaner.h"
+#include "StringPool.h"
+#include "NodeTable.h"
+#include "DescriptionStore.h"
+#include "EdgeAccess.h"
 #include <QMap>
 #include <QString>
 #include <QVector>
-#include <QStack>
 #include <QTime>
-
-/**
- * @brief 用于撤销操作的动作记录结构体
- * 
- * 记录了操作类型以及相关联的节点或边的数据，
- * 以便在撤销时恢复状态。
- */
-struct HistoryAction
-{
-    /**
-     * @brief 操作类型枚举
-     */
-    enum Type
-    {
-        AddNode,    ///< 添加节点
-        DeleteNode, ///< 删除节点
-        AddEdge,    ///< 添加边
-        DeleteEdge, ///< 删除边
-        MoveNode    ///< 移动节点
-    };
-
-    Type type;      ///< 操作的具体类型
-    Node nodeData;  ///< 涉及的节点数据（如果是节点操作）
-    Edge edgeData;  ///< 涉及的边数据（如果是边操作）
-};
+#include <QRectF>
+#include <QHash>
+#include <QSet>
+#include <QFuture>
 
 /**
  * @brief 图模型类
@@ -49,6 +40,13 @@ public:
      */
     GraphModel();
 
+    /**
+     * @brief 析构函数
+     *
+     * 写完所有待保存的数据，并把编辑日志同步到磁盘。
+     */
+    ~GraphModel();
+
     // =========================================================
     //  加载与保存
     // =========================================================
@@ -85,6 +83,123 @@ public:
      */
     bool saveData(const QString& nodesPath, const QString& edgesPath);
 
+    /**
+     * @brief 节点序列化为一行文本
+     *
+     * 格式: id, name, x, y, z, type, description, category
+     */
+    static QString formatNodeLine(const Node& n);
+
+    /**
+     * @brief 边序列化为一行文本
+     *
+     * 格式: u, v, distance, type, slope, name, description
+     */
+    static QString formatEdgeLine(const Edge& e);
+
+    /**
+     * @brief 把节点文件和边文件完整写入磁盘
+     *
+     * 纯函数，不访问成员，可在后台线程调用。
+     * 使用临时文件 + 原子改名，写一半崩溃也不会损坏旧文件。
+     */
+    static bool writeSnapshot(const NodeTable& nodes, const QVector<Edge>& edges,
+                              const QString& nodesPath, const QString& edgesPath);
+
+    /**
+     * @brief 获取保存调度器
+     *
+     * 可用于调整防抖窗口，或读取保存耗时与排队数量。
+     */
+    SaveScheduler* saveScheduler() const { return m_saveScheduler; }
+
+    /**
+     * @brief 立即写完所有待保存的数据（程序退出时调用）
+     */
+    void flushPendingSaves();
+
+    // =========================================================
+    //  热重载
+    // =========================================================
+
+    /**
+     * @brief 开始监视当前地图的数据文件和时刻表
+     *
+     * 外部程序改写文件后，后台读取并与"磁盘基准"（最近一次加载 / 保存的内容）比较，
+     * 只把差异作为一批编辑应用到模型；尚未保存的本地编辑不受影响。
+     * 分区模式下不可用。
+     *
+     * @return bool 是否开始监视
+     */
+    bool enableHotReload();
+
+    /**
+     * @brief 获取热重载器（未启用时为空）
+     *
+     * 视图可连接 DataReloader::reloaded 显示提示；场景更新走 graphChanged。
+     */
+    DataReloader* dataReloader() const { return m_reloader; }
+
+    /**
+     * @brief 读取变化了的文件并与基准比较
+     *
+     * 纯函数，不访问成员，可在后台线程调用。
+     * 按文件的文本格式比较（与保存时的精度一致），自己保存的文件比较结果为空。
+     * 文件打不开（例如正被替换）时视为没有变化。
+     */
+    static ReloadDiff computeReloadDiff(const ReloadBaseline& base, const ReloadSources& sources);
+
+    /**
+     * @brief 把外部修改作为一批编辑应用（一次撤销、一次通知）
+     *
+     * 只触及变化的节点、道路和车站，耗时与变化量成正比。
+     *
+     * @return bool 基准已过期（计算之后模型保存过）时返回 false，不做任何修改
+     */
+    bool applyReload(const ReloadDiff& diff);
+
+    // =========================================================
+    //  分区加载（多校区 / 城市级地图）
+    // =========================================================
+
+    /**
+     * @brief 按分区索引打开地图
+     *
+     * 只读取索引和跨区道路，不加载任何分区；
+     * 之后由 ensureRegionsLoaded() 按视野或查询范围按需加载。
+     * 分区模式下地图只读，不写编辑日志。
+     *
+     * @param indexPath 分区索引文件路径 (通常为 Data/regions/index.txt)
+     * @return bool 如果索引读取成功返回 true
+     */
+    bool loadRegionIndex(const QString& indexPath);
+
+    /**
+     * @brief 是否处于分区加载模式
+     */
+    bool isRegionMode() const { return !m_regions.isEmpty(); }
+
+    /**
+     * @brief 加载与指定区域相交的所有分区
+     *
+     * @param area 场景坐标中的区域（当前视野或查询走廊）
+     * @return int 本次新加载的分区数量
+     */
+    int ensureRegionsLoaded(const QRectF& area);
+
+    /**
+     * @brief 把当前地图按网格切分成分区文件
+     *
+     * 每个分区一对 nodes/edges 文件，跨区道路单独存放，
+     * 并生成记录分区边界的索引文件 index.txt。
+     * 描述另写进各分区的描述文件，节点、道路行里只存偏移，加载时不读（见 DescriptionStore）。
+     *
+     * @param outDir 输出目录
+     * @param cellSize 网格边长（像素）
+     * @return bool 如果写入成功返回 true
+     */
+    bool saveRegions(const QString& outDir, double cellSize) const;
+
     // =========================================================
     //  基础查询
     // =========================================================
@@ -100,11 +215,36 @@ public:
      */
     const Edge* findEdge(int u, int v) const;
 
+    /**
+     * @brief 查找两点之间道路的 ID
+     * 
+     * 通过 (u,v) 哈希索引查找，O(1)，与方向无关。
+     * 
+     * @return int 道路 ID，不存在时返回 -1
+     */
+    int edgeIdBetween(int u, int v) const;
+
+    /**
+     * @brief 按 ID 获取道路
+     * 
+     * 道路 ID 在本次运行期间稳定：更新道路、压缩存储都不会改变它，
+     * 视图和缓存可以用它来引用道路。
+     * 
+     * @param id 道路 ID
+     * @return const Edge* 指向道路的指针，不存在或已删除时返回 nullptr
+     */
+    const Edge* edgeById(int id) const;
+
+    /**
+     * @brief 当前道路数量（不含已删除的墓碑）
+     */
+    int edgeCount() const { return m_edgeSlot.size(); }
+
     /**
      * @brief 获取节点指针
      * 
      * @param id 节点的 ID
-     * @return Node* 指向节点的指针，如果不存在则返回 nullptr
+     * @return Node* 指向节点的指针，如果不存在则返回 nullptr；节点连续存放，下次增删节点后失效
      */
     Node* getNodePtr(int id);
 
@@ -116,20 +256,48 @@ public:
      */
     Node getNode(int id);
 
+    /**
+     * @brief 节点描述（悬停气泡、属性面板用）
+     *
+     * 分区模式下描述不随节点加载，第一次用到时才从描述文件读取。
+     *
+     * @return QString 节点不存在时为空
+     */
+    QString nodeDescription(int id);
+
+    /**
+     * @brief 道路描述，同 nodeDescription
+     */
+    QString edgeDescription(int id);
+
     /**
      * @brief 获取所有节点
      * 
-     * @return QVector<Node> 包含所有节点的列表
+     * 会按 ID 排序复制一份；只读遍历（如绘制地图）用 snapshot()->nodes()，不复制。
+     *
+     * @return QVector<Node> 包含所有节点的列表（按 ID 升序）
      */
     QVector<Node> getAllNodes() const;
 
     /**
      * @brief 获取所有边
      * 
+     * 有墓碑时会复制一份；只读遍历用 snapshot()->edges()，不复制。
+     *
      * @return QVector<Edge> 包含所有边的列表
      */
     QVector<Edge> getAllEdges() const;
 
+    /**
+     * @brief 获取图数据版本号
+     * 
+     * 节点或道路每发生一次变化版本号就递增，
+     * 下游缓存（寻路快照、预计算结果等）可据此判断是否失效。
+     * 
+     * @return quint64 当前版本号
+     */
+    quint64 graphVersion() const { return m_graphVersion; }
+
     // =========================================================
     //  编辑器 CRUD 接口
     // =========================================================
@@ -181,31 +349,187 @@ public:
      */
     void deleteEdge(int u, int v);
 
+    /**
+     * @brief 批量导入一次草稿会话
+     * 
+     * 读取 MapEditor 写出的草稿文件，把其中的节点按当前地图重新分配 ID，
+     * 道路端点随之映射；距离为 0 的道路按坐标计算长度。
+     * 整批只重建一次邻接表、只请求一次保存。
+     * 导入成功后草稿文件改名为 <原名>.imported，再次导入不会重复添加。
+     * 
+     * @param nodesDraftPath 节点草稿文件路径
+     * @param edgesDraftPath 道路草稿文件路径
+     * @return int 导入的节点数量，草稿无法读取时返回 -1
+     */
+    int importDraft(const QString& nodesDraftPath, const QString& edgesDraftPath);
+
+    /**
+     * @brief 执行拓扑清理方案（见 TopologyCleaner::plan）
+     * 
+     * 整个方案作为一批编辑：一次撤销全部回退。
+     * 合并时被删节点的道路改接到保留节点（已有同端点道路则丢弃）；
+     * 交叉处新建路口，被切开的道路按 0.91 米/像素重算各段长度，其余属性沿用。
+     * 方案生成后图若被修改过，找不到的节点和道路会被跳过。
+     * 
+     * @param plan 清理方案
+     * @return GraphDiff 这批编辑的变化
+     */
+    GraphDiff applyTopologyPlan(const TopologyPlan& plan);
+
     // =========================================================
-    //  撤销功能
+    //  批量编辑
     // =========================================================
 
     /**
-     * @brief 记录操作以供撤销
+     * @brief 开始一批编辑
+     * 
+     * commit() 之前的所有编辑：合并为撤销历史中的一项，
+     * 变化累积成一份 GraphDiff，只请求一次保存、只发一次变化通知。
+     * 可嵌套，最外层 commit() 时才真正提交。
+     * 不在批次中的单个编辑等同于只含一步的批次。
+     * 
+     * @param label 批次名称（撤销历史中显示）
+     */
+    void beginBatch(const QString& label = QString());
+
+    /**
+     * @brief 提交当前批次
+     * 
+     * 最外层提交时发出 GraphNotifier::graphChanged，并请求一次保存。
+     * 
+     * @return GraphDiff 最外层提交时返回整批的变化，嵌套提交返回空集合
+     */
+    GraphDiff commit();
+
+    /**
+     * @brief 是否处于批次中
+     */
+    bool inBatch() const { return m_batchDepth > 0; }
+
+    /**
+     * @brief 获取变化通知器
      * 
-     * @param action 要记录的历史动作
+     * 视图连接 graphChanged 信号，只按变化更新场景，无需整图重绘。
      */
-    void pushAction(const HistoryAction& action);
+    GraphNotifier* notifier() const { return m_notifier; }
+
+    // =========================================================
+    //  撤销 / 重做
+    // =========================================================
 
     /**
      * @brief 执行撤销操作
      * 
-     * 恢复到上一步的状态。
+     * 回退最近的一个事务（一次拖动、一次删除、一次导入……），
+     * 只改动其中涉及的节点和道路，不重建邻接表。
      */
     void undo();
 
+    /**
+     * @brief 执行重做操作
+     */
+    void redo();
+
     /**
      * @brief 检查是否可以撤销
      * 
-     * @return bool 如果撤销栈不为空返回 true，否则返回 false
+     * @return bool 如果有可撤销的事务返回 true，否则返回 false
      */
     bool canUndo() const;
 
+    /**
+     * @brief 检查是否可以重做
+     */
+    bool canRedo() const;
+
+    /**
+     * @brief 开始一个撤销分组
+     * 
+     * 在 endUndoGroup() 之前的所有编辑合并为历史中的一项。可嵌套。
+     * 
+     * @param label 分组名称
+     */
+    void beginUndoGroup(const QString& label);
+
+    /**
+     * @brief 结束撤销分组
+     */
+    void endUndoGroup();
+
+    /**
+     * @brief 获取撤销历史（可调整内存预算、读取统计）
+     */
+    EditHistory& history() { return m_history; }
+
+    // =========================================================
+    //  只读快照
+    // =========================================================
+
+    /**
+     * @brief 获取当前版本的只读快照
+     * 
+     * 只能在模型所在的（界面）线程调用；返回的快照可以交给任意线程使用。
+     * 生成快照只增加容器引用计数；之后的编辑在模型一侧写时复制，快照保持不变。
+     * 版本未变化时多次调用返回同一个快照；只有道路封闭变了时，
+     * 新快照与旧快照共享全部图数据，只换封闭表。
+     * 
+     * @return GraphSnapshotPtr 快照的共享引用
+     */
+    GraphSnapshotPtr snapshot();
+
+    /**
+     * @brief 获取预计算缓存
+     *
+     * 加载地图、时刻表以及每批编辑之后自动在后台重新准备；
+     * 结果与当前版本一致时才会随快照提供给寻路，否则寻路退回逐对计算。
+     */
+    PrecomputeCache* precomputeCache() const { return m_precompute; }
+
+    // =========================================================
+    //  连通性
+    // =========================================================
+
+    /**
+     * @brief 给定交通方式下，这些点是否都在同一个连通分量里
+     * 
+     * 用于寻路前的快速拒绝：不连通的查询不必跑完一整次失败的 Dijkstra。
+     * 分区模式下未加载的分区可能把分量连起来，无法判断，总是返回 true。
+     * 
+     * @param stops 起点、途经点、终点
+     * @param mode 交通方式
+     * @return bool 不可能连通时返回 false
+     */
+    bool canReach(const QVector<int>& stops, TransportMode mode);
+
+    /**
+     * @brief 节点在档案下的连通分量标签
+     */
+    int componentOf(int nodeId, ConnectivityProfile profile);
+
+    /**
+     * @brief 不在主路网（最大连通分量）上的节点
+     */
+    QSet<int> islandNodes(ConnectivityProfile profile);
+
+    /**
+     * @brief 桥：断开后会把路网一分为二的道路（道路 ID）
+     */
+    QVector<int> bridgeEdges(ConnectivityProfile profile) const;
+
+    // =========================================================
+    //  道路封闭
+    // =========================================================
+
+    /**
+     * @brief 道路封闭集（施工、节日管制、无障碍需求等）
+     *
+     * 在这里定义、开关的封闭随下一次 snapshot() 生效：只换快照上的封闭表，
+     * 不重建邻接表、不增加图版本号，预计算缓存和连通分量保持有效。
+     * 封闭整条路用 defineRoads（按路名，每次生成快照时对照当前道路表）；
+     * 按道路 ID 的封闭在重新加载地图时丢弃。
+     */
+    EdgeAccess& edgeAccess() { return m_access; }
+
     // =========================================================
     //  寻路与计算
     // =========================================================
@@ -213,7 +537,8 @@ public:
     /**
      * @brief 寻找路径
      * 
-     * 使用 Dijkstra 算法寻找两点之间的最优路径。
+     * 使用 Dijkstra 算法寻找两点之间的最优路径（在当前快照上执行）。
+     * 分区模式下会按需加载搜索中碰到的分区并重试。
      * 
      * @param startId 起点 ID
      * @param endId 终点 ID
@@ -250,46 +575,135 @@ public:
         bool enableLateCheck
     );
 
+    /**
+     * @brief 在后台线程计算多策略路线推荐
+     * 
+     * 参数同 getMultiStrategyRoutes。搜索使用调用时刻的快照，
+     * 结果就绪前界面可以继续编辑地图；结果对应的是发起查询时的版本。
+     * 
+     * @return QFuture 结果在界面线程上就绪（可用 QFutureWatcher 等待）
+     */
+    QFuture<QVector<PathRecommendation>> getMultiStrategyRoutesAsync(
+        int startId,
+        int endId,
+        const QVector<int>& waypoints,
+        TransportMode mode,
+        Weather weather,
+        QTime currentTime,
+        QTime classTime,
+        bool enableLateCheck
+    );
+
 private:
-    QMap<int, Node> nodesMap;           ///< 存储所有节点的映射，Key 为 ID
-    QVector<Edge> edgesList;            ///< 存储所有边的列表
-    QMap<int, QVector<Edge>> adj;       ///< 邻接表，用于快速查找连接关系
+    NodeTable nodeTable;                ///< 全部节点（稠密下标连续存放，ID -> 下标 O(1)）
+    QVector<Edge> edgesList;            ///< 道路存储（含 id = -1 的墓碑，按需压缩）
+    QHash<int, int> m_edgeSlot;         ///< 道路 ID -> edgesList 中的位置
+    QHash<quint64, int> m_edgePairIndex;///< 无向端点对 -> 道路 ID
+    int m_nextEdgeId = 0;               ///< 下一个道路 ID
+    int m_edgeTombstones = 0;           ///< edgesList 中的墓碑数量
+
+    /// 墓碑至少积累到这个数量才考虑压缩
+    static const int kEdgeCompactMin = 64;
+    AdjacencyList adj;                  ///< 邻接表（按节点稠密下标，只含寻路字段），用于快速查找连接关系
+    QHash<int, QVector<int>> m_adjPending;  ///< 端点不在内存中的道路：缺席节点 ID -> 对侧端点（节点出现后补进邻接表）
+    StringPool m_strings;               ///< 节点、道路的名称和描述（相同内容只存一份）
+    DescriptionStore m_descriptions;    ///< 分区模式下按需读取的描述
+
+    /**
+     * @brief 把节点 / 道路的显示字符串换成池中的共享副本（入库前调用）
+     */
+    void internStrings(Node& n);
+    void internStrings(Edge& e);
+    ConnectivityIndex m_connectivity;   ///< 按档案的连通分量（随邻接表维护）
+    EdgeAccess m_access;                ///< 道路封闭集（不属于图数据，不影响版本号）
+    quint64 m_graphVersion = 0;         ///< 图数据版本号，每次修改递增
+    std::weak_ptr<const GraphSnapshot> m_snapshotCache; ///< 最近生成的快照（弱引用，不延长其寿命）
+    PrecomputeCache* m_precompute = nullptr;    ///< 预计算结果的后台准备与磁盘缓存
+    RideMatrixPtr m_rideMatrix;                 ///< 最近一次预计算的校车乘车矩阵
+    quint64 m_rideMatrixVersion = 0;            ///< 乘车矩阵对应的图数据版本号
+
+    /**
+     * @brief 请求在后台重新准备预计算结果（缓存目录为 Data 的同级目录 cache/）
+     */
+    void requestPrecompute();
+
+    /**
+     * @brief 把导入过的草稿改名为 <原名>.imported
+     */
+    static void rotateDraft(const QString& path);
 
     int maxBuildingId = 100;            ///< 建筑 ID 计数器
     int maxRoadId = 10000;              ///< 道路 ID 计数器
-    QStack<HistoryAction> undoStack;    ///< 撤销操作栈
+    EditHistory m_history;              ///< 撤销/重做历史
 
     /// 时刻表数据：Key=车站ID, Value=排序后的发车时间列表
     QMap<int, QVector<QTime>> stationSchedules;
 
     /**
-     * @brief 校车计算辅助结构体
+     * @brief 分区索引中的一项
      */
-    struct BusRouteResult
+    struct RegionInfo
     {
-        bool valid = false;             ///< 方案是否有效
-        QVector<int> fullPath;          ///< 完整路径点 (步行1 + 乘车 + 步行2)
-        double totalDuration = 0;       ///< 总耗时
-        double walk1Duration = 0;       ///< 第一段步行耗时
-        double waitDuration = 0;        ///< 等车耗时
-        double rideDuration = 0;        ///< 乘车耗时
-        double walk2Duration = 0;       ///< 第二段步行耗时
-        int stationStartId = -1;        ///< 上车站 ID
-        int stationEndId = -1;          ///< 下车站 ID
-        QTime nextBusTime;              ///< 实际上车的班次时间
+        int id = -1;                ///< 分区 ID
+        QRectF bounds;              ///< 分区边界（场景坐标）
+        QString nodesFile;          ///< 分区节点文件路径
+        QString edgesFile;          ///< 分区内部道路文件路径
+        QString descFile;           ///< 描述文件路径（为空表示描述直接写在行里）
+        bool loaded = false;        ///< 是否已加载
     };
 
+    QVector<RegionInfo> m_regions;          ///< 分区索引（为空表示整图模式）
+    QHash<int, int> m_boundaryNodeRegion;   ///< 跨区道路端点 -> 所在分区下标
+
+    /// 查询走廊在起终点包围盒之外的留白（像素）
+    static constexpr double kQueryCorridorMargin = 300.0;
+
+    /**
+     * @brief 加载单个分区（不重建邻接表）
+     */
+    bool loadRegion(int index);
+
+    /**
+     * @brief 根据已加载的节点校准 ID 计数器
+     */
+    void calibrateIdCounters();
+
+    /**
+     * @brief 加载覆盖起点、终点和途经点的查询走廊
+     */
+    void ensureQueryCorridorLoaded(int startId, int endId, const QVector<int>& waypoints);
+
+    /**
+     * @brief 加载寻路时碰到的分区，有新分区时重建邻接表
+     * @return int 新加载的分区数量
+     */
+    int loadWantedRegions(const QSet<int>& wanted);
+
     /**
      * @brief 解析节点行数据
      * @param line 文件中的一行文本
+     * @param descFile 描述文件下标（m_descriptions）；>= 0 时描述列是偏移，只记位置不读
      */
-    void parseNodeLine(const QString& line);
+    void parseNodeLine(const QString& line, int descFile = -1);
 
     /**
      * @brief 解析边行数据
      * @param line 文件中的一行文本
+     * @param descFile 同 parseNodeLine
      */
-    void parseEdgeLine(const QString& line);
+    void parseEdgeLine(const QString& line, int descFile = -1);
+
+    /**
+     * @brief 把一行文本解析为节点（不存入地图）
+     * @return bool 数据完整时返回 true
+     */
+    static bool parseNodeFields(const QString& line, Node& node);
+
+    /**
+     * @brief 把一行文本解析为边（不存入地图）
+     * @return bool 数据完整时返回 true
+     */
+    static bool parseEdgeFields(const QString& line, Edge& edge);
 
     /**
      * @brief 解析时刻表行数据
@@ -297,101 +711,179 @@ private:
      */
     void parseScheduleLine(const QString& line);
 
+    /**
+     * @brief 把一行文本解析为车站时刻（不存入时刻表）
+     * @return bool 数据完整时返回 true
+     */
+    static bool parseScheduleFields(const QString& line, int& stationId, QVector<QTime>& times);
+
     /**
      * @brief 构建邻接表
      * 
-     * 根据 edgesList 重新生成 adj 数据。
+     * 根据 edgesList 重新生成 adj 数据；先按坐标重排节点下标（NodeTable::sortByLocation）。
      */
     void buildAdjacencyList();
 
     /**
-     * @brief 计算边的权重
-     * 
-     * @param edge 边对象
-     * @param weightMode 权重模式
-     * @param transportMode 交通方式
-     * @param weather 天气
-     * @return double 计算出的权重值
+     * @brief 无向端点对的哈希键
      */
-    double getEdgeWeight(const Edge& edge, WeightMode weightMode,
-                         TransportMode transportMode, Weather weather) const;
+    static quint64 edgePairKey(int u, int v);
 
     /**
-     * @brief 获取实际速度
+     * @brief 把道路写入存储并登记索引（不改邻接表）
      * 
-     * @param mode 交通方式
-     * @param weather 天气
-     * @return double 速度值
+     * 同一对端点已有道路时原位覆盖并沿用其 ID；
+     * 否则优先沿用 edge.id（撤销删除时），再否则分配新 ID。
+     * 
+     * @param edge 要写入的道路，返回时 edge.id 为最终 ID
+     * @return int 道路 ID
      */
-    double getRealSpeed(TransportMode mode, Weather weather) const;
+    int storeEdge(Edge& edge);
 
     /**
-     * @brief 判断是否迟到
-     * 
-     * @param durationSeconds 行程耗时（秒）
-     * @param current 当前时间
-     * @param target 目标时间
-     * @return bool 如果迟到返回 true
+     * @brief 把 u-v 之间的道路标记为墓碑（不改邻接表）
+     * @param removed 可选，返回被删除的道路
+     * @return bool 是否找到并删除
      */
-    bool isLate(double durationSeconds, QTime current, QTime target) const;
+    bool unstoreEdge(int u, int v, Edge* removed = nullptr);
 
     /**
-     * @brief 计算最优校车方案
-     * 
-     * @param startId 起点 ID
-     * @param endId 终点 ID
-     * @param currentTime 当前时间
-     * @param weather 天气
-     * @return BusRouteResult 最优方案结果
+     * @brief 去掉 edgesList 中的墓碑，ID 保持不变
      */
-    BusRouteResult calculateBestBusRoute(int startId, int endId, QTime currentTime, Weather weather);
+    void compactEdges();
 
     /**
-     * @brief 获取下一班车时间
-     * 
-     * @param stationId 车站 ID
-     * @param arrivalTime 到达车站的时间
-     * @param weather 天气（可能导致延误）
-     * @return QTime 下一班车的时间
+     * @brief 清空道路存储和索引
+     */
+    void clearEdges();
+
+    /**
+     * @brief 把一条边加入邻接表（正反两个方向）
+     */
+    void adjInsertEdge(const Edge& edge);
+
+    /**
+     * @brief 从邻接表中删除 u-v 之间的边（正反两个方向）
+     */
+    void adjRemoveEdge(int u, int v);
+
+    /**
+     * @brief 从邻接表中删除节点及其所有邻居记录
+     */
+    void adjRemoveNode(int id);
+
+    /**
+     * @brief 与节点相连的道路的对侧端点（节点不在内存中时取 m_adjPending 中的记录）
+     */
+    QVector<int> adjNeighborIds(int id) const;
+
+    /**
+     * @brief 邻接表中加入 from -> to 这一侧（from 不在内存中时先记下）
      */
-    QTime getNextBusTime(int stationId, QTime arrivalTime, Weather weather) const;
+    void adjAppend(int from, int to, const Edge& edge);
+
+    /**
+     * @brief 从邻接表中取出 from -> to 这一侧
+     * @param removed 可选，返回被取出的记录
+     * @return bool 是否找到（from 不在内存中时总是 false）
+     */
+    bool adjTake(int from, int to, AdjEdge* removed);
+
+    /**
+     * @brief 存入节点（编辑、回放、重载时使用）
+     *
+     * 新节点占用一个稠密下标；之前就有道路连向这个 ID 时，把这些道路补进邻接表。
+     * 整批加载之后会整体重建邻接表，直接写 nodeTable 即可。
+     */
+    void insertNode(const Node& node);
 
     QString m_nodesPath;    ///< 节点文件路径
     QString m_edgesPath;    ///< 边文件路径
 
+    // =========================================================
+    //  编辑日志
+    // =========================================================
+
+    EditJournal m_journal;                      ///< 追加式编辑日志 (与 nodes.txt 同目录)
+    SaveScheduler* m_saveScheduler = nullptr;   ///< 后台防抖保存
+
+    // =========================================================
+    //  热重载状态
+    // =========================================================
+
+    DataReloader* m_reloader = nullptr;         ///< 数据文件监视（未启用时为空）
+    QString m_schedulePath;                     ///< 时刻表文件路径
+    ReloadBaseline m_diskBaseline;              ///< 磁盘上现在的内容
+    NodeTable m_savingNodes;                    ///< 正在写盘的节点（写完后成为基准）
+    QVector<Edge> m_savingEdges;                ///< 正在写盘的道路
+
     /**
-     * @brief 自动保存
-     * 
-     * 如果路径已设置，则自动保存数据。
+     * @brief 更新磁盘基准的节点和道路（加载、保存完成后调用）
      */
-    void autoSave()
-    {
-        if (m_nodesPath.isEmpty() || m_edgesPath.isEmpty())
-        {
-            return;
-        }
-        saveData(m_nodesPath, m_edgesPath);
-    }
+    void setDiskBaseline(const NodeTable& nodes, const QVector<Edge>& edges);
+
+    // =========================================================
+    //  批量编辑状态
+    // =========================================================
+
+    GraphNotifier* m_notifier = nullptr;        ///< 变化通知
+    int m_batchDepth = 0;                       ///< 批次嵌套深度
+    GraphDiff m_pendingDiff;                    ///< 当前批次累积的变化
+    bool m_batchSaveRequested = false;          ///< 当前批次是否需要保存
+
+    /// 日志累积到多少条记录后，不再等防抖窗口，立即在后台压缩成完整快照
+    static const int kJournalCompactThreshold = 512;
 
     /**
-     * @brief 寻找多阶段路径
-     * 
-     * 支持途经点的路径查找。
+     * @brief 打开与当前地图配套的日志，并回放其中的记录
+     */
+    void openJournal();
+
+    /**
+     * @brief 应用一条日志记录（仅修改内存数据，不写日志、不入撤销栈）
+     */
+    void applyJournalRecord(const QString& record);
+
+    /**
+     * @brief 删除节点及其相连的边（不写日志、不入撤销栈）
+     * @param removedEdges 可选，返回被删除的边
      */
-    QVector<int> findMultiStagePath(int startId, int endId, const QVector<int>& waypoints, TransportMode mode, Weather weather, WeightMode weightMode);
+    void removeNodeAndEdges(int id, QVector<Edge>* removedEdges = nullptr);
 
     /**
-     * @brief 计算路径总耗时
+     * @brief 应用一条历史增量（写日志，不入撤销栈）
+     * @param forward true 为重做方向，false 为撤销方向
      */
-    double calculateDuration(const QVector<int>& pathNodeIds, TransportMode mode, Weather weather) const;
+    void applyDelta(const EditDelta& d, bool forward);
+
+    /**
+     * @brief 删除 u-v 之间的边（不写日志、不入撤销栈）
+     * @return bool 是否找到并删除
+     */
+    bool removeEdgeBetween(int u, int v);
+
+    /// 记录一次节点新增/修改
+    void journalNode(const Node& n);
+    /// 记录一次节点删除（连带其相连的边）
+    void journalNodeRemoved(int id);
+    /// 记录一次边新增/修改
+    void journalEdge(const Edge& e);
+    /// 记录一次边删除
+    void journalEdgeRemoved(int u, int v);
 
     /**
-     * @brief 计算路径总距离
+     * @brief 请求在后台把当前状态压缩成完整快照
+     *
+     * 连续编辑由 SaveScheduler 合并；日志过长时跳过防抖立即写。
+     * 批次进行中只做标记，提交时统一请求。
      */
-    double calculateDistance(const QVector<int>& pathNodeIds) const;
+    void scheduleSnapshotSave();
 
     /**
-     * @brief 计算路径总代价
+     * @brief 为后台保存准备快照（在真正开始写盘时由调度器调用）
+     *
+     * 活动日志先被封存，后续编辑写入新的活动段；
+     * 快照原子落盘后再删除封存段。
      */
-    double calculateCost(const QVector<int>& pathNodeIds) const;
+    SaveSnapshot takeSaveSnapshot();
 };
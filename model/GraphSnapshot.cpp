@@ -0,0 +1,853 @@
+// ============================================================
+// GraphSnapshot.cpp - 图数据只读快照与寻路算法
+//
+// 快照生成后不再修改，这里的函数都只读数据，
+// 可以在任意线程上并发执行
+// ============================================================
+
+#include "GraphSnapshot.h"
+#include <queue>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+// ============================================================
+// 基础查询
+// ============================================================
+const Node* GraphSnapshot::node(int id) const
+{
+    return m_nodes.find(id);
+}
+
+const Edge* GraphSnapshot::edge(int id) const
+{
+    auto it = m_edgeSlot.constFind(id);
+    if (it == m_edgeSlot.cend())
+    {
+        return nullptr;
+    }
+    return &m_edges[it.value()];
+}
+
+const AdjEdge* GraphSnapshot::findEdge(int u, int v) const
+{
+    int dense = m_nodes.denseOf(u);
+    if (dense < 0 || dense >= m_adj.size())
+    {
+        return nullptr;
+    }
+    for (const AdjEdge& e : m_adj[dense])
+    {
+        if (e.v == v)
+        {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+// ============================================================
+//             核心物理与寻路逻辑
+// ============================================================
+
+// ============================================================
+// 获取实际行进速度（米/秒）
+// 根据交通方式和天气计算实际速度
+// ============================================================
+double GraphSnapshot::getRealSpeed(TransportMode mode, Weather weather) const
+{
+    double speed = 0.0;
+    
+    switch (mode)
+    {
+    case TransportMode::Walk:
+        speed = Config::SPEED_WALK;  // 基础步行速度
+        if (weather == Weather::Rainy)
+        {
+            speed = speed * 0.8;  // 下雨减速20%
+        }
+        if (weather == Weather::Snowy)
+        {
+            speed = speed * 0.6;  // 下雪减速40%
+        }
+        break;
+        
+    case TransportMode::Run:
+        speed = Config::SPEED_RUN;
+        if (weather != Weather::Sunny)
+        {
+            speed = speed * 0.7;  // 非晴天减速30%
+        }
+        break;
+        
+    case TransportMode::SharedBike:
+        if (weather == Weather::Snowy)
+        {
+            return 0.0001;  // 下雪不能骑车
+        }
+        speed = Config::SPEED_SHARED_BIKE;
+        break;
+        
+    case TransportMode::EBike:
+        if (weather == Weather::Snowy)
+        {
+            return 0.0001;  // 下雪不能骑电动车
+        }
+        speed = Config::SPEED_EBIKE;
+        break;
+        
+    case TransportMode::Bus:
+        speed = Config::SPEED_BUS;
+        break;
+    }
+    
+    return speed;
+}
+
+// ============================================================
+// 计算边的权重（用于路径搜索）
+// 权重可以是距离、时间或综合代价
+// ============================================================
+double GraphSnapshot::getEdgeWeight(
+    const AdjEdge& edge,
+    WeightMode weightMode,
+    TransportMode transportMode,
+    Weather weather) const
+{
+    // 判断是否是骑行类交通
+    bool isVehicle = (transportMode == TransportMode::SharedBike || 
+                      transportMode == TransportMode::EBike);
+    
+    // ---- 特殊情况处理：返回极大值表示"不可通行" ----
+    // 骑车不能走楼梯和室内，下雪天不能骑车（规则见 EdgeAccess::profileMask）
+    if (!(EdgeAccess::profileMask(transportMode, weather) & edgeTypeBit(edge.type)))
+    {
+        return std::numeric_limits<double>::max();
+    }
+    
+    // ---- 根据权重模式计算 ----
+    if (weightMode == WeightMode::DISTANCE)
+    {
+        return edge.distance();  // 只考虑距离
+    }
+
+    // 获取基础速度
+    double speed = getRealSpeed(transportMode, weather);
+    
+    // 坡道减速
+    if (edge.steep)
+    {
+        if (transportMode == TransportMode::SharedBike)
+        {
+            speed = speed * 0.3;  // 单车爬坡很慢
+        }
+        else if (transportMode == TransportMode::Walk)
+        {
+            speed = speed * 0.8;
+        }
+        else if (transportMode == TransportMode::Run)
+        {
+            speed = speed * 0.6;
+        }
+    }
+
+    // 雨天骑车额外惩罚
+    double penaltyMultiplier = 1.0;
+    if (weather == Weather::Rainy && isVehicle)
+    {
+        penaltyMultiplier = 1.5;
+    }
+
+    // 计算通过时间
+    double time = (edge.distance() / speed) * penaltyMultiplier;
+    
+    if (weightMode == WeightMode::TIME)
+    {
+        return time;
+    }
+
+    // 综合代价模式（懒人路线）
+    if (weightMode == WeightMode::COST)
+    {
+        double cost = edge.distance();
+        
+        // 坡道很累，大幅增加代价
+        if (edge.steep)
+        {
+            cost = cost * 20.0;
+        }
+        
+        // 楼梯也很累
+        if (edge.type == EdgeType::Stairs)
+        {
+            cost = cost * 10.0;
+        }
+        
+        // 下雪天走楼梯超级危险
+        if (weather == Weather::Snowy && edge.type == EdgeType::Stairs)
+        {
+            cost = cost * 100.0;
+        }
+        
+        return cost;
+    }
+    
+    return edge.distance();
+}
+
+// ============================================================
+// Dijkstra 最短路径算法 - 核心寻路函数
+// 
+// 这是计算机科学中的经典算法，用于找两点之间的最短路径
+// 距离表、前驱表、优先队列都在查询上下文里，跨搜索复用，不再每次分配
+// 分区模式下，比当前结果更有希望、但落在未加载分区的方向记入 wantedRegions
+// ============================================================
+bool GraphSnapshot::search(
+    QueryContext& ctx,
+    int source,
+    int target,
+    TransportMode mode,
+    Weather weather,
+    WeightMode weightMode,
+    QSet<int>* wantedRegions) const
+{
+    // ---- 第1步：初始化距离表和父节点表 ----
+    // 按稠密下标索引的数组，上次搜索改过的项恢复为无穷大
+    const double INF = std::numeric_limits<double>::max();
+    ctx.prepareSearch(m_nodes.slotCount());
+    const std::pmr::vector<double>& dist = ctx.m_dist;  // 每个节点到起点的最短距离
+
+    // ---- 第2步：起点入队 ----
+    // 优先队列是上下文里的小根堆，按距离从小到大取出
+    ctx.reach(source, 0, -1);
+
+    // 可走的道路类型（交通方式、天气、整类封闭）先合成一个掩码，封闭名单是按道路 ID 的位集
+    const ClosureMask* closed = m_closures.get();
+    const EdgeTypeMask allowed = EdgeAccess::profileMask(mode, weather) & ~(closed ? closed->types() : 0);
+
+    // ---- 第3步：Dijkstra 主循环 ----
+    while (!ctx.m_heap.empty())
+    {
+        // 取出当前距离最小的节点
+        auto [d, u] = ctx.popNearest();
+        
+        // 如果这个距离已经过时，跳过
+        if (d > dist[u])
+        {
+            continue;
+        }
+        
+        // 找到终点，提前结束
+        if (u == target)
+        {
+            break;
+        }
+
+        // 遍历所有相邻的边
+        for (const AdjEdge& e : m_adj[u])
+        {
+            // 不许走或已封闭的道路跳过：各一次位测试
+            if (!(allowed & edgeTypeBit(e.type)) || (closed && closed->isClosed(e.id)))
+            {
+                continue;
+            }
+
+            // 计算这条边的权重
+            double weight = getEdgeWeight(e, weightMode, mode, weather);
+            
+            // 如果这条路不通（权重为无穷大），跳过
+            if (weight >= INF)
+            {
+                continue;
+            }
+            
+            // 松弛操作：如果经过u到v的距离更短，就更新
+            double newDist = d + weight;
+
+            // 邻居不在内存中（分区模式下位于未加载的分区），记下来交给上层加载
+            if (e.to < 0)
+            {
+                auto regionIt = m_boundaryNodeRegion.constFind(e.v);
+                if (regionIt != m_boundaryNodeRegion.constEnd())
+                {
+                    ctx.m_frontier.push_back({newDist, regionIt.value()});
+                }
+                continue;
+            }
+
+            if (newDist < dist[e.to])
+            {
+                ctx.reach(e.to, newDist, u);
+            }
+        }
+    }
+
+    // 只有比当前结果更短的未加载方向才值得加载（权重非负，更远的不可能更优）
+    if (wantedRegions)
+    {
+        for (const auto& frontier : ctx.m_frontier)
+        {
+            if (frontier.first < dist[target])
+            {
+                wantedRegions->insert(frontier.second);
+            }
+        }
+    }
+
+    return dist[target] != INF;
+}
+
+// ============================================================
+// 寻找路径
+// 返回：从起点到终点的节点ID列表，不可达时为空
+// ============================================================
+QVector<int> GraphSnapshot::findPath(
+    int startId,
+    int endId,
+    TransportMode mode,
+    Weather weather,
+    WeightMode weightMode,
+    QSet<int>* wantedRegions) const
+{
+    // 搜索全程使用稠密下标，节点 ID 只在入口和回溯路径时转换
+    const int source = m_nodes.denseOf(startId);
+    const int target = m_nodes.denseOf(endId);
+    if (source < 0 || target < 0)
+    {
+        return {};  // 返回空路径
+    }
+
+    QueryContext& ctx = QueryContext::forThread();
+    if (!search(ctx, source, target, mode, weather, weightMode, wantedRegions))
+    {
+        return {};
+    }
+
+    // 从终点往回走，构建路径（下标换回节点 ID），再反转
+    QVector<int> path;
+    for (int curr = target; curr != source; curr = ctx.m_parent[curr])
+    {
+        path.append(m_nodes.idAt(curr));
+    }
+    path.append(startId);
+    std::reverse(path.begin(), path.end());
+    
+    return path;
+}
+
+// ============================================================
+// 寻路并追加到请求内的临时路径
+// 与 findPath 相同，但路径写进调用者在 arena 上的数组，不另外分配
+// ============================================================
+bool GraphSnapshot::appendPath(
+    QueryContext& ctx,
+    int startId,
+    int endId,
+    TransportMode mode,
+    Weather weather,
+    WeightMode weightMode,
+    QSet<int>* wantedRegions,
+    QueryContext::Path& out) const
+{
+    const int source = m_nodes.denseOf(startId);
+    const int target = m_nodes.denseOf(endId);
+    if (source < 0 || target < 0)
+    {
+        return false;
+    }
+    if (!search(ctx, source, target, mode, weather, weightMode, wantedRegions))
+    {
+        return false;
+    }
+
+    const std::size_t begin = out.size();
+    for (int curr = target; curr != source; curr = ctx.m_parent[curr])
+    {
+        out.push_back(m_nodes.idAt(curr));
+    }
+    out.push_back(startId);
+    std::reverse(out.begin() + begin, out.end());
+    return true;
+}
+
+// ============================================================
+// 单源最短路径树
+// 与 findPath 相同的 Dijkstra，但不设终点，跑完整个连通分量
+// ============================================================
+void GraphSnapshot::shortestPathTree(
+    int startId,
+    TransportMode mode,
+    Weather weather,
+    WeightMode weightMode,
+    QVector<double>& dist,
+    QVector<int>& parent) const
+{
+    const double INF = std::numeric_limits<double>::max();
+    dist.fill(INF, m_nodes.slotCount());
+    parent.fill(-1, m_nodes.slotCount());
+
+    const int source = m_nodes.denseOf(startId);
+    if (source < 0)
+    {
+        return;
+    }
+
+    std::priority_queue<
+        std::pair<double, int>,
+        std::vector<std::pair<double, int>>,
+        std::greater<>
+    > pq;
+
+    dist[source] = 0;
+    pq.push({0, source});
+
+    while (!pq.empty())
+    {
+        double d = pq.top().first;
+        int u = pq.top().second;
+        pq.pop();
+
+        if (d > dist[u])
+        {
+            continue;
+        }
+
+        for (const AdjEdge& e : m_adj[u])
+        {
+            double weight = getEdgeWeight(e, weightMode, mode, weather);
+            if (weight >= INF || e.to < 0)
+            {
+                continue;
+            }
+
+            double newDist = d + weight;
+            if (newDist < dist[e.to])
+            {
+                dist[e.to] = newDist;
+                parent[e.to] = u;
+                pq.push({newDist, e.to});
+            }
+        }
+    }
+}
+
+// ============================================================
+// 校车相关逻辑
+// ============================================================
+
+// ============================================================
+// 获取下一班车时间
+// 根据当前时刻和天气，返回最近的一班车发车时间
+// ============================================================
+QTime GraphSnapshot::getNextBusTime(int stationId, QTime arrivalTime, Weather weather) const
+{
+    // 检查这个站点是否有时刻表
+    if (!m_schedules.contains(stationId))
+    {
+        return QTime();  // 返回无效时间
+    }
+    
+    // 计算天气导致的延误时间
+    int delayMinutes = 0;
+    if (weather == Weather::Rainy)
+    {
+        delayMinutes = 5;   // 下雨延误5分钟
+    }
+    if (weather == Weather::Snowy)
+    {
+        delayMinutes = 15;  // 下雪延误15分钟
+    }
+
+    // 遍历时刻表，找第一班晚于到达时间的车
+    const QVector<QTime>& rawTimes = m_schedules[stationId];
+    for (const QTime& rawT : rawTimes)
+    {
+        // 加上延误时间得到实际发车时间
+        QTime effectiveT = rawT.addSecs(delayMinutes * 60);
+        
+        // 如果这班车在我们到达之后发车，就坐这班
+        if (effectiveT >= arrivalTime)
+        {
+            return effectiveT;
+        }
+    }
+    
+    return QTime();  // 没有合适的班次
+}
+
+// ============================================================
+// 计算最佳校车路线
+// 会尝试所有可能的上车站和下车站组合，找最快的
+// 临时数组都在 arena 上，循环里只 clear() 复用容量
+// ============================================================
+GraphSnapshot::BusRouteResult GraphSnapshot::calculateBestBusRoute(
+    QueryContext& ctx,
+    int startId,
+    int endId,
+    QTime currentTime,
+    Weather weather,
+    QSet<int>* wantedRegions,
+    QueryContext::Path& fullPath) const
+{
+    BusRouteResult bestResult;
+    bestResult.valid = false;
+    bestResult.totalDuration = std::numeric_limits<double>::max();
+
+    // 找出所有公交站
+    QueryContext::Path stations(ctx.arena());
+    for (const Node& n : m_nodes)
+    {
+        if (n.category == NodeCategory::BusStation)
+        {
+            stations.push_back(n.id);
+        }
+    }
+    std::sort(stations.begin(), stations.end());  // 耗时相同的方案按车站 ID 取舍，与存储顺序无关
+    
+    if (stations.empty())
+    {
+        return bestResult;
+    }
+    const int stationCount = int(stations.size());
+
+    // 第3段（下车站步行到终点）与上车站无关，每个下车站只算一次
+    // 各段首尾相接存在 walk2Nodes 里，第 i 个下车站的一段是 [walk2Begin[i], walk2Begin[i + 1])，不可达为空
+    QueryContext::Path walk2Nodes(ctx.arena());
+    QueryContext::Path walk2Begin(ctx.arena());
+    std::pmr::vector<double> walk2Times(stationCount, 0.0, ctx.arena());
+    walk2Begin.reserve(stationCount + 1);
+    for (int i = 0; i < stationCount; ++i)
+    {
+        walk2Begin.push_back(int(walk2Nodes.size()));
+        if (appendPath(ctx, stations[i], endId, TransportMode::Walk, weather, WeightMode::TIME, wantedRegions, walk2Nodes))
+        {
+            walk2Times[i] = durationOf(walk2Nodes.data() + walk2Begin[i], qsizetype(walk2Nodes.size()) - walk2Begin[i],
+                                       TransportMode::Walk, weather);
+        }
+    }
+    walk2Begin.push_back(int(walk2Nodes.size()));
+
+    QueryContext::Path walk1Path(ctx.arena());
+    QueryContext::Path ridePath(ctx.arena());
+    QueryContext::Path bestWalk1(ctx.arena());
+    QueryContext::Path bestRide(ctx.arena());
+    int bestEnd = -1;
+
+    // 乘车矩阵按完整路网预计算；有道路封闭时不用它，逐对寻路（矩阵本身保留，封闭解除后照常使用）
+    const bool useMatrix = m_rideMatrix && !m_closures;
+
+    // 遍历所有上车站
+    for (int startStation : stations)
+    {
+        // 第1段：步行到上车站
+        walk1Path.clear();
+        if (!appendPath(ctx, startId, startStation, TransportMode::Walk, weather, WeightMode::TIME, wantedRegions, walk1Path))
+        {
+            continue;
+        }
+        
+        double walk1Time = durationOf(walk1Path.data(), walk1Path.size(), TransportMode::Walk, weather);
+        QTime arrivalAtStation = currentTime.addSecs((int)walk1Time);
+        
+        // 查询下一班车
+        QTime busTime = getNextBusTime(startStation, arrivalAtStation, weather);
+        if (!busTime.isValid())
+        {
+            continue;
+        }
+
+        double waitTime = arrivalAtStation.secsTo(busTime);
+
+        // 遍历所有下车站
+        for (int i = 0; i < stationCount; ++i)
+        {
+            int endStation = stations[i];
+            if (startStation == endStation || walk2Begin[i] == walk2Begin[i + 1])
+            {
+                continue;
+            }
+            
+            // 第2段：坐校车（有预计算矩阵时直接查表，路线等选定后再取）
+            double rideTime = 0;
+            if (useMatrix)
+            {
+                rideTime = m_rideMatrix->rideDuration(startStation, endStation);
+                if (rideTime >= std::numeric_limits<double>::max())
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                ridePath.clear();
+                if (!appendPath(ctx, startStation, endStation, TransportMode::Bus, weather, WeightMode::TIME, wantedRegions, ridePath))
+                {
+                    continue;
+                }
+                rideTime = durationOf(ridePath.data(), ridePath.size(), TransportMode::Bus, weather);
+            }
+            
+            // 第3段：从下车站步行到终点
+            double walk2Time = walk2Times[i];
+
+            // 计算总时间
+            double total = walk1Time + waitTime + rideTime + walk2Time;
+            
+            // 如果比当前最优解更好，记下各段，最后再拼接
+            if (total < bestResult.totalDuration)
+            {
+                bestResult.valid = true;
+                bestResult.totalDuration = total;
+                bestResult.stationStartId = startStation;
+                bestResult.stationEndId = endStation;
+                bestResult.nextBusTime = busTime;
+                bestEnd = i;
+                bestWalk1.assign(walk1Path.begin(), walk1Path.end());
+                bestRide.assign(ridePath.begin(), ridePath.end());
+            }
+        }
+    }
+
+    if (!bestResult.valid)
+    {
+        return bestResult;
+    }
+
+    // 拼接完整路径：相邻两段共用换乘的车站，后一段去掉起点
+    if (useMatrix)
+    {
+        bestRide.clear();
+        m_rideMatrix->appendRidePath(bestResult.stationStartId, bestResult.stationEndId, bestRide);
+    }
+    fullPath.assign(bestWalk1.begin(), bestWalk1.end());
+    if (!bestRide.empty())
+    {
+        fullPath.insert(fullPath.end(), bestRide.begin() + 1, bestRide.end());
+    }
+    fullPath.insert(fullPath.end(), walk2Nodes.begin() + walk2Begin[bestEnd] + 1,
+                    walk2Nodes.begin() + walk2Begin[bestEnd + 1]);
+    
+    return bestResult;
+}
+
+// ============================================================
+// 判断是否会迟到
+// ============================================================
+bool GraphSnapshot::isLate(double durationSeconds, QTime current, QTime target) const
+{
+    QTime arrival = current.addSecs((int)durationSeconds);
+    return arrival > target;
+}
+
+// ============================================================
+// 多段路径拼接（支持途经点）
+// ============================================================
+bool GraphSnapshot::findMultiStagePath(
+    QueryContext& ctx,
+    int startId,
+    int endId,
+    const QVector<int>& waypoints,
+    TransportMode mode,
+    Weather weather,
+    WeightMode weightMode,
+    QSet<int>* wantedRegions,
+    QueryContext::Path& out) const
+{
+    out.clear();
+    int currentStart = startId;
+    
+    // 逐段规划路径：依次经过各途经点，最后到终点
+    for (int i = 0; i <= waypoints.size(); ++i)
+    {
+        int target = (i < waypoints.size()) ? waypoints[i] : endId;
+        const std::size_t segmentBegin = out.size();
+        
+        // 如果某一段不可达，整个路径失败
+        if (!appendPath(ctx, currentStart, target, mode, weather, weightMode, wantedRegions, out))
+        {
+            out.clear();
+            return false;
+        }
+        
+        // 避免重复节点：如果不是第一段，去掉起点
+        if (segmentBegin > 0)
+        {
+            out.erase(out.begin() + segmentBegin);
+        }
+        
+        currentStart = target;
+    }
+    
+    return true;
+}
+
+// 请求内的临时路径与已生成的推荐是否相同
+static bool samePath(const QueryContext::Path& path, const QVector<int>& other)
+{
+    return std::equal(path.begin(), path.end(), other.begin(), other.end());
+}
+
+// ============================================================
+// 多策略路径推荐 - 核心函数
+// 为用户提供3种不同策略的路线选择
+// 各段路径在当前线程的查询上下文里计算，选中的才复制进结果
+// ============================================================
+QVector<PathRecommendation> GraphSnapshot::getMultiStrategyRoutes(
+    int startId,
+    int endId,
+    const QVector<int>& waypoints,
+    TransportMode mode,
+    Weather weather,
+    QTime currentTime,
+    QTime classTime,
+    bool enableLateCheck,
+    QSet<int>* wantedRegions) const
+{
+    QueryContext& ctx = QueryContext::forThread();
+    QueryContext::Scope scope(ctx);                 // 返回时回收本次请求的 arena
+    QueryContext::Path path(ctx.arena());           // 当前策略的路径（先于 scope 析构）
+
+    QVector<PathRecommendation> results;
+    results.reserve(3);
+
+    // ---- 校车模式：特殊处理 ----
+    if (mode == TransportMode::Bus)
+    {
+        BusRouteResult busRes = calculateBestBusRoute(ctx, startId, endId, currentTime, weather, wantedRegions, path);
+        
+        if (busRes.valid)
+        {
+            bool late = enableLateCheck && isLate(busRes.totalDuration, currentTime, classTime);
+            double dist = distanceOf(path.data(), path.size());
+            
+            results.append(PathRecommendation(
+                RouteType::FASTEST,
+                QStringLiteral("校车通勤"),
+                QStringLiteral("班次 %1").arg(busRes.nextBusTime.toString("HH:mm")),
+                QVector<int>(path.begin(), path.end()),
+                dist,
+                busRes.totalDuration,
+                0,
+                late
+            ));
+        }
+        
+        return results;
+    }
+
+    // ---- 策略A：极限冲刺（最快到达）----
+    {
+        if (findMultiStagePath(ctx, startId, endId, waypoints, mode, weather, WeightMode::TIME, wantedRegions, path))
+        {
+            double dist = distanceOf(path.data(), path.size());
+            double dur = durationOf(path.data(), path.size(), mode, weather);
+            bool late = enableLateCheck && isLate(dur, currentTime, classTime);
+            
+            results.append(PathRecommendation(
+                RouteType::FASTEST,
+                QStringLiteral("极限冲刺"),
+                QStringLiteral("最快到达"),
+                QVector<int>(path.begin(), path.end()),
+                dist,
+                dur,
+                0,
+                late
+            ));
+        }
+    }
+
+    // ---- 策略B：懒人养生（避开楼梯和坡道）----
+    if (mode != TransportMode::Run) {
+        bool found = findMultiStagePath(ctx, startId, endId, waypoints, mode, weather, WeightMode::COST, wantedRegions, path);
+        // 简单去重：如果路径和“极限冲刺”不一样才加
+        if (found && (results.isEmpty() || !samePath(path, results.last().pathNodeIds))) {
+            double dist = distanceOf(path.data(), path.size());
+            double dur = durationOf(path.data(), path.size(), mode, weather);
+            bool late = enableLateCheck && isLate(dur, currentTime, classTime);
+            results.append(PathRecommendation(RouteType::EASIEST, QStringLiteral("懒人养生"), QStringLiteral("平坦舒适"),
+                                              QVector<int>(path.begin(), path.end()), dist, dur, 0, late));
+        }
+    }
+
+    // 策略C: 经济适用 (Distance) - 仅步行
+    if (mode == TransportMode::Walk) {
+        bool found = findMultiStagePath(ctx, startId, endId, waypoints, mode, weather, WeightMode::DISTANCE, wantedRegions, path);
+        // 去重
+        bool isUnique = true;
+        for(const auto& r : results) if(samePath(path, r.pathNodeIds)) isUnique = false;
+        
+        if (found && isUnique) {
+            double dist = distanceOf(path.data(), path.size());
+            double dur = durationOf(path.data(), path.size(), mode, weather);
+            bool late = enableLateCheck && isLate(dur, currentTime, classTime);
+            results.append(PathRecommendation(RouteType::SHORTEST, QStringLiteral("经济适用"), QStringLiteral("路程最短"),
+                                              QVector<int>(path.begin(), path.end()), dist, dur, 0, late));
+        }
+    }
+
+    return results;
+}
+
+// ============================================================
+// 计算路径总时长（秒）
+// 遍历路径上的每条边，累加时间权重
+// ============================================================
+double GraphSnapshot::calculateDuration(const QVector<int>& pathNodeIds, TransportMode mode, Weather weather) const
+{
+    return durationOf(pathNodeIds.constData(), pathNodeIds.size(), mode, weather);
+}
+
+double GraphSnapshot::durationOf(const int* ids, qsizetype count, TransportMode mode, Weather weather) const
+{
+    double total = 0;
+    
+    // 遍历路径上每一条边
+    for (qsizetype i = 0; i < count - 1; ++i)
+    {
+        const AdjEdge* edge = findEdge(ids[i], ids[i + 1]);
+        
+        if (edge)
+        {
+            // 使用TIME权重模式计算这条边的通行时间
+            total += getEdgeWeight(*edge, WeightMode::TIME, mode, weather);
+        }
+    }
+    
+    return total;
+}
+
+// ============================================================
+// 计算路径总距离（米）
+// 遍历路径上的每条边，按厘米整数累加物理距离（不积累舍入误差）
+// ============================================================
+double GraphSnapshot::calculateDistance(const QVector<int>& pathNodeIds) const
+{
+    return distanceOf(pathNodeIds.constData(), pathNodeIds.size());
+}
+
+double GraphSnapshot::distanceOf(const int* ids, qsizetype count) const
+{
+    qint64 totalCm = 0;
+    
+    for (qsizetype i = 0; i < count - 1; ++i)
+    {
+        const AdjEdge* edge = findEdge(ids[i], ids[i + 1]);
+        
+        if (edge)
+        {
+            totalCm += edge->distanceCm;
+        }
+    }
+    
+    return totalCm * 0.01;
+}
+
+// ============================================================
+// 计算路径总成本
+// 目前成本等同于距离，未来可扩展（如考虑楼梯数量等）
+// ============================================================
+double GraphSnapshot::calculateCost(const QVector<int>& pathNodeIds) const
+{
+    return calculateDistance(pathNodeIds);
+}
+
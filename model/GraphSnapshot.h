@@ -0,0 +1,277 @@
+#pragma once
+
+#include "../GraphData.h"
+#include "PathRecommendation.h"
+#include "NodeTable.h"
+#include "StationRideMatrix.h"
+#include "QueryContext.h"
+#include "EdgeAccess.h"
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QTime>
+#include <memory>
+
+class GraphSnapshot;
+
+/// 快照的共享引用：持有者看到的数据永远不变，最后一个持有者释放时回收
+using GraphSnapshotPtr = std::shared_ptr<const GraphSnapshot>;
+
+/**
+ * @brief 图数据的只读快照（某一版本）
+ *
+ * 由 GraphModel::snapshot() 生成。节点表、道路表、邻接表、时刻表都是 Qt 隐式共享容器，
+ * 生成快照只增加引用计数；之后编辑器修改模型时，模型一侧的容器自动分离，
+ * 快照仍指向旧版本的数据。
+ *
+ * 快照一经生成就不再修改，所有查询都是 const 的，
+ * 可以交给后台线程执行寻路、批量计算或渲染，不必与界面线程上的编辑互斥。
+ */
+class GraphSnapshot
+{
+public:
+    /**
+     * @brief 快照对应的图数据版本号（见 GraphModel::graphVersion）
+     */
+    quint64 version() const { return m_version; }
+
+    /**
+     * @brief 全部节点（稠密下标存储，见 NodeTable）
+     */
+    const NodeTable& nodes() const { return m_nodes; }
+
+    /**
+     * @brief 道路表（与模型共享的存储，含显示用的名称、描述）
+     *
+     * 直接暴露模型的存放格式：其中可能有 id = -1 的墓碑（已删除的道路），遍历时跳过。
+     */
+    const QVector<Edge>& edges() const { return m_edges; }
+
+    /**
+     * @brief 道路 ID -> edges() 中的下标
+     */
+    const QHash<int, int>& edgeSlots() const { return m_edgeSlot; }
+
+    /**
+     * @brief 按道路 ID 取道路
+     * @return const Edge* 不存在时返回 nullptr
+     */
+    const Edge* edge(int id) const;
+
+    /**
+     * @brief 邻接表（按节点稠密下标索引，每条道路正反两个方向各一份，只含寻路字段）
+     */
+    const AdjacencyList& adjacency() const { return m_adj; }
+
+    /**
+     * @brief 时刻表：车站ID -> 发车时间
+     */
+    const QMap<int, QVector<QTime>>& schedules() const { return m_schedules; }
+
+    /**
+     * @brief 生成快照时启用的道路封闭（没有时为空）
+     */
+    const ClosureMaskPtr& closures() const { return m_closures; }
+
+    /**
+     * @brief 节点是否存在
+     */
+    bool containsNode(int id) const { return m_nodes.contains(id); }
+
+    /**
+     * @brief 获取节点
+     * @return const Node* 不存在时返回 nullptr
+     */
+    const Node* node(int id) const;
+
+    /**
+     * @brief 查找 u 到 v 的道路（u 一侧的方向）
+     *
+     * 在 u 的邻居列表中查找，代价 O(度数)。
+     *
+     * @return const AdjEdge* 不存在时返回 nullptr
+     */
+    const AdjEdge* findEdge(int u, int v) const;
+
+    // =========================================================
+    //  寻路与计算
+    // =========================================================
+
+    /**
+     * @brief 寻找路径（Dijkstra）
+     *
+     * 只在快照内已有的节点上搜索，避开 closures() 中封闭的道路。距离表、优先队列用当前线程的查询上下文（QueryContext），
+     * 只有返回的路径需要分配。
+     *
+     * @param wantedRegions 可选，返回值得加载的未加载分区下标（分区模式）
+     * @return QVector<int> 路径上经过的节点 ID 列表，不可达时为空
+     */
+    QVector<int> findPath(int startId, int endId, TransportMode mode, Weather weather,
+                          WeightMode weightMode = WeightMode::TIME,
+                          QSet<int>* wantedRegions = nullptr) const;
+
+    /**
+     * @brief 单源最短路径树（不提前结束，求出到所有可达节点的结果）
+     *
+     * 用于预计算，因此不考虑临时封闭（结果与封闭无关，开关封闭不必重算）。dist / parent 按节点稠密下标索引（nodes().denseOf），长度为 nodes().slotCount()：
+     * 不可达为 double 最大值，起点和不可达节点的前驱为 -1。
+     */
+    void shortestPathTree(int startId, TransportMode mode, Weather weather, WeightMode weightMode,
+                          QVector<double>& dist, QVector<int>& parent) const;
+
+    /**
+     * @brief 预计算的校车乘车矩阵（尚未算好或与本版本不符时为空）
+     */
+    const RideMatrixPtr& rideMatrix() const { return m_rideMatrix; }
+
+    /**
+     * @brief 获取多策略路线推荐
+     *
+     * 参数含义同 GraphModel::getMultiStrategyRoutes。
+     * 中间结果都放在当前线程的查询上下文里，请求结束时整体回收；
+     * 稳定后只有返回的推荐列表及其路径需要分配。
+     *
+     * @param wantedRegions 可选，返回值得加载的未加载分区下标（分区模式）
+     */
+    QVector<PathRecommendation> getMultiStrategyRoutes(
+        int startId,
+        int endId,
+        const QVector<int>& waypoints,
+        TransportMode mode,
+        Weather weather,
+        QTime currentTime,
+        QTime classTime,
+        bool enableLateCheck,
+        QSet<int>* wantedRegions = nullptr
+    ) const;
+
+    /**
+     * @brief 计算路径总耗时（秒）
+     */
+    double calculateDuration(const QVector<int>& pathNodeIds, TransportMode mode, Weather weather) const;
+
+    /**
+     * @brief 计算路径总距离（米）
+     */
+    double calculateDistance(const QVector<int>& pathNodeIds) const;
+
+    /**
+     * @brief 计算路径总代价
+     */
+    double calculateCost(const QVector<int>& pathNodeIds) const;
+
+private:
+    friend class GraphModel;    ///< 只有模型可以生成快照
+
+    GraphSnapshot() = default;
+
+    quint64 m_version = 0;                      ///< 图数据版本号
+    NodeTable m_nodes;                          ///< 节点
+    QVector<Edge> m_edges;                      ///< 道路（含墓碑）
+    QHash<int, int> m_edgeSlot;                 ///< 道路 ID -> m_edges 下标
+    AdjacencyList m_adj;                        ///< 邻接表（按稠密下标）
+    QMap<int, QVector<QTime>> m_schedules;      ///< 时刻表：车站ID -> 发车时间
+    QHash<int, int> m_boundaryNodeRegion;       ///< 跨区道路端点 -> 所在分区下标
+    RideMatrixPtr m_rideMatrix;                 ///< 校车乘车矩阵（可为空，此时逐对寻路）
+    ClosureMaskPtr m_closures;                  ///< 启用的道路封闭（可为空）
+
+    /**
+     * @brief 校车计算辅助结构体
+     */
+    struct BusRouteResult
+    {
+        bool valid = false;             ///< 方案是否有效
+        double totalDuration = 0;       ///< 总耗时
+        double walk1Duration = 0;       ///< 第一段步行耗时
+        double waitDuration = 0;        ///< 等车耗时
+        double rideDuration = 0;        ///< 乘车耗时
+        double walk2Duration = 0;       ///< 第二段步行耗时
+        int stationStartId = -1;        ///< 上车站 ID
+        int stationEndId = -1;          ///< 下车站 ID
+        QTime nextBusTime;              ///< 实际上车的班次时间
+    };
+
+    /**
+     * @brief 计算边的权重
+     *
+     * @param edge 边对象
+     * @param weightMode 权重模式
+     * @param transportMode 交通方式
+     * @param weather 天气
+     * @return double 计算出的权重值
+     */
+    double getEdgeWeight(const AdjEdge& edge, WeightMode weightMode,
+                         TransportMode transportMode, Weather weather) const;
+
+    /**
+     * @brief 获取实际速度
+     *
+     * @param mode 交通方式
+     * @param weather 天气
+     * @return double 速度值
+     */
+    double getRealSpeed(TransportMode mode, Weather weather) const;
+
+    /**
+     * @brief 判断是否迟到
+     *
+     * @param durationSeconds 行程耗时（秒）
+     * @param current 当前时间
+     * @param target 目标时间
+     * @return bool 如果迟到返回 true
+     */
+    bool isLate(double durationSeconds, QTime current, QTime target) const;
+
+    /**
+     * @brief Dijkstra 主体，结果留在 ctx 的距离表、前驱表里
+     *
+     * @param source 起点稠密下标
+     * @param target 终点稠密下标，搜到即停
+     * @return bool 终点是否可达
+     */
+    bool search(QueryContext& ctx, int source, int target, TransportMode mode, Weather weather,
+                WeightMode weightMode, QSet<int>* wantedRegions) const;
+
+    /**
+     * @brief 寻路并把路径（节点 ID）追加到 out 末尾
+     * @return bool 不可达时返回 false，out 不变
+     */
+    bool appendPath(QueryContext& ctx, int startId, int endId, TransportMode mode, Weather weather,
+                    WeightMode weightMode, QSet<int>* wantedRegions, QueryContext::Path& out) const;
+
+    /**
+     * @brief 路径总耗时 / 总距离（calculateDuration / calculateDistance 的实现）
+     */
+    double durationOf(const int* ids, qsizetype count, TransportMode mode, Weather weather) const;
+    double distanceOf(const int* ids, qsizetype count) const;
+
+    /**
+     * @brief 计算最优校车方案
+     *
+     * @param fullPath 输出完整路径 (步行1 + 乘车 + 步行2)
+     */
+    BusRouteResult calculateBestBusRoute(QueryContext& ctx, int startId, int endId, QTime currentTime,
+                                         Weather weather, QSet<int>* wantedRegions,
+                                         QueryContext::Path& fullPath) const;
+
+    /**
+     * @brief 获取下一班车时间
+     *
+     * @param stationId 车站 ID
+     * @param arrivalTime 到达车站的时间
+     * @param weather 天气（可能导致延误）
+     * @return QTime 下一班车的时间
+     */
+    QTime getNextBusTime(int stationId, QTime arrivalTime, Weather weather) const;
+
+    /**
+     * @brief 寻找多阶段路径（支持途经点）
+     *
+     * @param out 输出完整路径（先清空）
+     * @return bool 任一段不可达时返回 false
+     */
+    bool findMultiStagePath(QueryContext& ctx, int startId, int endId, const QVector<int>& waypoints,
+                            TransportMode mode, Weather weather, WeightMode weightMode,
+                            QSet<int>* wantedRegions, QueryContext::Path& out) const;
+};
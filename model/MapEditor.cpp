@@ -1,9 +1,10 @@
 ﻿// ============================================================
 // MapEditor.cpp - 地图编辑器的核心逻辑
-// 负责创建新节点、追加数据到文件
+// 负责创建新节点、追加数据到草稿文件
 // ============================================================
 
 #include "MapEditor.h"
+#include "GraphModel.h"
 
 #include <QFile>
 #include <QTextStream>
@@ -20,8 +21,29 @@ MapEditor::MapEditor(QObject* parent)
     : QObject(parent),
       m_buildingIdCounter(100),      // 建筑ID从100开始
       m_roadIdCounter(10000),        // 路口ID从10000开始
-      m_lastConnectedId(-1)          // -1表示还没有上一个连接点
+      m_lastConnectedId(-1),         // -1表示还没有上一个连接点
+      m_nodesDraftPath(QStringLiteral("nodes_draft.txt")),
+      m_edgesDraftPath(QStringLiteral("edges_draft.txt")),
+      m_bufferedLines(0)
 {
+    // 缓冲里的数据最多停留 kFlushIntervalMs 就写出
+    m_flushTimer.setSingleShot(true);
+    connect(&m_flushTimer, &QTimer::timeout, this, &MapEditor::flushDraft);
+}
+
+MapEditor::~MapEditor()
+{
+    closeDraft();
+}
+
+// ============================================================
+// 设置草稿文件路径
+// ============================================================
+void MapEditor::setDraftPaths(const QString& nodesDraftPath, const QString& edgesDraftPath)
+{
+    closeDraft();
+    m_nodesDraftPath = nodesDraftPath;
+    m_edgesDraftPath = edgesDraftPath;
 }
 
 // ============================================================
@@ -70,6 +92,101 @@ void MapEditor::handleMapClick(QPointF scenePos, bool isCtrlPressed)
 void MapEditor::resetConnection()
 {
     m_lastConnectedId = -1;
+
+    // 一段路画完了，把这段的数据落盘
+    flushDraft();
+}
+
+// ============================================================
+// 写出草稿缓冲
+// 文件在会话期间保持打开，每次只需要一次 write + flush
+// ============================================================
+bool MapEditor::flushDraft()
+{
+    m_flushTimer.stop();
+
+    if (m_bufferedLines == 0)
+    {
+        return true;
+    }
+
+    bool ok = true;
+    if (!m_nodesBuffer.isEmpty())
+    {
+        if (openDraftFile(m_nodesDraftFile, m_nodesDraftPath))
+        {
+            m_nodesDraftFile.write(m_nodesBuffer);
+            m_nodesDraftFile.flush();
+            m_nodesBuffer.clear();
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+    if (!m_edgesBuffer.isEmpty())
+    {
+        if (openDraftFile(m_edgesDraftFile, m_edgesDraftPath))
+        {
+            m_edgesDraftFile.write(m_edgesBuffer);
+            m_edgesDraftFile.flush();
+            m_edgesBuffer.clear();
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+
+    // 写失败的数据留在缓冲里，下次再试
+    if (ok)
+    {
+        m_bufferedLines = 0;
+    }
+    return ok;
+}
+
+bool MapEditor::openDraftFile(QFile& file, const QString& path)
+{
+    if (file.isOpen())
+    {
+        return true;
+    }
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::Append | QIODevice::Text))
+    {
+        qWarning() << "无法打开草稿文件" << path;
+        return false;
+    }
+    return true;
+}
+
+void MapEditor::closeDraft()
+{
+    flushDraft();
+    m_nodesDraftFile.close();
+    m_edgesDraftFile.close();
+}
+
+// ============================================================
+// 把草稿会话整批导入图模型
+// ============================================================
+int MapEditor::importDraftInto(GraphModel* model)
+{
+    if (model == nullptr)
+    {
+        return -1;
+    }
+
+    if (!flushDraft())
+    {
+        return -1;
+    }
+
+    // 导入成功后草稿会被改名：先关闭，之后的新数据写进新的草稿文件
+    closeDraft();
+    return model->importDraft(m_nodesDraftPath, m_edgesDraftPath);
 }
 
 // ============================================================
@@ -147,8 +264,8 @@ int MapEditor::createNode(
 }
 
 // ============================================================
-// 追加节点到文件
-// 把节点信息写入 nodes_draft.txt 文件
+// 追加节点到草稿缓冲
+// 格式与 nodes_draft.txt 一致，攒够一批或定时器到期才写文件
 // ============================================================
 void MapEditor::appendNode(
     int id,
@@ -161,19 +278,8 @@ void MapEditor::appendNode(
     // 默认高度设为30米
     const double z = 30.0;
 
-    // 打开文件（追加模式）
-    QFile file(QStringLiteral("nodes_draft.txt"));
-    bool opened = file.open(QIODevice::Append | QIODevice::Text);
-    
-    if (!opened)
-    {
-        qWarning() << "无法打开 nodes_draft.txt 文件";
-        return;
-    }
-
-    // 把节点信息写入文件
     // 格式: id, name, x, y, z, type, description, category
-    QTextStream out(&file);
+    QTextStream out(&m_nodesBuffer, QIODevice::WriteOnly | QIODevice::Append);
     out.setEncoding(QStringConverter::Utf8);
     
     out << id << ", "
@@ -184,13 +290,13 @@ void MapEditor::appendNode(
         << type << ", "
         << desc << ", "
         << category << "\n";
+    out.flush();
 
-    file.close();
+    onLineBuffered();
 }
 
 // ============================================================
-// 追加边到文件
-// 把道路信息写入 edges_draft.txt 文件
+// 追加边到草稿缓冲
 // ============================================================
 void MapEditor::appendEdge(
     int u,
@@ -201,16 +307,6 @@ void MapEditor::appendEdge(
     const QString& name,
     const QString& desc)
 {
-    // 打开文件（追加模式）
-    QFile file(QStringLiteral("edges_draft.txt"));
-    bool opened = file.open(QIODevice::Append | QIODevice::Text);
-    
-    if (!opened)
-    {
-        qWarning() << "无法打开 edges_draft.txt 文件";
-        return;
-    }
-
     // 处理空描述
     QString description = desc;
     if (description.isEmpty())
@@ -218,9 +314,8 @@ void MapEditor::appendEdge(
         description = QStringLiteral("无");
     }
 
-    // 把边信息写入文件
     // 格式: u, v, distance, type, isSlope, name, description
-    QTextStream out(&file);
+    QTextStream out(&m_edgesBuffer, QIODevice::WriteOnly | QIODevice::Append);
     out.setEncoding(QStringConverter::Utf8);
     
     out << u << ", "
@@ -230,7 +325,24 @@ void MapEditor::appendEdge(
         << isSlope << ", "
         << name << ", "
         << description << "\n";
+    out.flush();
 
-    file.close();
+    onLineBuffered();
 }
 
+// ============================================================
+// 缓冲新增一行后：攒够一批立即写，否则确保定时器在跑
+// ============================================================
+void MapEditor::onLineBuffered()
+{
+    m_bufferedLines++;
+
+    if (m_bufferedLines >= kFlushLines)
+    {
+        flushDraft();
+    }
+    else if (!m_flushTimer.isActive())
+    {
+        m_flushTimer.start(kFlushIntervalMs);
+    }
+}
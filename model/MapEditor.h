@@ -2,12 +2,20 @@
 
 #include <QObject>
 #include <QPointF>
+#include <QFile>
+#include <QTimer>
+#include <QByteArray>
+
+class GraphModel;
 
 /**
  * @brief 地图编辑器辅助类
  * 
  * 用于处理地图编辑操作，如点击地图创建节点、自动连接边等。
  * 生成的数据会追加到草稿文件中。
+ * 
+ * 草稿文件在一次编辑会话中保持打开，新数据先进入内存缓冲，
+ * 攒够一批、定时器到期或 resetConnection() 时才写入文件。
  */
 class MapEditor : public QObject
 {
@@ -20,6 +28,23 @@ public:
      */
     explicit MapEditor(QObject* parent = nullptr);
 
+    /**
+     * @brief 析构函数
+     * 
+     * 写出缓冲中的草稿并关闭文件。
+     */
+    ~MapEditor() override;
+
+    /**
+     * @brief 设置草稿文件路径
+     * 
+     * 会先写出并关闭当前的草稿文件。
+     * 
+     * @param nodesDraftPath 节点草稿路径 (默认 nodes_draft.txt)
+     * @param edgesDraftPath 道路草稿路径 (默认 edges_draft.txt)
+     */
+    void setDraftPaths(const QString& nodesDraftPath, const QString& edgesDraftPath);
+
     /**
      * @brief 处理地图点击事件
      * 
@@ -60,23 +85,69 @@ public:
      * @brief 重置连接状态
      * 
      * 清除上一个连接节点的记录，开始新的路径段。
+     * 一段路画完时顺便把缓冲写入草稿文件。
      */
     void resetConnection();
 
+    /**
+     * @brief 把缓冲中的草稿写入文件
+     * 
+     * @return bool 如果写入成功返回 true
+     */
+    bool flushDraft();
+
+    /**
+     * @brief 把本次草稿会话整批导入图模型
+     * 
+     * 先写出缓冲并关闭草稿，再调用 GraphModel::importDraft()；
+     * 导入成功后草稿被改名，之后的编辑写进新的草稿文件。
+     * 
+     * @param model 目标图模型
+     * @return int 导入的节点数量，失败返回 -1
+     */
+    int importDraftInto(GraphModel* model);
+
 private:
     int m_buildingIdCounter;   ///< 建筑 ID 计数器 (从 100 开始)
     int m_roadIdCounter;       ///< 道路 ID 计数器 (从 10000 开始)
     int m_lastConnectedId;     ///< 上一个连接的节点 ID (用于连续画路)
 
+    QString m_nodesDraftPath;  ///< 节点草稿路径
+    QString m_edgesDraftPath;  ///< 道路草稿路径
+    QFile m_nodesDraftFile;    ///< 会话期间保持打开的节点草稿
+    QFile m_edgesDraftFile;    ///< 会话期间保持打开的道路草稿
+    QByteArray m_nodesBuffer;  ///< 尚未写入的节点行
+    QByteArray m_edgesBuffer;  ///< 尚未写入的道路行
+    int m_bufferedLines;       ///< 缓冲中的行数
+    QTimer m_flushTimer;       ///< 定时写出缓冲
+
+    static const int kFlushLines = 64;        ///< 攒够多少行立即写出
+    static const int kFlushIntervalMs = 2000; ///< 缓冲最长停留时间
+
+    /**
+     * @brief 以追加模式打开草稿文件（已打开则直接返回）
+     */
+    bool openDraftFile(QFile& file, const QString& path);
+
+    /**
+     * @brief 写出缓冲并关闭草稿文件
+     */
+    void closeDraft();
+
+    /**
+     * @brief 缓冲新增一行后决定立即写出还是等定时器
+     */
+    void onLineBuffered();
+
     /**
-     * @brief 追加节点数据到文件
+     * @brief 追加节点数据到草稿缓冲
      */
     void appendNode(int id, const QString& name, const QPointF& pos,
                     int type, const QString& desc = QStringLiteral("无"),
                     const QString& category = QStringLiteral("None"));
 
     /**
-     * @brief 追加边数据到文件
+     * @brief 追加边数据到草稿缓冲
      */
     void appendEdge(int u, int v, double distance = 0.0, int type = 0,
                     const QString& isSlope = QStringLiteral("false"),
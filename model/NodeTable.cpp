@@ -0,0 +1,202 @@
+// ============================================================
+// NodeTable.cpp - 稠密下标的节点表
+// ============================================================
+
+#include "NodeTable.h"
+#include <algorithm>
+#include <limits>
+
+const Node* NodeTable::at(int dense) const
+{
+    if (dense < 0 || dense >= m_slots.size() || !m_used[dense])
+    {
+        return nullptr;
+    }
+    return &m_slots[dense];
+}
+
+const Node* NodeTable::find(int id) const
+{
+    auto it = m_dense.constFind(id);
+    if (it == m_dense.cend())
+    {
+        return nullptr;
+    }
+    return &m_slots[it.value()];
+}
+
+Node* NodeTable::find(int id)
+{
+    auto it = m_dense.constFind(id);
+    if (it == m_dense.cend())
+    {
+        return nullptr;
+    }
+    return &m_slots[it.value()];
+}
+
+Node NodeTable::value(int id) const
+{
+    const Node* node = find(id);
+    return node ? *node : Node();
+}
+
+// ============================================================
+// 插入：已有的原位覆盖，新节点优先占用空位
+// ============================================================
+int NodeTable::insert(const Node& node)
+{
+    auto it = m_dense.constFind(node.id);
+    if (it != m_dense.cend())
+    {
+        m_slots[it.value()] = node;
+        return it.value();
+    }
+
+    int dense;
+    if (!m_free.isEmpty())
+    {
+        dense = m_free.takeLast();
+        m_slots[dense] = node;
+        m_used[dense] = true;
+    }
+    else
+    {
+        dense = m_slots.size();
+        m_slots.append(node);
+        m_used.append(true);
+    }
+    m_dense.insert(node.id, dense);
+    return dense;
+}
+
+int NodeTable::remove(int id)
+{
+    auto it = m_dense.find(id);
+    if (it == m_dense.end())
+    {
+        return -1;
+    }
+
+    int dense = it.value();
+    m_dense.erase(it);
+    m_slots[dense] = Node();    // 释放名称、描述的缓冲区
+    m_used[dense] = false;
+    m_free.append(dense);
+    return dense;
+}
+
+void NodeTable::clear()
+{
+    m_slots.clear();
+    m_used.clear();
+    m_free.clear();
+    m_dense.clear();
+}
+
+// ============================================================
+// 局部性重排
+// 坐标按包围盒量化到 2^16 x 2^16 网格，按 Hilbert 曲线上的位置排序；
+// 同一位置按 ID 排，结果只取决于地图内容，与编辑历史无关
+// ============================================================
+static quint64 hilbertIndex(quint32 x, quint32 y)
+{
+    const quint32 n = 1u << 16;
+    quint64 d = 0;
+    for (quint32 s = n / 2; s > 0; s /= 2)
+    {
+        quint32 rx = (x & s) ? 1 : 0;
+        quint32 ry = (y & s) ? 1 : 0;
+        d += static_cast<quint64>(s) * s * ((3 * rx) ^ ry);
+
+        // 旋转象限，让子曲线首尾相接
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+void NodeTable::sortByLocation()
+{
+    if (isEmpty())
+    {
+        return;
+    }
+
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+    for (const Node& n : *this)
+    {
+        minX = std::min(minX, n.x);
+        minY = std::min(minY, n.y);
+        maxX = std::max(maxX, n.x);
+        maxY = std::max(maxY, n.y);
+    }
+    const double span = std::max({maxX - minX, maxY - minY, 1e-9});
+    const double scale = 65535.0 / span;
+
+    struct Key
+    {
+        quint64 curve;
+        int id;
+        int dense;
+    };
+    QVector<Key> keys;
+    keys.reserve(size());
+    for (auto it = begin(); it != end(); ++it)
+    {
+        quint32 qx = static_cast<quint32>((it->x - minX) * scale);
+        quint32 qy = static_cast<quint32>((it->y - minY) * scale);
+        keys.append({hilbertIndex(qx, qy), it->id, it.dense()});
+    }
+    std::sort(keys.begin(), keys.end(), [](const Key& a, const Key& b) {
+        return a.curve != b.curve ? a.curve < b.curve : a.id < b.id;
+    });
+
+    // 只读旧数组（可能与快照共享），新数组整体替换
+    QVector<Node> slots;
+    slots.reserve(keys.size());
+    QHash<int, int> dense;
+    dense.reserve(keys.size());
+    for (const Key& k : keys)
+    {
+        dense.insert(k.id, slots.size());
+        slots.append(m_slots.at(k.dense));
+    }
+
+    m_slots = slots;
+    m_used = QVector<bool>(slots.size(), true);
+    m_free.clear();
+    m_dense = dense;
+}
+
+// ============================================================
+// 按 ID 有序的视图
+// ============================================================
+QList<int> NodeTable::keys() const
+{
+    QList<int> ids = m_dense.keys();
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+QVector<Node> NodeTable::values() const
+{
+    QVector<Node> nodes;
+    nodes.reserve(size());
+    for (const Node& n : *this)
+    {
+        nodes.append(n);
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const Node& a, const Node& b) { return a.id < b.id; });
+    return nodes;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "../GraphData.h"
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+/**
+ * @brief 节点表：稠密下标 + 连续存储
+ *
+ * 节点 ID 由文件和编辑器分配，稀疏且不连续（建筑从 100、路口从 10000 起）。
+ * 表内为每个节点分配一个稠密下标，节点按下标连续存放在数组里：
+ * - ID -> 下标 只查一次哈希表，O(1)；
+ * - 寻路等内部算法直接用下标索引数组（距离表、前驱表、邻接表），不再查表；
+ * - 删除节点留下空位，下次新增时复用，下标在节点存在期间保持不变（整体重排 sortByLocation 除外）。
+ *
+ * 稀疏 ID 只出现在对外接口上。各容器都是隐式共享的，拷贝（生成快照、后台保存）只增加引用计数。
+ * 遍历顺序是下标顺序而不是 ID 顺序，需要按 ID 有序时用 keys() / values()。
+ */
+class NodeTable
+{
+public:
+    /**
+     * @brief 按下标顺序遍历存在的节点（跳过空位）
+     */
+    class const_iterator
+    {
+    public:
+        const_iterator(const NodeTable* table, int dense) : m_table(table), m_dense(dense) { skipFree(); }
+        const Node& operator*() const { return m_table->m_slots[m_dense]; }
+        const Node* operator->() const { return &m_table->m_slots[m_dense]; }
+        const_iterator& operator++() { ++m_dense; skipFree(); return *this; }
+        bool operator==(const const_iterator& other) const { return m_dense == other.m_dense; }
+        bool operator!=(const const_iterator& other) const { return m_dense != other.m_dense; }
+
+        /**
+         * @brief 当前节点的稠密下标
+         */
+        int dense() const { return m_dense; }
+
+    private:
+        const NodeTable* m_table;
+        int m_dense;
+
+        void skipFree()
+        {
+            while (m_dense < m_table->m_used.size() && !m_table->m_used[m_dense])
+            {
+                ++m_dense;
+            }
+        }
+    };
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_slots.size()); }
+
+    /**
+     * @brief 节点个数
+     */
+    int size() const { return m_dense.size(); }
+    bool isEmpty() const { return m_dense.isEmpty(); }
+
+    /**
+     * @brief 下标空间大小（含空位），按下标索引的数组开这么大即可
+     */
+    int slotCount() const { return m_slots.size(); }
+
+    bool contains(int id) const { return m_dense.contains(id); }
+
+    /**
+     * @brief 节点 ID -> 稠密下标
+     * @return int 不存在时返回 -1
+     */
+    int denseOf(int id) const { return m_dense.value(id, -1); }
+
+    /**
+     * @brief 稠密下标 -> 节点 ID（下标必须是存在的节点）
+     */
+    int idAt(int dense) const { return m_slots[dense].id; }
+
+    /**
+     * @brief 按下标取节点
+     * @return const Node* 空位返回 nullptr
+     */
+    const Node* at(int dense) const;
+
+    /**
+     * @brief 按 ID 取节点
+     * @return Node* 不存在时返回 nullptr；下次增删节点前有效
+     */
+    const Node* find(int id) const;
+    Node* find(int id);
+
+    /**
+     * @brief 按 ID 取节点的副本（不存在时为默认值）
+     */
+    Node value(int id) const;
+
+    /**
+     * @brief 插入节点，ID 已存在时原位覆盖
+     * @return int 节点的稠密下标
+     */
+    int insert(const Node& node);
+
+    /**
+     * @brief 删除节点，空出的下标留给之后新增的节点
+     * @return int 空出的下标，节点不存在时返回 -1
+     */
+    int remove(int id);
+
+    void clear();
+
+    /**
+     * @brief 按坐标沿 Hilbert 曲线重排稠密下标，顺带收掉空位
+     *
+     * 寻路时按下标访问距离表、前驱表和邻接表；地理上相邻的节点下标也相近，
+     * 一次搜索扩展出去的邻居大多落在同一批缓存行里。
+     * 节点 ID 不变，之前取得的下标全部失效（按下标索引的数组要重建）。
+     */
+    void sortByLocation();
+
+    /**
+     * @brief 全部节点 ID（升序）
+     */
+    QList<int> keys() const;
+
+    /**
+     * @brief 全部节点（按 ID 升序，用于保存文件等需要稳定顺序的场合）
+     */
+    QVector<Node> values() const;
+
+private:
+    QVector<Node> m_slots;          ///< 稠密下标 -> 节点（空位内容无意义）
+    QVector<bool> m_used;           ///< 稠密下标是否有节点
+    QVector<int> m_free;            ///< 空位下标
+    QHash<int, int> m_dense;        ///< 节点 ID -> 稠密下标
+};
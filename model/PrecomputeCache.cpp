@@ -0,0 +1,244 @@
+// ============================================================
+// PrecomputeCache.cpp - 预计算结果的持久化缓存
+// 界面线程只负责"取快照"和"装上结果"，哈希、加载、预计算、写缓存都在后台线程
+// ============================================================
+
+#include "PrecomputeCache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+/// 预计算内容或缓存格式变化时递增，旧缓存自然失效
+static const char* kCacheFormat = "rides-v1";
+
+PrecomputeCache::PrecomputeCache(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &PrecomputeCache::onTimeout);
+    connect(&m_watcher, &QFutureWatcher<Result>::finished, this, &PrecomputeCache::onPrepareFinished);
+}
+
+PrecomputeCache::~PrecomputeCache()
+{
+    m_timer.stop();
+    waitForIdle();
+}
+
+// ============================================================
+// 请求重新准备（合并）
+// 从第一次请求开始计时，连续的请求不会把准备无限推迟
+// ============================================================
+void PrecomputeCache::requestRebuild()
+{
+    if (m_cacheDir.isEmpty())
+    {
+        return;
+    }
+    if (m_inFlight)
+    {
+        m_rerun = true;
+        return;
+    }
+    if (!m_timer.isActive())
+    {
+        m_timer.start(m_delayMs);
+    }
+}
+
+void PrecomputeCache::onTimeout()
+{
+    if (m_inFlight)
+    {
+        m_rerun = true;
+        return;
+    }
+    startPrepare();
+}
+
+void PrecomputeCache::startPrepare()
+{
+    if (!m_provider || m_cacheDir.isEmpty())
+    {
+        return;
+    }
+
+    GraphSnapshotPtr snapshot = m_provider();
+    m_inFlight = true;
+    m_rerun = false;
+    m_watcher.setFuture(QtConcurrent::run(&PrecomputeCache::prepare, snapshot, m_cacheDir, m_lastDigest, m_lastMatrix));
+}
+
+void PrecomputeCache::onPrepareFinished()
+{
+    // waitForIdle() 可能已经处理过这次结果
+    if (!m_inFlight)
+    {
+        return;
+    }
+    m_inFlight = false;
+
+    Result result = m_watcher.result();
+    if (result.matrix)
+    {
+        m_lastMatrix = result.matrix;
+        m_lastDigest = result.digest;
+        if (m_installer)
+        {
+            m_installer(result.matrix, result.version);
+        }
+    }
+    emit prepared(result.fromDisk, result.elapsedMs);
+
+    if (m_rerun)
+    {
+        m_rerun = false;
+        requestRebuild();
+    }
+}
+
+void PrecomputeCache::waitForIdle()
+{
+    if (!m_inFlight)
+    {
+        return;
+    }
+    m_watcher.waitForFinished();
+    m_inFlight = false;
+    m_rerun = false;
+}
+
+// ============================================================
+// 内容哈希
+// 只取寻路用到的数据：车站 ID（排序后），道路按端点对排序后的量化寻路字段，时刻表。
+// 节点的名称、描述、坐标不参与，改名不会让乘车矩阵失效
+// ============================================================
+QByteArray PrecomputeCache::contentHash(const GraphSnapshot& snapshot)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray(kCacheFormat));
+
+    // ---- Config 常量（速度、坡度阈值等影响权重）----
+    const double constants[] = {
+        Config::SPEED_WALK, Config::SPEED_RUN, Config::SPEED_SHARED_BIKE, Config::SPEED_EBIKE,
+        Config::SPEED_BUS, Config::TIME_FIND_BIKE, Config::TIME_PARK_BIKE, Config::SLOPE_THRESHOLD
+    };
+    for (double c : constants)
+    {
+        hash.addData(QByteArray::number(c, 'g', 17));
+        hash.addData(QByteArray(";"));
+    }
+
+    // ---- 车站（按 ID 排序，与节点表的存放顺序无关）----
+    QVector<int> stations;
+    for (const Node& n : snapshot.nodes())
+    {
+        if (n.category == NodeCategory::BusStation)
+        {
+            stations.append(n.id);
+        }
+    }
+    std::sort(stations.begin(), stations.end());
+    QByteArray stationLine = "stations";
+    for (int id : stations)
+    {
+        stationLine += ',' + QByteArray::number(id);
+    }
+    hash.addData(stationLine + '\n');
+
+    // ---- 道路：每条只取 u < v 的那一份，按端点排序，取量化后的寻路字段（名称、描述不影响寻路）----
+    QVector<const AdjEdge*> edges;
+    for (const QVector<AdjEdge>& list : snapshot.adjacency())
+    {
+        for (const AdjEdge& e : list)
+        {
+            if (e.u < e.v)
+            {
+                edges.append(&e);
+            }
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const AdjEdge* a, const AdjEdge* b) {
+        return a->u != b->u ? a->u < b->u : a->v < b->v;
+    });
+    for (const AdjEdge* e : edges)
+    {
+        QString line = QString("%1,%2,%3,%4,%5,%6\n").arg(e->u).arg(e->v).arg(e->distanceCm)
+                           .arg(static_cast<int>(e->type)).arg(e->slopePermille).arg(e->steep ? 1 : 0);
+        hash.addData(line.toUtf8());
+    }
+
+    // ---- 时刻表 ----
+    for (auto it = snapshot.schedules().cbegin(); it != snapshot.schedules().cend(); ++it)
+    {
+        QByteArray line = QByteArray::number(it.key());
+        for (const QTime& t : it.value())
+        {
+            line += ',' + t.toString("HH:mm").toLatin1();
+        }
+        hash.addData(line + '\n');
+    }
+
+    return hash.result();
+}
+
+// ============================================================
+// 后台线程：寻路相关内容没变则沿用上次的结果，
+// 否则命中缓存时内存映射加载，再否则预计算并写入缓存
+// ============================================================
+PrecomputeCache::Result PrecomputeCache::prepare(const GraphSnapshotPtr& snapshot, const QString& cacheDir,
+                                                 const QByteArray& lastDigest, const RideMatrixPtr& lastMatrix)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    Result result;
+    result.version = snapshot->version();
+
+    QByteArray digest = contentHash(*snapshot);
+    result.digest = digest;
+    if (lastMatrix && digest == lastDigest)
+    {
+        result.matrix = lastMatrix;
+        result.elapsedMs = timer.elapsed();
+        qDebug() << "预计算缓存 沿用: 寻路相关内容未变, 耗时" << result.elapsedMs << "ms";
+        return result;
+    }
+
+    QDir dir(cacheDir);
+    QString fileName = QString("%1-%2.bin").arg(QString::fromLatin1(kCacheFormat), QString::fromLatin1(digest.toHex()));
+    QString path = dir.filePath(fileName);
+
+    result.matrix = StationRideMatrix::load(path, digest);
+    if (result.matrix)
+    {
+        result.fromDisk = true;
+    }
+    else
+    {
+        result.matrix = StationRideMatrix::build(*snapshot, digest);
+        if (result.matrix && dir.mkpath("."))
+        {
+            // 同一格式只保留当前地图的缓存
+            const QStringList stale = dir.entryList({QString("%1-*.bin").arg(QString::fromLatin1(kCacheFormat))}, QDir::Files);
+            for (const QString& old : stale)
+            {
+                if (old != fileName)
+                {
+                    dir.remove(old);
+                }
+            }
+            result.matrix->save(path);
+        }
+    }
+
+    result.elapsedMs = timer.elapsed();
+    qDebug() << "预计算缓存" << (result.fromDisk ? "命中" : "重建") << ": 车站数="
+             << (result.matrix ? result.matrix->stations().size() : 0) << " 耗时" << result.elapsedMs << "ms";
+    return result;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "GraphSnapshot.h"
+#include "StationRideMatrix.h"
+#include <QObject>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QByteArray>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief 寻路预计算结果的持久化缓存
+ *
+ * 预计算结果（目前是校车乘车矩阵）保存在缓存目录（Data 的同级目录 cache/）下，
+ * 文件名带地图内容哈希，只覆盖影响寻路的数据：车站、道路的寻路字段、时刻表以及 Config 中的常量。
+ * 改名称、描述、坐标等不影响哈希。
+ *
+ * 准备过程全部在后台线程：先算哈希，与上次相同则沿用内存中的结果（只换版本号），
+ * 否则命中磁盘缓存时内存映射加载，再否则重新预计算并写入缓存。
+ * 界面线程从不等待，结果就绪前寻路照常逐对计算，首次出路线的时间与预计算多重无关。
+ */
+class PrecomputeCache : public QObject
+{
+    Q_OBJECT
+public:
+    /// 取快照的回调：在界面线程、真正开始准备的那一刻调用
+    using SnapshotProvider = std::function<GraphSnapshotPtr()>;
+
+    /// 结果就绪后在界面线程调用；version 为所用快照的版本号
+    using Installer = std::function<void(const RideMatrixPtr& matrix, quint64 version)>;
+
+    explicit PrecomputeCache(QObject* parent = nullptr);
+    ~PrecomputeCache() override;
+
+    void setSnapshotProvider(SnapshotProvider provider) { m_provider = std::move(provider); }
+    void setInstaller(Installer installer) { m_installer = std::move(installer); }
+
+    /**
+     * @brief 设置缓存目录（为空表示不启用）
+     */
+    void setCacheDirectory(const QString& dir) { m_cacheDir = dir; }
+    QString cacheDirectory() const { return m_cacheDir; }
+
+    /**
+     * @brief 请求重新准备
+     *
+     * 从第一次请求起延迟 delayMs 开始，期间的请求合并为一次；
+     * 准备进行中到来的请求在完成后再做一次。
+     */
+    void requestRebuild();
+
+    /**
+     * @brief 设置合并请求的延迟（毫秒）
+     */
+    void setDelay(int delayMs) { m_delayMs = delayMs; }
+
+    /**
+     * @brief 等待正在进行的准备结束（退出时调用）
+     */
+    void waitForIdle();
+
+    /**
+     * @brief 快照中寻路相关内容的哈希（SHA-1）
+     *
+     * 按规范顺序序列化车站 ID、道路的量化寻路字段、时刻表和 Config 常量后计算，
+     * 与文件中的行顺序、编辑日志是否已压缩、节点的名称和坐标无关。
+     */
+    static QByteArray contentHash(const GraphSnapshot& snapshot);
+
+signals:
+    /**
+     * @brief 一次准备完成
+     * @param fromDisk 是否命中磁盘缓存（沿用内存中的结果时为 false）
+     * @param elapsedMs 后台耗时
+     */
+    void prepared(bool fromDisk, qint64 elapsedMs);
+
+private slots:
+    void onTimeout();
+    void onPrepareFinished();
+
+private:
+    /// 后台准备的结果
+    struct Result
+    {
+        RideMatrixPtr matrix;
+        QByteArray digest;
+        quint64 version = 0;
+        bool fromDisk = false;
+        qint64 elapsedMs = 0;
+    };
+
+    SnapshotProvider m_provider;
+    Installer m_installer;
+    QString m_cacheDir;
+    QTimer m_timer;
+    QFutureWatcher<Result> m_watcher;
+    int m_delayMs = 300;
+    bool m_inFlight = false;
+    bool m_rerun = false;           ///< 准备期间又有请求
+    RideMatrixPtr m_lastMatrix;     ///< 上次装上的结果
+    QByteArray m_lastDigest;        ///< 上次结果对应的内容哈希
+
+    void startPrepare();
+    static Result prepare(const GraphSnapshotPtr& snapshot, const QString& cacheDir,
+                          const QByteArray& lastDigest, const RideMatrixPtr& lastMatrix);
+};
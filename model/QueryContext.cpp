@@ -0,0 +1,81 @@
+// ============================================================
+// QueryContext.cpp - 寻路请求的临时内存
+// ============================================================
+
+#include "QueryContext.h"
+
+namespace {
+constexpr std::size_t kInitialArenaBytes = 64 * 1024;
+}
+
+QueryContext::QueryContext()
+    : m_buffer(kInitialArenaBytes, &m_persistent)
+    , m_dist(&m_persistent)
+    , m_parent(&m_persistent)
+    , m_touched(&m_persistent)
+    , m_heap(&m_persistent)
+    , m_frontier(&m_persistent)
+{
+    m_arena.emplace(m_buffer.data(), m_buffer.size(), &m_overflow);
+}
+
+QueryContext& QueryContext::forThread()
+{
+    thread_local QueryContext ctx;
+    return ctx;
+}
+
+// ============================================================
+// 结束请求
+// 单调 arena 只在 release 时整体回收；本次用到了全局堆，
+// 说明初始缓冲区偏小，扩到本次用量的两倍，之后同样规模的请求不再溢出
+// ============================================================
+void QueryContext::endRequest()
+{
+    m_arena->release();
+    if (m_overflow.bytes() == 0)
+    {
+        return;
+    }
+
+    std::size_t wanted = (m_buffer.size() + m_overflow.bytes()) * 2;
+    m_overflow.resetBytes();
+    m_arena.reset();
+    m_buffer.resize(wanted);
+    m_arena.emplace(m_buffer.data(), m_buffer.size(), &m_overflow);
+}
+
+// ============================================================
+// 开始一次搜索
+// 只恢复上次搜索碰过的项，代价与搜索范围成正比，而不是与地图大小成正比
+// ============================================================
+void QueryContext::prepareSearch(int slotCount)
+{
+    for (int slot : m_touched)
+    {
+        m_dist[slot] = kInf;
+        m_parent[slot] = -1;
+    }
+    m_touched.clear();
+
+    if (m_dist.size() < std::size_t(slotCount))
+    {
+        m_dist.resize(slotCount, kInf);
+        m_parent.resize(slotCount, -1);
+        m_touched.reserve(slotCount);
+    }
+    m_heap.clear();
+    m_frontier.clear();
+}
+
+void* QueryContext::CountingResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    ++m_count;
+    m_bytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void QueryContext::CountingResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
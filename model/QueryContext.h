@@ -0,0 +1,147 @@
+#pragma once
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 一次寻路请求的临时内存（查询上下文）
+ *
+ * 一次 getMultiStrategyRoutes 要跑好几次 Dijkstra（校车模式是车站数的平方次），
+ * 每次都要距离表、前驱表、优先队列，还有各段路径、目标列表等临时数组，用完即弃。
+ * 这些内存都从查询上下文里取，稳定后一次请求不再向全局堆要临时内存：
+ * - 距离表、前驱表按节点下标开满，跨请求复用；每次搜索只把上次改过的项恢复初值；
+ * - 优先队列、未加载分区边界 clear() 后保留容量；
+ * - 路径等大小不定的数组分配在单调 arena 上，请求结束时整体释放。
+ *   arena 的初始缓冲区不够时向全局堆要，请求结束后把初始缓冲区扩到够用。
+ *
+ * 向全局堆要内存的次数都计入 heapAllocations()，用于验证稳定状态下的查询不分配。
+ * 每个线程一个（forThread），不能跨线程共享；只供 GraphSnapshot 的寻路使用。
+ */
+class QueryContext
+{
+public:
+    /// 请求内的临时路径（节点 ID），分配在 arena 上
+    using Path = std::pmr::vector<int>;
+
+    QueryContext();
+    QueryContext(const QueryContext&) = delete;
+    QueryContext& operator=(const QueryContext&) = delete;
+
+    /**
+     * @brief 当前线程的查询上下文
+     *
+     * 后台寻路跑在 QtConcurrent 的线程池上，线程常驻，上下文随线程一直复用。
+     */
+    static QueryContext& forThread();
+
+    /**
+     * @brief 一次请求的范围：析构时调用 endRequest()
+     *
+     * 请求内在 arena 上构造的 Path 必须在 Scope 之后声明，先于它析构。
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(QueryContext& ctx) : m_ctx(ctx) {}
+        ~Scope() { m_ctx.endRequest(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        QueryContext& m_ctx;
+    };
+
+    /**
+     * @brief 请求内临时数组使用的内存资源
+     */
+    std::pmr::memory_resource* arena() { return &*m_arena; }
+
+    /**
+     * @brief 结束一次请求：释放 arena；本次溢出了就扩大初始缓冲区
+     */
+    void endRequest();
+
+    /**
+     * @brief 累计向全局堆要内存的次数（缓冲区扩容 + arena 溢出）
+     */
+    qint64 heapAllocations() const { return m_persistent.count() + m_overflow.count(); }
+
+    /**
+     * @brief arena 初始缓冲区大小（字节）
+     */
+    qsizetype arenaCapacity() const { return qsizetype(m_buffer.size()); }
+
+private:
+    friend class GraphSnapshot;
+
+    using HeapItem = std::pair<double, int>;    ///< (距离, 稠密下标)
+
+    /// 转发给 new/delete 并计数的内存资源
+    class CountingResource : public std::pmr::memory_resource
+    {
+    public:
+        qint64 count() const { return m_count; }
+        std::size_t bytes() const { return m_bytes; }
+        void resetBytes() { m_bytes = 0; }
+
+    private:
+        qint64 m_count = 0;         ///< 累计分配次数
+        std::size_t m_bytes = 0;    ///< 上次 resetBytes 以来分配的字节数
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    static constexpr double kInf = std::numeric_limits<double>::max();
+
+    CountingResource m_persistent;                          ///< 跨请求保留的缓冲区
+    CountingResource m_overflow;                            ///< arena 超出初始缓冲区的部分
+    std::pmr::vector<std::byte> m_buffer;                   ///< arena 初始缓冲区
+    std::optional<std::pmr::monotonic_buffer_resource> m_arena;
+
+    // ---- 单次搜索（按稠密下标）----
+    std::pmr::vector<double> m_dist;        ///< 到起点的距离，未到达为 kInf
+    std::pmr::vector<int> m_parent;         ///< 前驱下标，-1 表示无
+    std::pmr::vector<int> m_touched;        ///< 本次搜索改过的下标
+    std::pmr::vector<HeapItem> m_heap;      ///< 优先队列（小根堆）
+    std::pmr::vector<HeapItem> m_frontier;  ///< 指向未加载分区的道路：(距离, 分区下标)
+
+    /**
+     * @brief 开始一次搜索：恢复上次改过的项，距离表至少 slotCount 项
+     */
+    void prepareSearch(int slotCount);
+
+    /**
+     * @brief 更新 slot 的距离和前驱，并放入优先队列
+     */
+    void reach(int slot, double d, int from)
+    {
+        if (m_dist[slot] == kInf)
+        {
+            m_touched.push_back(slot);
+        }
+        m_dist[slot] = d;
+        m_parent[slot] = from;
+        m_heap.push_back({d, slot});
+        std::push_heap(m_heap.begin(), m_heap.end(), std::greater<>());
+    }
+
+    /**
+     * @brief 取出距离最小的一项
+     */
+    HeapItem popNearest()
+    {
+        std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<>());
+        HeapItem top = m_heap.back();
+        m_heap.pop_back();
+        return top;
+    }
+};
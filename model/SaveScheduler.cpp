@@ -0,0 +1,168 @@
+// ============================================================
+// SaveScheduler.cpp - 异步防抖保存
+// 界面线程只负责"取快照"，序列化和写盘都在后台线程完成
+// ============================================================
+
+#include "SaveScheduler.h"
+#include "GraphModel.h"
+
+#include <QFile>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+SaveScheduler::SaveScheduler(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &SaveScheduler::onTimeout);
+    connect(&m_watcher, &QFutureWatcher<WriteResult>::finished, this, &SaveScheduler::onWriteFinished);
+}
+
+SaveScheduler::~SaveScheduler()
+{
+    flush();
+}
+
+void SaveScheduler::setDebounceInterval(int windowMs, int maxWaitMs)
+{
+    m_windowMs = std::max(0, windowMs);
+    m_maxWaitMs = std::max(m_windowMs, maxWaitMs);
+}
+
+// ============================================================
+// 请求保存（防抖）
+// 每次请求都把计时器推迟一个窗口，但从这一串编辑开始算起不超过 maxWait
+// ============================================================
+void SaveScheduler::requestSave()
+{
+    m_pending++;
+
+    if (!m_burst.isValid())
+    {
+        m_burst.start();
+    }
+
+    qint64 remaining = m_maxWaitMs - m_burst.elapsed();
+    qint64 delay = std::min<qint64>(m_windowMs, std::max<qint64>(0, remaining));
+    m_timer.start(static_cast<int>(delay));
+
+    emit statsChanged();
+}
+
+void SaveScheduler::requestSaveNow()
+{
+    m_pending++;
+    m_timer.stop();
+    onTimeout();
+}
+
+void SaveScheduler::onTimeout()
+{
+    if (m_inFlight)
+    {
+        return;  // 等这次写完后在 finishWrite 里接着写
+    }
+    startWrite();
+}
+
+// ============================================================
+// 开始一次后台写盘
+// ============================================================
+void SaveScheduler::startWrite()
+{
+    if (m_pending == 0 || !m_provider)
+    {
+        return;
+    }
+
+    SaveSnapshot snapshot = m_provider();
+    m_inFlightRequests = m_pending;
+    m_pending = 0;
+    m_burst.invalidate();
+    m_inFlight = true;
+
+    m_watcher.setFuture(QtConcurrent::run(&SaveScheduler::writeSnapshot, snapshot));
+    emit statsChanged();
+}
+
+void SaveScheduler::onWriteFinished()
+{
+    // flush() 可能已经同步处理过这次结果
+    if (!m_inFlight)
+    {
+        return;
+    }
+    finishWrite(m_watcher.result());
+}
+
+void SaveScheduler::finishWrite(const WriteResult& result)
+{
+    m_inFlight = false;
+    m_inFlightRequests = 0;
+    m_lastOk = result.ok;
+    m_lastLatencyMs = result.elapsedMs;
+
+    emit saveFinished(result.ok, result.elapsedMs);
+    emit statsChanged();
+
+    // 写盘期间又有新的编辑，且防抖窗口已经过去，就接着写
+    if (m_pending > 0 && !m_timer.isActive())
+    {
+        startWrite();
+    }
+}
+
+// ============================================================
+// 立即写完所有数据（退出时调用，会阻塞）
+// ============================================================
+void SaveScheduler::flush()
+{
+    m_timer.stop();
+
+    while (m_inFlight || (m_pending > 0 && m_provider))
+    {
+        if (!m_inFlight)
+        {
+            startWrite();
+        }
+        waitForIdle();
+    }
+}
+
+void SaveScheduler::waitForIdle()
+{
+    if (!m_inFlight)
+    {
+        return;
+    }
+    m_watcher.waitForFinished();
+    finishWrite(m_watcher.result());
+}
+
+void SaveScheduler::cancelPending()
+{
+    m_timer.stop();
+    m_pending = 0;
+    m_burst.invalidate();
+    emit statsChanged();
+}
+
+// ============================================================
+// 后台线程：写临时文件并原子替换，成功后删除已被快照覆盖的封存日志
+// ============================================================
+SaveScheduler::WriteResult SaveScheduler::writeSnapshot(const SaveSnapshot& snapshot)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    WriteResult result;
+    result.ok = GraphModel::writeSnapshot(snapshot.nodes, snapshot.edges,
+                                          snapshot.nodesPath, snapshot.edgesPath);
+    if (result.ok && !snapshot.sealedJournalPath.isEmpty())
+    {
+        QFile::remove(snapshot.sealedJournalPath);
+    }
+
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
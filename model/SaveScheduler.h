@@ -0,0 +1,133 @@
+#pragma once
+
+#include "../GraphData.h"
+#include "NodeTable.h"
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QVector>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief 一次保存所需的不可变数据
+ *
+ * 节点和边都是隐式共享的拷贝，交给后台线程后界面线程的修改不会影响它。
+ */
+struct SaveSnapshot
+{
+    NodeTable nodes;                ///< 节点快照
+    QVector<Edge> edges;            ///< 边快照
+    QString nodesPath;              ///< 节点文件路径
+    QString edgesPath;              ///< 边文件路径
+    QString sealedJournalPath;      ///< 写盘成功后可删除的封存日志段（可为空）
+};
+
+/**
+ * @brief 保存调度器
+ *
+ * 合并短时间内的连续编辑（防抖），在后台线程序列化快照，
+ * 写入临时文件后原子替换 nodes.txt / edges.txt，界面线程从不等待磁盘。
+ *
+ * 同一时刻最多只有一次写盘在进行；写盘期间到来的请求会在完成后再合并写一次。
+ */
+class SaveScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    /// 取快照的回调：在界面线程、真正开始写盘的那一刻调用
+    using SnapshotProvider = std::function<SaveSnapshot()>;
+
+    explicit SaveScheduler(QObject* parent = nullptr);
+    ~SaveScheduler() override;
+
+    /**
+     * @brief 设置取快照的回调
+     */
+    void setSnapshotProvider(SnapshotProvider provider) { m_provider = std::move(provider); }
+
+    /**
+     * @brief 设置防抖窗口
+     *
+     * 窗口内的连续编辑合并为一次写盘；持续编辑时最长等待 maxWaitMs 也会写一次。
+     *
+     * @param windowMs 防抖窗口（毫秒），0 表示不合并
+     * @param maxWaitMs 最长延迟（毫秒）
+     */
+    void setDebounceInterval(int windowMs, int maxWaitMs = 5000);
+    int debounceInterval() const { return m_windowMs; }
+
+    /**
+     * @brief 请求一次保存（进入防抖窗口）
+     */
+    void requestSave();
+
+    /**
+     * @brief 请求尽快保存（跳过防抖窗口）
+     */
+    void requestSaveNow();
+
+    /**
+     * @brief 立即写完所有待保存的数据并等待结束（退出时调用）
+     */
+    void flush();
+
+    /**
+     * @brief 等待正在进行的写盘结束，不启动新的写盘
+     */
+    void waitForIdle();
+
+    /**
+     * @brief 丢弃尚未开始的保存请求（调用方已经自行完整保存过）
+     */
+    void cancelPending();
+
+    int pendingRequests() const { return m_pending; }        ///< 尚未落盘的编辑请求数
+    bool isSaving() const { return m_inFlight; }             ///< 是否有写盘正在进行
+    int queueDepth() const { return m_pending + (m_inFlight ? m_inFlightRequests : 0); }
+    qint64 lastLatencyMs() const { return m_lastLatencyMs; } ///< 最近一次写盘耗时（毫秒）
+    bool lastSaveOk() const { return m_lastOk; }
+
+signals:
+    /**
+     * @brief 一次写盘完成
+     * @param ok 是否成功
+     * @param latencyMs 后台序列化 + 写盘 + 替换的耗时
+     */
+    void saveFinished(bool ok, qint64 latencyMs);
+
+    /**
+     * @brief 排队数量或耗时统计发生变化
+     */
+    void statsChanged();
+
+private slots:
+    void onTimeout();
+    void onWriteFinished();
+
+private:
+    /// 后台写盘任务的结果
+    struct WriteResult
+    {
+        bool ok = false;
+        qint64 elapsedMs = 0;
+    };
+
+    SnapshotProvider m_provider;
+    QTimer m_timer;
+    QElapsedTimer m_burst;                  ///< 当前这一串编辑的开始时间
+    QFutureWatcher<WriteResult> m_watcher;
+
+    int m_windowMs = 800;
+    int m_maxWaitMs = 5000;
+    int m_pending = 0;                      ///< 等待写盘的请求数
+    int m_inFlightRequests = 0;             ///< 正在写盘的那一批包含的请求数
+    bool m_inFlight = false;
+    qint64 m_lastLatencyMs = 0;
+    bool m_lastOk = true;
+
+    void startWrite();
+    void finishWrite(const WriteResult& result);
+    static WriteResult writeSnapshot(const SaveSnapshot& snapshot);
+};
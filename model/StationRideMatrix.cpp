@@ -0,0 +1,247 @@
+// ============================================================
+// StationRideMatrix.cpp - 校车站两两之间的乘车路线
+// 预计算一次，之后内存中与磁盘缓存共用同一种二进制格式
+// ============================================================
+
+#include "StationRideMatrix.h"
+#include "GraphSnapshot.h"
+
+#include <QSaveFile>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+static const char kMagic[8] = {'W', 'H', 'U', 'R', 'I', 'D', 'E', '1'};
+
+// 数据块中的字段可能不对齐，一律按字节拷贝读写
+template <typename T>
+static T readAt(const QByteArray& bytes, qsizetype offset)
+{
+    T value;
+    std::memcpy(&value, bytes.constData() + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+static void append(QByteArray& bytes, const T& value)
+{
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// ============================================================
+// 预计算：每个车站一次单源 Dijkstra，得到到其余所有车站的路线
+// 校车的道路权重与天气无关，按晴天计算即可
+// ============================================================
+RideMatrixPtr StationRideMatrix::build(const GraphSnapshot& snapshot, const QByteArray& contentHash)
+{
+    // 车站按 ID 排序：同一张图无论节点怎样存放，数据块都相同
+    const NodeTable& nodes = snapshot.nodes();
+    QVector<int> stations;
+    for (const Node& n : nodes)
+    {
+        if (n.category == NodeCategory::BusStation)
+        {
+            stations.append(n.id);
+        }
+    }
+    std::sort(stations.begin(), stations.end());
+
+    const int count = stations.size();
+    QVector<Entry> entries(count * count);
+    QVector<qint32> pool;
+    QVector<double> dist;
+    QVector<int> parent;
+
+    for (int i = 0; i < count; ++i)
+    {
+        snapshot.shortestPathTree(stations[i], TransportMode::Bus, Weather::Sunny, WeightMode::TIME, dist, parent);
+        const int source = nodes.denseOf(stations[i]);
+
+        for (int j = 0; j < count; ++j)
+        {
+            Entry& entry = entries[i * count + j];
+            entry.duration = std::numeric_limits<double>::max();
+            entry.pathOffset = 0;
+            entry.pathLength = 0;
+
+            const int target = nodes.denseOf(stations[j]);
+            if (i == j || dist[target] == std::numeric_limits<double>::max())
+            {
+                continue;
+            }
+
+            // 从终点回溯到起点（下标换回节点 ID），再把这一段原地反转
+            entry.duration = dist[target];
+            entry.pathOffset = static_cast<quint32>(pool.size());
+            for (int curr = target; curr != source; curr = parent[curr])
+            {
+                pool.append(nodes.idAt(curr));
+            }
+            pool.append(stations[i]);
+            std::reverse(pool.begin() + entry.pathOffset, pool.end());
+            entry.pathLength = static_cast<quint32>(pool.size()) - entry.pathOffset;
+        }
+    }
+
+    // ---- 序列化为数据块 ----
+    QByteArray bytes;
+    bytes.reserve(kHeaderSize + count * 4 + entries.size() * 16 + pool.size() * 4);
+    bytes.append(kMagic, sizeof(kMagic));
+    bytes.append(contentHash.left(kHashSize).leftJustified(kHashSize, '\0'));
+    append<quint32>(bytes, static_cast<quint32>(count));
+    for (int id : stations)
+    {
+        append<qint32>(bytes, id);
+    }
+    for (const Entry& entry : entries)
+    {
+        append<double>(bytes, entry.duration);
+        append<quint32>(bytes, entry.pathOffset);
+        append<quint32>(bytes, entry.pathLength);
+    }
+    for (qint32 id : pool)
+    {
+        append<qint32>(bytes, id);
+    }
+
+    std::shared_ptr<StationRideMatrix> matrix(new StationRideMatrix());
+    matrix->m_bytes = bytes;
+    if (!matrix->attach(contentHash))
+    {
+        return nullptr;
+    }
+    return matrix;
+}
+
+// ============================================================
+// 内存映射加载：只解析文件头和车站列表，其余按需读取
+// ============================================================
+RideMatrixPtr StationRideMatrix::load(const QString& path, const QByteArray& contentHash)
+{
+    std::unique_ptr<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly) || file->size() < kHeaderSize)
+    {
+        return nullptr;
+    }
+
+    uchar* mapped = file->map(0, file->size());
+    if (!mapped)
+    {
+        qDebug() << "警告: 无法映射预计算缓存:" << path;
+        return nullptr;
+    }
+
+    std::shared_ptr<StationRideMatrix> matrix(new StationRideMatrix());
+    matrix->m_bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), file->size());
+    matrix->m_file = std::move(file);
+    if (!matrix->attach(contentHash))
+    {
+        qDebug() << "警告: 预计算缓存已损坏或与地图不符:" << path;
+        return nullptr;
+    }
+    return matrix;
+}
+
+bool StationRideMatrix::save(const QString& path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "错误: 无法写入预计算缓存:" << path;
+        return false;
+    }
+    file.write(m_bytes);
+    return file.commit();
+}
+
+bool StationRideMatrix::attach(const QByteArray& contentHash)
+{
+    if (m_bytes.size() < kHeaderSize
+        || std::memcmp(m_bytes.constData(), kMagic, sizeof(kMagic)) != 0
+        || m_bytes.mid(sizeof(kMagic), kHashSize) != contentHash.left(kHashSize).leftJustified(kHashSize, '\0'))
+    {
+        return false;
+    }
+
+    quint32 count = readAt<quint32>(m_bytes, 28);
+    m_entriesOffset = kHeaderSize + qsizetype(count) * 4;
+    m_poolOffset = m_entriesOffset + qsizetype(count) * count * 16;
+    if (m_poolOffset > m_bytes.size() || (m_bytes.size() - m_poolOffset) % 4 != 0)
+    {
+        return false;
+    }
+    m_poolSize = static_cast<quint32>((m_bytes.size() - m_poolOffset) / 4);
+
+    m_stations.resize(count);
+    m_index.reserve(count);
+    for (quint32 i = 0; i < count; ++i)
+    {
+        m_stations[i] = readAt<qint32>(m_bytes, kHeaderSize + qsizetype(i) * 4);
+        m_index.insert(m_stations[i], static_cast<int>(i));
+    }
+    return true;
+}
+
+// ============================================================
+// 查询
+// ============================================================
+bool StationRideMatrix::entryAt(int fromStation, int toStation, Entry& entry) const
+{
+    auto from = m_index.constFind(fromStation);
+    auto to = m_index.constFind(toStation);
+    if (from == m_index.cend() || to == m_index.cend())
+    {
+        return false;
+    }
+
+    qsizetype offset = m_entriesOffset + (qsizetype(from.value()) * m_stations.size() + to.value()) * 16;
+    entry.duration = readAt<double>(m_bytes, offset);
+    entry.pathOffset = readAt<quint32>(m_bytes, offset + 8);
+    entry.pathLength = readAt<quint32>(m_bytes, offset + 12);
+
+    // 路线必须落在节点池内（缓存文件可能被截断）
+    return entry.pathLength > 0 && entry.pathOffset <= m_poolSize
+        && entry.pathLength <= m_poolSize - entry.pathOffset;
+}
+
+double StationRideMatrix::rideDuration(int fromStation, int toStation) const
+{
+    Entry entry;
+    if (!entryAt(fromStation, toStation, entry))
+    {
+        return std::numeric_limits<double>::max();
+    }
+    return entry.duration;
+}
+
+QVector<int> StationRideMatrix::ridePath(int fromStation, int toStation) const
+{
+    Entry entry;
+    if (!entryAt(fromStation, toStation, entry))
+    {
+        return {};
+    }
+
+    QVector<int> path(entry.pathLength);
+    for (quint32 k = 0; k < entry.pathLength; ++k)
+    {
+        path[k] = readAt<qint32>(m_bytes, m_poolOffset + qsizetype(entry.pathOffset + k) * 4);
+    }
+    return path;
+}
+
+bool StationRideMatrix::appendRidePath(int fromStation, int toStation, std::pmr::vector<int>& out) const
+{
+    Entry entry;
+    if (!entryAt(fromStation, toStation, entry))
+    {
+        return false;
+    }
+
+    for (quint32 k = 0; k < entry.pathLength; ++k)
+    {
+        out.push_back(readAt<qint32>(m_bytes, m_poolOffset + qsizetype(entry.pathOffset + k) * 4));
+    }
+    return true;
+}
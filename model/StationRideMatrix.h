@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../GraphData.h"
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+class GraphSnapshot;
+class StationRideMatrix;
+
+/// 乘车矩阵的共享引用：生成后不再修改，可被多个快照和后台线程同时持有
+using RideMatrixPtr = std::shared_ptr<const StationRideMatrix>;
+
+/**
+ * @brief 校车站两两之间的乘车路线（预计算）
+ *
+ * 校车方案要比较所有"上车站 x 下车站"组合，每个组合都跑一次 Dijkstra 代价很高；
+ * 乘车段的权重只与道路长度有关（校车速度不受天气和坡度影响），可以对整张图一次算好。
+ *
+ * 数据以紧凑的二进制块保存，磁盘缓存与内存中的格式相同：
+ * 从缓存加载时直接内存映射文件，只解析车站列表，耗时与矩阵大小无关；
+ * 路线（节点序列）在真正用到时才从块中取出。
+ */
+class StationRideMatrix
+{
+public:
+    /**
+     * @brief 对快照中的全部校车站预计算（每个车站一次单源 Dijkstra）
+     *
+     * @param snapshot 图快照
+     * @param contentHash 快照内容哈希（写入文件头，加载时校验）
+     */
+    static RideMatrixPtr build(const GraphSnapshot& snapshot, const QByteArray& contentHash);
+
+    /**
+     * @brief 内存映射加载缓存文件
+     *
+     * @return RideMatrixPtr 文件不存在、格式不对或哈希不一致时返回空
+     */
+    static RideMatrixPtr load(const QString& path, const QByteArray& contentHash);
+
+    /**
+     * @brief 写入缓存文件（临时文件 + 原子替换）
+     */
+    bool save(const QString& path) const;
+
+    /**
+     * @brief 全部车站 ID
+     */
+    const QVector<int>& stations() const { return m_stations; }
+
+    /**
+     * @brief 乘车耗时（秒）
+     * @return double 不可达或不是车站时返回 double 最大值
+     */
+    double rideDuration(int fromStation, int toStation) const;
+
+    /**
+     * @brief 乘车路线（含两端车站）
+     * @return QVector<int> 不可达时为空
+     */
+    QVector<int> ridePath(int fromStation, int toStation) const;
+
+    /**
+     * @brief 把乘车路线追加到 out 末尾（不另外分配，供寻路请求的临时路径使用）
+     * @return bool 不可达时返回 false，out 不变
+     */
+    bool appendRidePath(int fromStation, int toStation, std::pmr::vector<int>& out) const;
+
+    /**
+     * @brief 数据块大小（字节）
+     */
+    qsizetype byteSize() const { return m_bytes.size(); }
+
+private:
+    StationRideMatrix() = default;
+
+    /// 矩阵中的一项
+    struct Entry
+    {
+        double duration;        ///< 乘车耗时（秒），不可达为 double 最大值
+        quint32 pathOffset;     ///< 路线在节点池中的起始下标
+        quint32 pathLength;     ///< 路线节点数，不可达为 0
+    };
+
+    // 数据块布局（本机字节序）：
+    //   [0, 8)    魔数 "WHURIDE1"
+    //   [8, 28)   内容哈希（SHA-1）
+    //   [28, 32)  车站数 S
+    //   之后依次为 S 个车站 ID (qint32)、S*S 个 Entry、路线节点池 (qint32)
+    static const int kHeaderSize = 32;
+    static const int kHashSize = 20;
+
+    QByteArray m_bytes;                 ///< 数据块（加载时指向映射内存，不拷贝）
+    std::unique_ptr<QFile> m_file;      ///< 映射来源，矩阵存在期间保持打开
+    QVector<int> m_stations;            ///< 车站 ID
+    QHash<int, int> m_index;            ///< 车站 ID -> 矩阵下标
+    qsizetype m_entriesOffset = 0;      ///< Entry 区的起始字节
+    qsizetype m_poolOffset = 0;         ///< 节点池的起始字节
+    quint32 m_poolSize = 0;             ///< 节点池长度
+
+    /**
+     * @brief 解析文件头和车站列表，检查各区域没有越界
+     */
+    bool attach(const QByteArray& contentHash);
+
+    bool entryAt(int fromStation, int toStation, Entry& entry) const;
+};
@@ -0,0 +1,28 @@
+// ============================================================
+// StringPool.cpp - 字符串驻留池
+// ============================================================
+
+#include "StringPool.h"
+
+quint32 StringPool::indexOf(const QString& s)
+{
+    auto it = m_index.constFind(s);
+    if (it != m_index.cend())
+    {
+        m_hits++;
+        return it.value();
+    }
+
+    // 键和表中存的是同一块缓冲区
+    quint32 index = static_cast<quint32>(m_strings.size());
+    m_strings.append(s);
+    m_index.insert(m_strings.last(), index);
+    return index;
+}
+
+void StringPool::clear()
+{
+    m_strings.clear();
+    m_index.clear();
+    m_hits = 0;
+}
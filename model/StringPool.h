@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+/**
+ * @brief 字符串驻留池
+ *
+ * 地图里的显示字符串大量重复（描述 "无"、道路名 "路"、同名建筑……）。
+ * 驻留后相同内容只保留一块缓冲区：intern() 返回池中那个 QString（隐式共享）。
+ *
+ * 节点、道路仍各自存两个 QString（名称、描述），池省下的是重复的字符数据，
+ * 不是每条记录里的 QString 本身，复制记录时也仍有引用计数的增减。
+ * 记录里没有改存下标：快照把节点表、道路表原样共享给后台线程和界面，
+ * 改存下标就要让池随快照一起共享、只读，并在所有显示和保存处换回文本。
+ *
+ * 池只增不减，重新加载地图时 clear()。只在模型所在的线程使用。
+ */
+class StringPool
+{
+public:
+    /**
+     * @brief 驻留字符串，返回它在池中的下标
+     */
+    quint32 indexOf(const QString& s);
+
+    /**
+     * @brief 按下标取字符串
+     */
+    const QString& at(quint32 index) const { return m_strings[index]; }
+
+    /**
+     * @brief 驻留字符串，返回与池中共享缓冲区的副本
+     */
+    QString intern(const QString& s) { return m_strings[indexOf(s)]; }
+
+    /**
+     * @brief 池中不同字符串的个数
+     */
+    int size() const { return m_strings.size(); }
+
+    /**
+     * @brief 命中已有字符串的次数（省下的缓冲区个数）
+     */
+    qint64 hits() const { return m_hits; }
+
+    void clear();
+
+private:
+    QVector<QString> m_strings;             ///< 下标 -> 字符串
+    QHash<QString, quint32> m_index;        ///< 字符串 -> 下标
+    qint64 m_hits = 0;
+};
@@ -0,0 +1,541 @@
+// ============================================================
+// TopologyCleaner.cpp - 几何拓扑清理
+// 空间哈希合并重叠节点 + 扫描线（Bentley-Ottmann）求道路交点
+// ============================================================
+
+#include "TopologyCleaner.h"
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <cmath>
+#include <set>
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+
+// 扫描线按 x 推进，竖直线段没有"在 x 处的 y"。
+// 先做一个极小的错切 x' = x + kShear * y，竖直线段就变成了陡峭的斜线段；
+// 仿射变换不改变线段上的参数 t，交点最后按 t 映射回原坐标。
+const double kShear = 1e-6;
+
+// 交点参数离端点太近视为端点接触，不算穿过
+const double kParamEps = 1e-9;
+
+quint64 cellKey(qint64 cx, qint64 cy)
+{
+    return (static_cast<quint64>(static_cast<quint32>(cx)) << 32) | static_cast<quint32>(cy);
+}
+
+quint64 pairKey(int a, int b)
+{
+    if (a > b)
+    {
+        std::swap(a, b);
+    }
+    return (static_cast<quint64>(static_cast<quint32>(a)) << 32) | static_cast<quint32>(b);
+}
+
+double cross(const QPointF& a, const QPointF& b)
+{
+    return a.x() * b.y() - a.y() * b.x();
+}
+
+/**
+ * @brief 参与求交的线段（错切坐标，p 在左）
+ */
+struct Segment
+{
+    int u;              ///< 道路端点（合并后的节点 ID）
+    int v;
+    QPointF p;          ///< 左端点
+    QPointF q;          ///< 右端点
+    bool reversed;      ///< p 对应 v（参数 t 需要翻转成 u -> v 方向）
+};
+
+/**
+ * @brief 求得的一个交点
+ */
+struct Crossing
+{
+    int segA;
+    int segB;
+    double tA;          ///< 在 A 上的参数（p -> q）
+    double tB;
+    QPointF pos;        ///< 原坐标
+};
+
+/**
+ * @brief 扫描线事件（std::set 充当优先队列，同一交点自动去重）
+ */
+struct Event
+{
+    enum Kind { Remove = 0, Cross = 1, Insert = 2 };
+
+    double x;
+    double y;
+    int kind;
+    int a;
+    int b;
+
+    bool operator<(const Event& o) const
+    {
+        if (x != o.x) return x < o.x;
+        if (y != o.y) return y < o.y;
+        if (kind != o.kind) return kind < o.kind;
+        if (a != o.a) return a < o.a;
+        return b < o.b;
+    }
+};
+
+/**
+ * @brief Bentley-Ottmann 扫描
+ *
+ * 状态结构是按当前扫描位置 y 值排序的平衡树；
+ * 只有在树中相邻的线段才可能产生下一个交点，所以每次插入、删除、交换后
+ * 只检查新出现的相邻对。总代价 O((n + k) log n)。
+ */
+class Sweep
+{
+public:
+    Sweep(const QVector<Segment>& segs, double endpointGap)
+        : m_segs(segs), m_endpointGap(endpointGap), m_status(SlotLess{this})
+    {
+    }
+
+    QVector<Crossing> run()
+    {
+        for (int i = 0; i < m_segs.size(); ++i)
+        {
+            m_events.insert({m_segs[i].p.x(), m_segs[i].p.y(), Event::Insert, i, -1});
+            m_events.insert({m_segs[i].q.x(), m_segs[i].q.y(), Event::Remove, i, -1});
+        }
+        m_slots.resize(m_segs.size());
+
+        while (!m_events.empty())
+        {
+            Event ev = *m_events.begin();
+            m_events.erase(m_events.begin());
+            m_sweepX = ev.x;
+
+            if (ev.kind == Event::Insert)
+            {
+                auto it = m_status.insert(Slot{ev.a}).first;
+                m_slots[ev.a] = it;
+                if (it != m_status.begin())
+                {
+                    check(std::prev(it), it);
+                }
+                if (std::next(it) != m_status.end())
+                {
+                    check(it, std::next(it));
+                }
+            }
+            else if (ev.kind == Event::Remove)
+            {
+                auto it = m_slots[ev.a];
+                auto after = std::next(it);
+                bool hasBefore = (it != m_status.begin());
+                auto before = hasBefore ? std::prev(it) : it;
+                m_status.erase(it);
+                if (hasBefore && after != m_status.end())
+                {
+                    check(before, after);
+                }
+            }
+            else
+            {
+                swapAtCrossing(ev);
+            }
+        }
+        return m_crossings;
+    }
+
+private:
+    /// 树节点里只放线段下标；交换两条线段的次序时直接改写下标，不必重新排序
+    struct Slot
+    {
+        mutable int seg;
+    };
+
+    struct SlotLess
+    {
+        const Sweep* sweep;
+        bool operator()(const Slot& a, const Slot& b) const { return sweep->below(a.seg, b.seg); }
+    };
+
+    using Status = std::set<Slot, SlotLess>;
+
+    const QVector<Segment>& m_segs;
+    double m_endpointGap;
+    double m_sweepX = 0.0;
+    std::set<Event> m_events;
+    Status m_status;
+    QVector<Status::iterator> m_slots;      ///< 线段 -> 树中的位置
+    QSet<quint64> m_checkedPairs;           ///< 已判断过的线段对
+    QVector<Crossing> m_crossings;
+
+    double yAt(int s, double x) const
+    {
+        const Segment& seg = m_segs[s];
+        if (x <= seg.p.x()) return seg.p.y();
+        if (x >= seg.q.x()) return seg.q.y();
+        return seg.p.y() + (x - seg.p.x()) * (seg.q.y() - seg.p.y()) / (seg.q.x() - seg.p.x());
+    }
+
+    double slope(int s) const
+    {
+        const Segment& seg = m_segs[s];
+        return (seg.q.y() - seg.p.y()) / (seg.q.x() - seg.p.x());
+    }
+
+    bool below(int a, int b) const
+    {
+        if (a == b) return false;
+        double ya = yAt(a, m_sweepX);
+        double yb = yAt(b, m_sweepX);
+        if (std::abs(ya - yb) > 1e-9 * (1.0 + std::abs(ya)))
+        {
+            return ya < yb;
+        }
+        // 同一点出发：之后斜率小的在下方
+        double sa = slope(a);
+        double sb = slope(b);
+        if (sa != sb) return sa < sb;
+        return a < b;
+    }
+
+    void check(Status::iterator lower, Status::iterator upper)
+    {
+        int a = lower->seg;
+        int b = upper->seg;
+        if (m_checkedPairs.contains(pairKey(a, b)))
+        {
+            return;
+        }
+        m_checkedPairs.insert(pairKey(a, b));
+
+        const Segment& sa = m_segs[a];
+        const Segment& sb = m_segs[b];
+        // 共享端点的道路本来就在路口相接
+        if (sa.u == sb.u || sa.u == sb.v || sa.v == sb.u || sa.v == sb.v)
+        {
+            return;
+        }
+
+        QPointF r = sa.q - sa.p;
+        QPointF s = sb.q - sb.p;
+        double denom = cross(r, s);
+        if (std::abs(denom) < 1e-12)
+        {
+            return;  // 平行或共线
+        }
+        QPointF diff = sb.p - sa.p;
+        double t = cross(diff, s) / denom;
+        double w = cross(diff, r) / denom;
+        if (t <= kParamEps || t >= 1.0 - kParamEps || w <= kParamEps || w >= 1.0 - kParamEps)
+        {
+            return;
+        }
+
+        // 真正的交点都要在扫描中交换次序，否则状态树的顺序会乱。
+        // 刚相邻的两条线段交点不会在扫描线左侧，略偏左只是舍入误差，按当前位置处理
+        QPointF hit = sa.p + r * t;
+        m_events.insert({std::max(hit.x(), m_sweepX), hit.y(), Event::Cross, std::min(a, b), std::max(a, b)});
+
+        // 交点离任何端点都太近：是 T 形接头或描点误差，不在这里切
+        double lenA = std::hypot(r.x(), r.y());
+        double lenB = std::hypot(s.x(), s.y());
+        if (std::min(t, 1.0 - t) * lenA <= m_endpointGap || std::min(w, 1.0 - w) * lenB <= m_endpointGap)
+        {
+            return;
+        }
+
+        QPointF original(hit.x() - kShear * hit.y(), hit.y());
+        m_crossings.append({a, b, t, w, original});
+    }
+
+    bool passesThrough(int s, double x, double y) const
+    {
+        return std::abs(yAt(s, x) - y) <= 1e-7 * (1.0 + std::abs(y));
+    }
+
+    // 交点处的线段在状态树中是连续的一段，越过交点后它们的上下次序正好反过来。
+    // 多条道路交于同一点时整段一次重排，同一点的其余交点事件随之作废
+    void swapAtCrossing(const Event& ev)
+    {
+        auto lo = m_slots[ev.a];
+        auto hi = lo;
+        while (lo != m_status.begin() && passesThrough(std::prev(lo)->seg, ev.x, ev.y))
+        {
+            --lo;
+        }
+        while (std::next(hi) != m_status.end() && passesThrough(std::next(hi)->seg, ev.x, ev.y))
+        {
+            ++hi;
+        }
+
+        QVector<Status::iterator> run;
+        for (auto it = lo; ; ++it)
+        {
+            run.append(it);
+            if (it == hi) break;
+        }
+        // 越过交点后按斜率从小到大排列（与 below() 在交点处的判定一致）；
+        // 一般情况下就是整段翻转，共线的线段之间保持原有次序
+        QVector<int> segs;
+        for (auto it : run)
+        {
+            segs.append(it->seg);
+        }
+        std::sort(segs.begin(), segs.end(), [this](int a, int b) {
+            double sa = slope(a);
+            double sb = slope(b);
+            return (sa != sb) ? sa < sb : a < b;
+        });
+        for (int i = 0; i < run.size(); ++i)
+        {
+            run[i]->seg = segs[i];
+            m_slots[segs[i]] = run[i];
+        }
+
+        while (!m_events.empty())
+        {
+            const Event& next = *m_events.begin();
+            bool samePoint = std::abs(next.x - ev.x) <= 1e-7 * (1.0 + std::abs(ev.x))
+                          && std::abs(next.y - ev.y) <= 1e-7 * (1.0 + std::abs(ev.y));
+            if (next.kind != Event::Cross || !samePoint) break;
+            m_events.erase(m_events.begin());
+        }
+
+        if (lo != m_status.begin())
+        {
+            check(std::prev(lo), lo);
+        }
+        if (std::next(hi) != m_status.end())
+        {
+            check(hi, std::next(hi));
+        }
+    }
+};
+
+} // namespace
+
+// ============================================================
+// 生成清理方案
+// ============================================================
+TopologyPlan TopologyCleaner::plan(const QVector<Node>& nodes, const QVector<Edge>& edges,
+                                   double mergeEpsilon)
+{
+    TopologyPlan result;
+    const int n = nodes.size();
+
+    // ---- 第1步：空间哈希找重叠节点，并查集归组 ----
+    QVector<int> parent(n);
+    QVector<int> visibleOf(n, -1);  // 组内的建筑（每组至多一个）
+    for (int i = 0; i < n; ++i)
+    {
+        parent[i] = i;
+        if (nodes[i].type == NodeType::Visible)
+        {
+            visibleOf[i] = i;
+        }
+    }
+    auto find = [&parent](int i) {
+        while (parent[i] != i)
+        {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
+    if (mergeEpsilon > 0.0)
+    {
+        QHash<quint64, QVector<int>> grid;
+        grid.reserve(n);
+        for (int i = 0; i < n; ++i)
+        {
+            qint64 cx = static_cast<qint64>(std::floor(nodes[i].x / mergeEpsilon));
+            qint64 cy = static_cast<qint64>(std::floor(nodes[i].y / mergeEpsilon));
+
+            for (qint64 dx = -1; dx <= 1; ++dx)
+            {
+                for (qint64 dy = -1; dy <= 1; ++dy)
+                {
+                    auto cell = grid.constFind(cellKey(cx + dx, cy + dy));
+                    if (cell == grid.constEnd())
+                    {
+                        continue;
+                    }
+                    for (int j : cell.value())
+                    {
+                        bool anyGhost = (nodes[i].type == NodeType::Ghost || nodes[j].type == NodeType::Ghost);
+                        double gap = std::hypot(nodes[i].x - nodes[j].x, nodes[i].y - nodes[j].y);
+                        if (!anyGhost || gap > mergeEpsilon)
+                        {
+                            continue;
+                        }
+                        int ri = find(i);
+                        int rj = find(j);
+                        // 两组各有一个建筑：不能经由路口把两个地点并成一个
+                        if (ri == rj || (visibleOf[ri] >= 0 && visibleOf[rj] >= 0))
+                        {
+                            continue;
+                        }
+                        parent[rj] = ri;
+                        if (visibleOf[ri] < 0)
+                        {
+                            visibleOf[ri] = visibleOf[rj];
+                        }
+                    }
+                }
+            }
+            grid[cellKey(cx, cy)].append(i);
+        }
+    }
+
+    // 每组保留的节点：建筑优先，否则 ID 最小
+    QVector<int> keepOfRoot(n, -1);
+    for (int i = 0; i < n; ++i)
+    {
+        int r = find(i);
+        int& keep = keepOfRoot[r];
+        if (visibleOf[r] >= 0)
+        {
+            keep = visibleOf[r];
+        }
+        else if (keep < 0 || nodes[i].id < nodes[keep].id)
+        {
+            keep = i;
+        }
+    }
+
+    QHash<int, int> keepId;         // 节点 ID -> 合并后的节点 ID
+    QHash<int, QPointF> position;   // 节点 ID -> 坐标
+    keepId.reserve(n);
+    position.reserve(n);
+    for (int i = 0; i < n; ++i)
+    {
+        int keep = keepOfRoot[find(i)];
+        keepId.insert(nodes[i].id, nodes[keep].id);
+        position.insert(nodes[i].id, QPointF(nodes[i].x, nodes[i].y));
+        if (keep != i)
+        {
+            double gap = std::hypot(nodes[i].x - nodes[keep].x, nodes[i].y - nodes[keep].y);
+            result.merges.append({nodes[keep].id, nodes[i].id, gap});
+        }
+    }
+
+    // ---- 第2步：合并后的道路（去掉自环和重复）转成错切坐标下的线段 ----
+    QVector<Segment> segs;
+    segs.reserve(edges.size());
+    QSet<quint64> seenPairs;
+    for (const Edge& e : edges)
+    {
+        int u = keepId.value(e.u, e.u);
+        int v = keepId.value(e.v, e.v);
+        if (u == v || !position.contains(u) || !position.contains(v) || seenPairs.contains(pairKey(u, v)))
+        {
+            continue;
+        }
+        seenPairs.insert(pairKey(u, v));
+
+        QPointF pu = position.value(u);
+        QPointF pv = position.value(v);
+        QPointF su(pu.x() + kShear * pu.y(), pu.y());
+        QPointF sv(pv.x() + kShear * pv.y(), pv.y());
+        if (su == sv)
+        {
+            continue;
+        }
+        bool reversed = (sv.x() < su.x()) || (sv.x() == su.x() && sv.y() < su.y());
+        segs.append(reversed ? Segment{u, v, sv, su, true} : Segment{u, v, su, sv, false});
+    }
+
+    // ---- 第3步：扫描线求交 ----
+    double endpointGap = std::max(mergeEpsilon, 0.5);
+    QVector<Crossing> crossings = Sweep(segs, endpointGap).run();
+
+    // ---- 第4步：交点聚类成路口（多条道路交于一点时只建一个路口）----
+    QHash<quint64, QVector<int>> junctionGrid;
+    auto junctionFor = [&](const QPointF& pos) {
+        qint64 cx = static_cast<qint64>(std::floor(pos.x() / endpointGap));
+        qint64 cy = static_cast<qint64>(std::floor(pos.y() / endpointGap));
+        for (qint64 dx = -1; dx <= 1; ++dx)
+        {
+            for (qint64 dy = -1; dy <= 1; ++dy)
+            {
+                for (int key : junctionGrid.value(cellKey(cx + dx, cy + dy)))
+                {
+                    QPointF d = result.junctions[key].pos - pos;
+                    if (std::hypot(d.x(), d.y()) <= endpointGap)
+                    {
+                        return key;
+                    }
+                }
+            }
+        }
+        int key = result.junctions.size();
+        result.junctions.append({key, pos});
+        junctionGrid[cellKey(cx, cy)].append(key);
+        return key;
+    };
+
+    QMap<int, QVector<QPair<double, int>>> cutsOfSeg;   // 线段 -> (u->v 方向的参数, 路口)，有序便于审阅
+    for (const Crossing& c : crossings)
+    {
+        int key = junctionFor(c.pos);
+        const double tA = segs[c.segA].reversed ? 1.0 - c.tA : c.tA;
+        const double tB = segs[c.segB].reversed ? 1.0 - c.tB : c.tB;
+        cutsOfSeg[c.segA].append({tA, key});
+        cutsOfSeg[c.segB].append({tB, key});
+    }
+
+    // ---- 第5步：每条被切的道路按参数排序列出经过的路口 ----
+    for (auto it = cutsOfSeg.begin(); it != cutsOfSeg.end(); ++it)
+    {
+        QVector<QPair<double, int>>& cuts = it.value();
+        std::sort(cuts.begin(), cuts.end());
+
+        TopologyPlan::EdgeSplit split;
+        split.u = segs[it.key()].u;
+        split.v = segs[it.key()].v;
+        for (const auto& cut : cuts)
+        {
+            if (!split.junctionKeys.contains(cut.second))
+            {
+                split.junctionKeys.append(cut.second);
+            }
+        }
+        result.splits.append(split);
+    }
+    return result;
+}
+
+// ============================================================
+// 方案说明（每项修改一行）
+// ============================================================
+QStringList TopologyPlan::describe() const
+{
+    QStringList lines;
+    for (const NodeMerge& m : merges)
+    {
+        lines << QString("合并节点 %1 -> %2 (相距 %3 px)").arg(m.dropId).arg(m.keepId).arg(m.gap, 0, 'f', 2);
+    }
+    for (const Junction& j : junctions)
+    {
+        lines << QString("新建路口 #%1 (%2, %3)").arg(j.key).arg(j.pos.x(), 0, 'f', 1).arg(j.pos.y(), 0, 'f', 1);
+    }
+    for (const EdgeSplit& s : splits)
+    {
+        QStringList keys;
+        for (int key : s.junctionKeys)
+        {
+            keys << QString("#%1").arg(key);
+        }
+        lines << QString("切开道路 %1-%2，经过 ").arg(s.u).arg(s.v) + keys.join(" ");
+    }
+    return lines;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../GraphData.h"
+#include <QPointF>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief 拓扑清理方案（应用前可供审阅）
+ *
+ * 由 TopologyCleaner::plan() 生成，只描述要做的修改，不改动任何数据；
+ * 确认后交给 GraphModel::applyTopologyPlan() 作为一批编辑执行。
+ */
+struct TopologyPlan
+{
+    /**
+     * @brief 合并重叠节点：dropId 的道路改接到 keepId，然后删除 dropId
+     */
+    struct NodeMerge
+    {
+        int keepId;
+        int dropId;
+        double gap;         ///< 两点间距（像素）
+    };
+
+    /**
+     * @brief 在道路交叉处新建的路口（Ghost）
+     */
+    struct Junction
+    {
+        int key;            ///< 方案内的临时编号（从 0 开始）
+        QPointF pos;        ///< 交点坐标
+    };
+
+    /**
+     * @brief 被交叉点切开的道路（端点为合并后的节点 ID）
+     */
+    struct EdgeSplit
+    {
+        int u;
+        int v;
+        QVector<int> junctionKeys;  ///< 从 u 到 v 依次经过的新路口
+    };
+
+    QVector<NodeMerge> merges;
+    QVector<Junction> junctions;
+    QVector<EdgeSplit> splits;
+
+    /**
+     * @brief 是否没有需要修改的地方
+     */
+    bool isEmpty() const { return merges.isEmpty() && splits.isEmpty(); }
+
+    /**
+     * @brief 逐条列出修改内容（用于审阅）
+     */
+    QStringList describe() const;
+};
+
+/**
+ * @brief 几何拓扑清理
+ *
+ * 手工描点的地图常见两类问题：两条道路画面上相交却没有路口；
+ * 同一位置叠了好几个路口。清理分两步：
+ * 1. 空间哈希（格子边长 = epsilon）找出距离不超过 epsilon 的节点并合并，O(n)；
+ * 2. 在合并后的道路上做扫描线（Bentley-Ottmann）求交，O((n + k) log n)，k 为交点数，
+ *    每个交点生成一个新路口，相交的道路在路口处切开。
+ *
+ * 只处理真正的"穿过"：共享端点、共线重叠、端点落在另一条道路上（T 形）都不算交叉；
+ * 交点离道路端点不超过 epsilon（至少 0.5 像素）的也按 T 形处理，避免切出极短的路段。
+ */
+class TopologyCleaner
+{
+public:
+    /// 默认合并距离（像素，约 1.8 米）
+    static constexpr double kDefaultMergeEpsilon = 2.0;
+
+    /**
+     * @brief 计算清理方案
+     *
+     * 合并规则：至少一方是路口（Ghost）才合并，两个建筑即使重叠也视为不同地点；
+     * 一组重叠节点中保留建筑（若有），否则保留 ID 最小的路口，坐标不变。
+     *
+     * @param nodes 全部节点
+     * @param edges 全部道路
+     * @param mergeEpsilon 合并距离（像素）
+     * @return TopologyPlan 清理方案
+     */
+    static TopologyPlan plan(const QVector<Node>& nodes, const QVector<Edge>& edges,
+                             double mergeEpsilon = kDefaultMergeEpsilon);
+};
@@ -0,0 +1,636 @@
+// ============================================================
+// BenchRouting.cpp - 寻路邻接表布局基准
+// 在同一张地图上用同一份 Dijkstra 代码比较三种布局：
+//   hilbert  量化邻接边（AdjEdge，24 字节），节点下标按 Hilbert 曲线排列（模型实际使用的）
+//   id       量化邻接边，节点下标按 ID 排列（重排之前，ID 按编辑顺序分配）
+//   wide     量化前的双精度邻接边（40 字节），下标同 hilbert
+// 报告内存占用、耗时、缓存未命中次数、量化偏差，以及下标局部性（邻居落在同一缓存行 / 页的比例）
+// 最后检查多策略寻路在稳定状态下是否还向全局堆申请临时内存（malloc 族和 operator new 都计入，
+// 返回的推荐列表本身占用的内存块单独数出来扣除）
+//
+// 用法: BenchRouting <nodes.txt> <edges.txt> [起点数=50] [随机种子=1] [hilbert|id|wide|all] [轮数=5]
+//
+// 每种布局先预热，再测若干轮，列出每一轮的耗时，报告中位数和最小 / 最大值；
+// 布局之间的差别要比同一布局各轮之间的波动大才能说明问题
+//
+// 大地图可以用 GenerateMap 生成。缓存未命中次数在 Linux 上由本工具用硬件计数器
+// （perf_event_open）只统计计时区间内的搜索，不含加载地图和建布局；
+// 内核不允许时（perf_event_paranoid > 2、容器里没有 PMU）显示"不可用"，
+// 这时可以用系统工具分别测量单一布局（会把加载地图也算进去），例如：
+//   GenerateMap campus 1000000 big
+//   BenchRouting big/nodes.txt big/edges.txt 50 1
+//   perf stat -e cache-misses,cache-references BenchRouting big/nodes.txt big/edges.txt 50 1 id
+//   perf stat -e cache-misses,cache-references BenchRouting big/nodes.txt big/edges.txt 50 1 hilbert
+// ============================================================
+
+#include "../model/GraphModel.h"
+#include <QCoreApplication>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <new>
+#include <queue>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// 全局堆分配计数：Qt 容器走 malloc / realloc，std / pmr 容器走 operator new，两条路都要数到。
+// glibc 下在可执行文件里重新定义 malloc 族，Qt 等共享库的调用也会落到这里，再转给 glibc 的实现；
+// operator new 内部调用 malloc，不重复计数。其他 C 库只能数 operator new（启动时提示）
+static std::atomic<qint64> g_heapAllocs{0};
+
+static void countAllocation()
+{
+    g_heapAllocs.fetch_add(1, std::memory_order_relaxed);
+}
+
+#ifdef __GLIBC__
+#define BENCH_COUNTS_MALLOC 1
+
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* p, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* p);
+
+void* malloc(std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_realloc(p, size);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, std::size_t alignment, std::size_t size) noexcept
+{
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+    countAllocation();
+    void* p = __libc_memalign(alignment, size);
+    if (!p)
+    {
+        return ENOMEM;
+    }
+    *out = p;
+    return 0;
+}
+
+void free(void* p) noexcept
+{
+    __libc_free(p);
+}
+}
+#endif
+
+void* operator new(std::size_t size)
+{
+#ifndef BENCH_COUNTS_MALLOC
+    countAllocation();
+#endif
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+// 量化前的邻接边布局：长度、坡度都是 double
+struct WideAdjEdge
+{
+    int u, v;
+    int id;
+    int to;
+    EdgeType type;
+    double distance;
+    double slope;
+};
+
+double lengthOf(const WideAdjEdge& e) { return e.distance; }
+double lengthOf(const AdjEdge& e) { return e.distance(); }
+bool steepOf(const WideAdjEdge& e) { return AdjEdge::isSteep(e.slope); }
+bool steepOf(const AdjEdge& e) { return e.steep; }
+
+// 步行耗时（秒），与 GraphSnapshot::getEdgeWeight 的步行规则一致，长度、坡度都要读到
+template <typename E>
+double walkSeconds(const E& e)
+{
+    double speed = Config::SPEED_WALK;
+    if (steepOf(e))
+    {
+        speed *= 0.8;
+    }
+    return lengthOf(e) / speed;
+}
+
+// 各布局共用的单源最短路，累加用 double
+template <typename E>
+void dijkstra(const QVector<QVector<E>>& adj, int source, QVector<double>& dist)
+{
+    dist.fill(std::numeric_limits<double>::max(), adj.size());
+
+    using Item = std::pair<double, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<>> pq;
+    dist[source] = 0;
+    pq.push({0, source});
+
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u])
+        {
+            continue;
+        }
+        for (const E& e : adj[u])
+        {
+            if (e.to < 0)
+            {
+                continue;
+            }
+            double newDist = d + walkSeconds(e);
+            if (newDist < dist[e.to])
+            {
+                dist[e.to] = newDist;
+                pq.push({newDist, e.to});
+            }
+        }
+    }
+}
+
+// 从道路表按原始精度还原量化前的邻接表（下标、顺序与快照相同）
+QVector<QVector<WideAdjEdge>> widen(const GraphSnapshot& snap)
+{
+    const AdjacencyList& adj = snap.adjacency();
+    QVector<QVector<WideAdjEdge>> wide(adj.size());
+    for (int i = 0; i < adj.size(); ++i)
+    {
+        wide[i].reserve(adj[i].size());
+        for (const AdjEdge& e : adj[i])
+        {
+            const Edge* full = snap.edge(e.id);
+            double slope = (full->u == e.u) ? full->slope : -full->slope;
+            wide[i].append({e.u, e.v, e.id, e.to, e.type, full->distance, slope});
+        }
+    }
+    return wide;
+}
+
+// 按节点 ID 重新编排下标（重排之前的布局）；order[新下标] = 快照中的下标
+QVector<QVector<AdjEdge>> byId(const GraphSnapshot& snap, QVector<int>& order, QVector<int>& toNew)
+{
+    const AdjacencyList& adj = snap.adjacency();
+    QList<int> ids = snap.nodes().keys();
+    order.clear();
+    toNew.fill(-1, adj.size());
+    for (int id : ids)
+    {
+        int dense = snap.nodes().denseOf(id);
+        toNew[dense] = order.size();
+        order.append(dense);
+    }
+
+    QVector<QVector<AdjEdge>> result(order.size());
+    for (int i = 0; i < order.size(); ++i)
+    {
+        result[i] = adj.value(order[i]);
+        for (AdjEdge& e : result[i])
+        {
+            e.to = (e.to < 0) ? -1 : toNew[e.to];
+        }
+    }
+    return result;
+}
+
+// 下标局部性：边两端在距离表（double）里落在同一缓存行 / 同一页的比例
+template <typename E>
+void reportLocality(const char* name, const QVector<QVector<E>>& adj)
+{
+    qint64 total = 0;
+    qint64 sameLine = 0;
+    qint64 samePage = 0;
+    double gapSum = 0;
+    for (int i = 0; i < adj.size(); ++i)
+    {
+        for (const E& e : adj[i])
+        {
+            if (e.to < 0)
+            {
+                continue;
+            }
+            total++;
+            gapSum += std::abs(e.to - i);
+            sameLine += (i / 8 == e.to / 8) ? 1 : 0;         // 64 字节 = 8 个 double
+            samePage += (i / 512 == e.to / 512) ? 1 : 0;     // 4 KB = 512 个 double
+        }
+    }
+    if (total == 0)
+    {
+        return;
+    }
+    qInfo() << name << ": 邻居下标平均间隔" << gapSum / total
+            << ", 同一缓存行" << 100.0 * sameLine / total << "%, 同一页" << 100.0 * samePage / total << "%";
+}
+
+// 硬件事件计数器（只统计本进程用户态）；打不开时 read() 返回 -1
+class HardwareCounter
+{
+public:
+    explicit HardwareCounter(quint64 event)
+    {
+#ifdef Q_OS_LINUX
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = event;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+        Q_UNUSED(event);
+#endif
+    }
+    ~HardwareCounter()
+    {
+#ifdef Q_OS_LINUX
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+#endif
+    }
+    HardwareCounter(const HardwareCounter&) = delete;
+    HardwareCounter& operator=(const HardwareCounter&) = delete;
+
+    void start()
+    {
+#ifdef Q_OS_LINUX
+        if (m_fd >= 0)
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    qint64 stop()
+    {
+#ifdef Q_OS_LINUX
+        if (m_fd >= 0)
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            qint64 value = 0;
+            if (::read(m_fd, &value, sizeof(value)) == sizeof(value))
+            {
+                return value;
+            }
+        }
+#endif
+        return -1;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+#ifdef Q_OS_LINUX
+const quint64 kCacheMisses = PERF_COUNT_HW_CACHE_MISSES;
+const quint64 kCacheReferences = PERF_COUNT_HW_CACHE_REFERENCES;
+#else
+const quint64 kCacheMisses = 0;
+const quint64 kCacheReferences = 0;
+#endif
+
+// 一次计时的结果
+struct RunStats
+{
+    qint64 ms = 0;
+    qint64 cacheMisses = -1;        ///< -1 表示计数器不可用
+    qint64 cacheReferences = -1;
+};
+
+QString counterText(qint64 value)
+{
+    return value < 0 ? QString("不可用") : QString::number(value);
+}
+
+// 跑完全部起点，返回耗时（毫秒）和这段时间内的缓存未命中 / 访问次数
+template <typename E>
+RunStats timeRuns(const QVector<QVector<E>>& adj, const QVector<int>& sources, QVector<QVector<double>>& results,
+                  HardwareCounter& misses, HardwareCounter& references)
+{
+    results.resize(sources.size());
+    RunStats stats;
+    QElapsedTimer timer;
+    misses.start();
+    references.start();
+    timer.start();
+    for (int i = 0; i < sources.size(); ++i)
+    {
+        dijkstra(adj, sources[i], results[i]);
+    }
+    stats.ms = timer.elapsed();
+    stats.cacheMisses = misses.stop();
+    stats.cacheReferences = references.stop();
+    return stats;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+
+    if (args.size() < 3)
+    {
+        qInfo() << "用法: BenchRouting <nodes.txt> <edges.txt> [起点数=50] [随机种子=1] [hilbert|id|wide|all] [轮数=5]";
+        return 1;
+    }
+
+    const int sourceCount = args.size() > 3 ? std::max(1, args[3].toInt()) : 50;
+    quint32 seed = args.size() > 4 ? args[4].toUInt() : 1;
+    const QString only = (args.size() > 5 && args[5] != "all") ? args[5] : QString();
+    const int rounds = args.size() > 6 ? std::max(1, args[6].toInt()) : 5;
+    if (!only.isEmpty() && only != "hilbert" && only != "id" && only != "wide")
+    {
+        qInfo() << "未知的布局:" << only;
+        return 1;
+    }
+
+    GraphModel model;
+    if (!model.loadData(args[1], args[2]))
+    {
+        return 1;
+    }
+
+    GraphSnapshotPtr snap = model.snapshot();
+    const AdjacencyList& hilbert = snap->adjacency();
+    QVector<int> order;
+    QVector<int> toNew;
+    const QVector<QVector<AdjEdge>> byIdAdj = byId(*snap, order, toNew);
+    const QVector<QVector<WideAdjEdge>> wide = widen(*snap);
+
+    // ---- 内存与局部性 ----
+    qint64 halfEdges = 0;
+    for (const QVector<AdjEdge>& list : hilbert)
+    {
+        halfEdges += list.size();
+    }
+    qInfo() << "节点" << snap->nodes().size() << "邻接边(正反各一份)" << halfEdges;
+    qInfo() << "量化布局:" << sizeof(AdjEdge) << "字节/边, 共" << halfEdges * qint64(sizeof(AdjEdge)) / 1024 << "KB";
+    qInfo() << "双精度布局:" << sizeof(WideAdjEdge) << "字节/边, 共" << halfEdges * qint64(sizeof(WideAdjEdge)) / 1024 << "KB";
+    reportLocality("ID 顺序", byIdAdj);
+    reportLocality("Hilbert 顺序", hilbert);
+
+    // ---- 起点：随机取有道路的节点（快照中的下标）----
+    QVector<int> candidates;
+    for (int i = 0; i < hilbert.size(); ++i)
+    {
+        if (!hilbert[i].isEmpty())
+        {
+            candidates.append(i);
+        }
+    }
+    if (candidates.isEmpty())
+    {
+        qInfo() << "地图里没有道路";
+        return 1;
+    }
+    QRandomGenerator rng(seed);
+    QVector<int> sources;
+    QVector<int> idSources;
+    for (int i = 0; i < sourceCount; ++i)
+    {
+        int dense = candidates[rng.bounded(candidates.size())];
+        sources.append(dense);
+        idSources.append(toNew[dense]);
+    }
+
+    // ---- 耗时与缓存未命中：先各跑一个起点预热，再测 rounds 轮，取耗时居中的一轮 ----
+    QVector<QVector<double>> hilbertDist;
+    QVector<QVector<double>> idDist;
+    QVector<QVector<double>> wideDist;
+    HardwareCounter missCounter(kCacheMisses);
+    HardwareCounter referenceCounter(kCacheReferences);
+    auto measure = [&](auto run) {
+        run(1);
+        QVector<RunStats> runs;
+        for (int round = 0; round < rounds; ++round)
+        {
+            runs.append(run(-1));
+        }
+        std::sort(runs.begin(), runs.end(), [](const RunStats& a, const RunStats& b) { return a.ms < b.ms; });
+        return runs;
+    };
+    auto report = [&](const char* layout, const QVector<RunStats>& runs) {
+        QStringList times;
+        for (const RunStats& stats : runs)
+        {
+            times << QString::number(stats.ms);
+        }
+        const RunStats& median = runs[runs.size() / 2];
+        qInfo() << "单源最短路 x" << sources.size() << ":" << layout << "中位数" << median.ms << "ms (最小"
+                << runs.first().ms << "最大" << runs.last().ms << ", 各轮" << times.join(" ") << "), 缓存未命中"
+                << counterText(median.cacheMisses) << "次 / 访问" << counterText(median.cacheReferences) << "次";
+    };
+    if (only.isEmpty() || only == "hilbert")
+    {
+        report("量化 + Hilbert 顺序", measure([&](int n) {
+            return timeRuns(hilbert, sources.mid(0, n), hilbertDist, missCounter, referenceCounter);
+        }));
+    }
+    if (only.isEmpty() || only == "id")
+    {
+        report("量化 + ID 顺序", measure([&](int n) {
+            return timeRuns(byIdAdj, idSources.mid(0, n), idDist, missCounter, referenceCounter);
+        }));
+    }
+    if (only.isEmpty() || only == "wide")
+    {
+        report("双精度 + Hilbert 顺序", measure([&](int n) {
+            return timeRuns(wide, sources.mid(0, n), wideDist, missCounter, referenceCounter);
+        }));
+    }
+    if (!only.isEmpty())
+    {
+        return 0;
+    }
+
+    // ---- 正确性：重排不改变结果，量化只带来显示精度以内的偏差 ----
+    const double INF = std::numeric_limits<double>::max();
+    double reorderDiff = 0;
+    double maxAbs = 0;
+    double maxRel = 0;
+    for (int i = 0; i < sources.size(); ++i)
+    {
+        for (int v = 0; v < hilbertDist[i].size(); ++v)
+        {
+            double a = hilbertDist[i][v];
+            if (toNew[v] >= 0)
+            {
+                double r = idDist[i][toNew[v]];
+                reorderDiff = std::max(reorderDiff, (a == r) ? 0.0 : std::abs(a - r));
+            }
+
+            double b = wideDist[i][v];
+            if (b == INF)
+            {
+                continue;
+            }
+            maxAbs = std::max(maxAbs, std::abs(a - b));
+            if (b > 0)
+            {
+                maxRel = std::max(maxRel, std::abs(a - b) / b);
+            }
+        }
+    }
+    qInfo() << "重排前后结果之差:" << reorderDiff << "秒";
+    qInfo() << "量化偏差: 最大" << maxAbs << "秒, 相对" << maxRel * 100.0 << "%";
+
+    // ---- 陡坡判定：阈值附近的坡度取整到千分比后会落在阈值上，判定必须沿用原始坡度 ----
+    int steepMismatch = 0;
+    for (const QVector<AdjEdge>& list : hilbert)
+    {
+        for (const AdjEdge& e : list)
+        {
+            steepMismatch += (e.steep != AdjEdge::isSteep(snap->edge(e.id)->slope)) ? 1 : 0;
+        }
+    }
+    for (double slope : {0.0496, 0.05, 0.0501, 0.0504, -0.0504, 0.0505})
+    {
+        Edge probe;
+        probe.u = 0;
+        probe.v = 1;
+        probe.distance = 100.0;
+        probe.type = EdgeType::Normal;
+        probe.slope = slope;
+        const WideAdjEdge exact{0, 1, 0, 1, EdgeType::Normal, probe.distance, slope};
+        for (const AdjEdge& e : {AdjEdge::forward(probe), AdjEdge::backward(probe)})
+        {
+            if (e.steep != AdjEdge::isSteep(slope) || std::abs(walkSeconds(e) - walkSeconds(exact)) > 1e-9)
+            {
+                qInfo() << "陡坡判定与原始坡度不一致: 坡度" << slope;
+                steepMismatch++;
+            }
+        }
+    }
+    qInfo() << "陡坡判定不一致:" << steepMismatch << "处";
+
+    // ---- 实际寻路接口 ----
+    QElapsedTimer timer;
+    timer.start();
+    QVector<double> dist;
+    QVector<int> parent;
+    for (int dense : sources)
+    {
+        snap->shortestPathTree(snap->nodes().idAt(dense), TransportMode::Walk, Weather::Sunny, WeightMode::TIME, dist, parent);
+    }
+    qInfo() << "GraphSnapshot::shortestPathTree x" << sources.size() << ":" << timer.elapsed() << "ms";
+
+    // ---- 查询临时内存：先跑一轮让查询上下文长到够用，第二轮应不再向全局堆申请 ----
+    // 统计第二轮的全部堆分配，减去返回的推荐列表自己占用的内存块（列表缓冲区、各条路径、
+    // 非字面量的文字），剩下的就是查询过程中的临时分配，应为 0
+#ifndef BENCH_COUNTS_MALLOC
+    qInfo() << "注意: 非 glibc 环境只统计 operator new，Qt 容器的 malloc 不计入";
+#endif
+    // 一个隐式共享容器持有的堆块数（字面量、空容器的 capacity 为 0，没有堆块）
+    auto ownedBlocks = [](const auto& container) -> qint64 {
+        return container.capacity() > 0 ? 1 : 0;
+    };
+    auto resultBlocks = [&](const QVector<PathRecommendation>& results) {
+        qint64 blocks = ownedBlocks(results);
+        for (const PathRecommendation& r : results)
+        {
+            blocks += ownedBlocks(r.typeName) + ownedBlocks(r.routeLabel) + ownedBlocks(r.pathNodeIds);
+        }
+        return blocks;
+    };
+    QVector<std::pair<int, int>> pairs;
+    for (int i = 0; i + 1 < sources.size(); i += 2)
+    {
+        pairs.append({snap->nodes().idAt(sources[i]), snap->nodes().idAt(sources[i + 1])});
+    }
+    const QTime now(7, 40);
+    const QTime classTime(8, 0);
+    for (TransportMode mode : {TransportMode::Walk, TransportMode::Bus})
+    {
+        QueryContext& ctx = QueryContext::forThread();
+        int routeCount = 0;
+        qint64 resultAllocs = 0;
+        auto runAll = [&]() {
+            for (const auto& pair : pairs)
+            {
+                const QVector<PathRecommendation> results = snap->getMultiStrategyRoutes(
+                    pair.first, pair.second, {}, mode, Weather::Sunny, now, classTime, true);
+                routeCount += results.size();
+                resultAllocs += resultBlocks(results);
+            }
+        };
+        runAll();
+
+        routeCount = 0;
+        resultAllocs = 0;
+        const qint64 heapBefore = g_heapAllocs.load();
+        const qint64 ctxBefore = ctx.heapAllocations();
+        timer.restart();
+        runAll();
+        qint64 elapsed = timer.elapsed();
+        const qint64 heapAllocs = g_heapAllocs.load() - heapBefore;  // 输出日志之前取，qInfo 本身也会分配
+        const qint64 ctxAllocs = ctx.heapAllocations() - ctxBefore;
+        qInfo() << (mode == TransportMode::Walk ? "多策略寻路(步行)" : "多策略寻路(校车)") << "x" << pairs.size()
+                << ":" << elapsed << "ms, 推荐" << routeCount << "条, 堆分配" << heapAllocs << "次 (其中返回结果"
+                << resultAllocs << "块, 查询过程" << heapAllocs - resultAllocs << "次), 查询上下文向堆申请"
+                << ctxAllocs << "次, arena" << ctx.arenaCapacity() / 1024 << "KB";
+    }
+    return 0;
+}
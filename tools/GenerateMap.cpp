@@ -0,0 +1,545 @@
+// ============================================================
+// GenerateMap.cpp - 合成地图生成工具（压力测试用）
+// 生成与 nodes.txt / edges.txt / bus_schedule.csv 格式完全兼容的大规模地图
+//
+// 用法: GenerateMap <grid|geometric|campus> <节点数> <输出目录> [随机种子=1]
+//
+// 三种拓扑：
+//   grid      规则网格，每隔几条是主干道
+//   geometric 随机几何图：随机撒点，连接半径内的邻居（可能不连通）
+//   campus    校园式聚簇：若干片区内部是加密的扰动网格，片区之间由主干道相连
+//
+// 约 1/10 的节点是建筑（Visible，ID 从 100 开始），其余是路口（Ghost，ID 从 10000 开始）。
+// 高程取自一个平滑的丘陵函数，坡度由两端高差算出，因此坡度分布是连续且自洽的。
+// 输出边写边落盘，规模到 10^7 时也只需保存路口坐标。
+// ============================================================
+
+#include "../model/GraphModel.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QStringConverter>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QTime>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 相邻路口的典型间距（像素）
+const double BLOCK_SPACING = 60.0;
+// 每隔多少条网格线是一条主干道
+const int MAIN_ROAD_EVERY = 5;
+const double PI = 3.14159265358979323846;
+
+// 丘陵地形：返回高程（米）
+double terrainZ(double x, double y)
+{
+    return 30.0 + 12.0 * std::sin(x / 250.0) * std::cos(y / 300.0) + 4.0 * std::sin((x + y) / 900.0);
+}
+
+// ============================================================
+// 流式写出节点、道路和时刻表
+// ============================================================
+class MapWriter
+{
+public:
+    bool open(const QString& outDir)
+    {
+        QDir dir(outDir);
+        if (!dir.exists() && !dir.mkpath("."))
+        {
+            qWarning() << "无法创建输出目录:" << outDir;
+            return false;
+        }
+
+        nodeFile.setFileName(dir.filePath("nodes.txt"));
+        edgeFile.setFileName(dir.filePath("edges.txt"));
+        scheduleFile.setFileName(dir.filePath("bus_schedule.csv"));
+        if (!nodeFile.open(QIODevice::WriteOnly | QIODevice::Text) ||
+            !edgeFile.open(QIODevice::WriteOnly | QIODevice::Text) ||
+            !scheduleFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            qWarning() << "无法写入输出文件:" << outDir;
+            return false;
+        }
+
+        nodeOut.setDevice(&nodeFile);
+        edgeOut.setDevice(&edgeFile);
+        scheduleOut.setDevice(&scheduleFile);
+        nodeOut.setEncoding(QStringConverter::Utf8);
+        edgeOut.setEncoding(QStringConverter::Utf8);
+        scheduleOut.setEncoding(QStringConverter::Utf8);
+        return true;
+    }
+
+    bool commit()
+    {
+        nodeOut.flush();
+        edgeOut.flush();
+        scheduleOut.flush();
+        return nodeFile.commit() && edgeFile.commit() && scheduleFile.commit();
+    }
+
+    void writeJunction(int id, double x, double y)
+    {
+        Node n;
+        n.id = id;
+        n.name = QString("路口_%1").arg(id);
+        n.x = x;
+        n.y = y;
+        n.z = terrainZ(x, y);
+        n.type = NodeType::Ghost;
+        n.description = "无";
+        n.category = NodeCategory::Road;
+        nodeOut << GraphModel::formatNodeLine(n) << "\n";
+        nodeCount++;
+    }
+
+    void writeBuilding(int id, double x, double y, NodeCategory category)
+    {
+        Node n;
+        n.id = id;
+        n.name = QString("%1_%2").arg(categoryLabel(category)).arg(id);
+        n.x = x;
+        n.y = y;
+        n.z = terrainZ(x, y);
+        n.type = NodeType::Visible;
+        n.description = "无";
+        n.category = category;
+        nodeOut << GraphModel::formatNodeLine(n) << "\n";
+        nodeCount++;
+    }
+
+    // 距离由坐标算出，坡度 = (终点高程 - 起点高程) / 距离
+    void writeEdge(int u, double ux, double uy, int v, double vx, double vy, EdgeType type)
+    {
+        Edge e;
+        e.u = u;
+        e.v = v;
+        e.distance = std::max(1.0, std::hypot(vx - ux, vy - uy) * Config::METERS_PER_PIXEL);
+        e.type = type;
+        e.slope = std::round((terrainZ(vx, vy) - terrainZ(ux, uy)) / e.distance * 100.0) / 100.0;
+        e.name = "路";
+        edgeOut << GraphModel::formatEdgeLine(e) << "\n";
+        edgeCount++;
+    }
+
+    // 每个校车站一行：站点ID + 当天的发车时间
+    void writeSchedule(int stationId, QRandomGenerator& rng)
+    {
+        QStringList parts;
+        parts << QString::number(stationId);
+
+        QTime t(7, 0);
+        t = t.addSecs(rng.bounded(10) * 60);
+        while (t.isValid() && t < QTime(22, 0))
+        {
+            parts << t.toString("HH:mm");
+            bool peak = (t.hour() >= 7 && t.hour() < 9) || (t.hour() >= 17 && t.hour() < 19);
+            int gapMin = peak ? 8 + rng.bounded(5) : 15 + rng.bounded(10);
+            t = t.addSecs(gapMin * 60);
+        }
+        scheduleOut << parts.join(", ") << "\n";
+        stationCount++;
+    }
+
+    qint64 nodeCount = 0;
+    qint64 edgeCount = 0;
+    int stationCount = 0;
+
+private:
+    QSaveFile nodeFile;
+    QSaveFile edgeFile;
+    QSaveFile scheduleFile;
+    QTextStream nodeOut;
+    QTextStream edgeOut;
+    QTextStream scheduleOut;
+
+    static QString categoryLabel(NodeCategory category)
+    {
+        switch (category)
+        {
+        case NodeCategory::Dorm: return "宿舍";
+        case NodeCategory::Canteen: return "食堂";
+        case NodeCategory::Classroom: return "教学楼";
+        case NodeCategory::Shop: return "商店";
+        case NodeCategory::Playground: return "操场";
+        case NodeCategory::Service: return "服务中心";
+        case NodeCategory::Landmark: return "地标";
+        case NodeCategory::Park: return "公园";
+        case NodeCategory::Gate: return "校门";
+        case NodeCategory::BusStation: return "校车站";
+        default: return "楼";
+        }
+    }
+};
+
+// ============================================================
+// 道路类型分布（参考现有地图：绝大多数是普通道路，约一成台阶）
+// ============================================================
+EdgeType randomMinorType(QRandomGenerator& rng)
+{
+    int r = rng.bounded(100);
+    if (r < 8) return EdgeType::Stairs;
+    if (r < 20) return EdgeType::Path;
+    return EdgeType::Normal;
+}
+
+NodeCategory randomBuildingCategory(QRandomGenerator& rng)
+{
+    int r = rng.bounded(100);
+    if (r < 35) return NodeCategory::Building;
+    if (r < 50) return NodeCategory::Classroom;
+    if (r < 65) return NodeCategory::Dorm;
+    if (r < 73) return NodeCategory::Canteen;
+    if (r < 79) return NodeCategory::Shop;
+    if (r < 85) return NodeCategory::Playground;
+    if (r < 90) return NodeCategory::Service;
+    if (r < 94) return NodeCategory::Landmark;
+    if (r < 97) return NodeCategory::Park;
+    return NodeCategory::Gate;
+}
+
+// ============================================================
+// 建筑生成：挂在路口旁边，用一条短路（室内/小路）接入
+// 校车站只挂在主干道路口上
+// ============================================================
+struct BuildingPlacer
+{
+    MapWriter& out;
+    QRandomGenerator& rng;
+    int nextBuildingId = 100;
+    int stationTarget = 0;      ///< 校车站数量上限
+    double stationChance = 0.0; ///< 主干道旁的建筑成为校车站的概率
+
+    void place(int junctionId, double jx, double jy, bool onMainRoad)
+    {
+        double angle = rng.generateDouble() * 2.0 * PI;
+        double offset = 10.0 + rng.generateDouble() * 15.0;
+        double bx = jx + std::cos(angle) * offset;
+        double by = jy + std::sin(angle) * offset;
+
+        NodeCategory category = randomBuildingCategory(rng);
+        if (onMainRoad && out.stationCount < stationTarget && rng.generateDouble() < stationChance)
+        {
+            category = NodeCategory::BusStation;
+        }
+
+        int id = nextBuildingId++;
+        out.writeBuilding(id, bx, by, category);
+        // 校车站必须能通车，不能用室内通道接入
+        EdgeType link = EdgeType::Normal;
+        if (category != NodeCategory::BusStation)
+        {
+            link = rng.bounded(100) < 30 ? EdgeType::Indoor : EdgeType::Path;
+        }
+        out.writeEdge(id, bx, by, junctionId, jx, jy, link);
+
+        if (category == NodeCategory::BusStation)
+        {
+            out.writeSchedule(id, rng);
+        }
+    }
+};
+
+// ============================================================
+// 规则网格
+// ============================================================
+void generateGrid(MapWriter& out, BuildingPlacer& buildings, qint64 junctionCount, qint64 buildingCount, int firstRoadId)
+{
+    QRandomGenerator& rng = buildings.rng;
+    int side = std::max(2, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(junctionCount)))));
+    int rows = static_cast<int>((junctionCount + side - 1) / side);
+    double buildingChance = static_cast<double>(buildingCount) / std::max<qint64>(1, junctionCount);
+
+    auto idAt = [&](int r, int c) { return firstRoadId + r * side + c; };
+
+    qint64 written = 0;
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < side && written < junctionCount; ++c, ++written)
+        {
+            double x = c * BLOCK_SPACING;
+            double y = r * BLOCK_SPACING;
+            out.writeJunction(idAt(r, c), x, y);
+
+            bool mainRow = (r % MAIN_ROAD_EVERY == 0);
+            bool mainCol = (c % MAIN_ROAD_EVERY == 0);
+
+            if (c > 0)
+            {
+                out.writeEdge(idAt(r, c - 1), x - BLOCK_SPACING, y, idAt(r, c), x, y,
+                              mainRow ? EdgeType::Main : randomMinorType(rng));
+            }
+            if (r > 0)
+            {
+                out.writeEdge(idAt(r - 1, c), x, y - BLOCK_SPACING, idAt(r, c), x, y,
+                              mainCol ? EdgeType::Main : randomMinorType(rng));
+            }
+            if (rng.generateDouble() < buildingChance)
+            {
+                buildings.place(idAt(r, c), x, y, mainRow || mainCol);
+            }
+        }
+    }
+}
+
+// ============================================================
+// 随机几何图
+// 在正方形里均匀撒点，按网格分桶后连接半径内的邻居（每点最多 4 条）
+// ============================================================
+void generateGeometric(MapWriter& out, BuildingPlacer& buildings, qint64 junctionCount, qint64 buildingCount, int firstRoadId)
+{
+    QRandomGenerator& rng = buildings.rng;
+    const int n = static_cast<int>(junctionCount);
+    const double side = std::sqrt(static_cast<double>(n)) * BLOCK_SPACING;
+    // 期望邻居数约为 3：pi * r^2 * 密度 = 3
+    const double radius = std::sqrt(3.0 * BLOCK_SPACING * BLOCK_SPACING / PI);
+    const int cells = std::max(1, static_cast<int>(side / radius));
+    const double cellSize = side / cells;
+
+    QVector<float> xs(n), ys(n);
+    for (int i = 0; i < n; ++i)
+    {
+        xs[i] = static_cast<float>(rng.generateDouble() * side);
+        ys[i] = static_cast<float>(rng.generateDouble() * side);
+    }
+
+    // 计数排序分桶：cellStart[c] .. cellStart[c+1] 是第 c 个格子里的点
+    auto cellOf = [&](int i) {
+        int cx = std::min(cells - 1, static_cast<int>(xs[i] / cellSize));
+        int cy = std::min(cells - 1, static_cast<int>(ys[i] / cellSize));
+        return cy * cells + cx;
+    };
+    QVector<int> cellStart(cells * cells + 1, 0);
+    for (int i = 0; i < n; ++i)
+    {
+        cellStart[cellOf(i) + 1]++;
+    }
+    for (int c = 0; c < cells * cells; ++c)
+    {
+        cellStart[c + 1] += cellStart[c];
+    }
+    QVector<int> order(n);
+    {
+        QVector<int> fill = cellStart;
+        for (int i = 0; i < n; ++i)
+        {
+            order[fill[cellOf(i)]++] = i;
+        }
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        out.writeJunction(firstRoadId + i, xs[i], ys[i]);
+    }
+
+    // 横纵坐标落在主干带上的边设为主干道
+    const double mainBand = BLOCK_SPACING * MAIN_ROAD_EVERY;
+    auto isMainAt = [&](double x, double y) {
+        return std::fmod(x, mainBand) < radius * 0.5 || std::fmod(y, mainBand) < radius * 0.5;
+    };
+
+    double buildingChance = static_cast<double>(buildingCount) / std::max(1, n);
+    for (int i = 0; i < n; ++i)
+    {
+        int cx = std::min(cells - 1, static_cast<int>(xs[i] / cellSize));
+        int cy = std::min(cells - 1, static_cast<int>(ys[i] / cellSize));
+        int degree = 0;
+
+        for (int dy = -1; dy <= 1 && degree < 4; ++dy)
+        {
+            for (int dx = -1; dx <= 1 && degree < 4; ++dx)
+            {
+                int nx = cx + dx, ny = cy + dy;
+                if (nx < 0 || ny < 0 || nx >= cells || ny >= cells)
+                {
+                    continue;
+                }
+                int c = ny * cells + nx;
+                for (int k = cellStart[c]; k < cellStart[c + 1] && degree < 4; ++k)
+                {
+                    int j = order[k];
+                    if (j <= i)
+                    {
+                        continue;  // 每对只连一次
+                    }
+                    if (std::hypot(xs[j] - xs[i], ys[j] - ys[i]) > radius)
+                    {
+                        continue;
+                    }
+                    bool main = isMainAt(xs[i], ys[i]) && isMainAt(xs[j], ys[j]);
+                    out.writeEdge(firstRoadId + i, xs[i], ys[i], firstRoadId + j, xs[j], ys[j],
+                                  main ? EdgeType::Main : randomMinorType(rng));
+                    degree++;
+                }
+            }
+        }
+
+        if (rng.generateDouble() < buildingChance)
+        {
+            buildings.place(firstRoadId + i, xs[i], ys[i], isMainAt(xs[i], ys[i]));
+        }
+    }
+}
+
+// ============================================================
+// 校园式聚簇
+// 每个片区是一块扰动网格（约 200 个路口），片区中心排成稀疏网格，
+// 相邻片区的"校门"路口之间用主干道相连
+// ============================================================
+void generateCampus(MapWriter& out, BuildingPlacer& buildings, qint64 junctionCount, qint64 buildingCount, int firstRoadId)
+{
+    QRandomGenerator& rng = buildings.rng;
+    const int clusterSide = 14;                       // 片区内 14x14 的网格
+    const int perCluster = clusterSide * clusterSide;
+    const int clusterCount = static_cast<int>(std::max<qint64>(1, junctionCount / perCluster));
+    const int clustersPerRow = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(clusterCount)))));
+    const double clusterPitch = clusterSide * BLOCK_SPACING * 1.8;   // 片区之间留出空地
+    const double jitter = BLOCK_SPACING * 0.25;
+    double buildingChance = static_cast<double>(buildingCount) / std::max<qint64>(1, junctionCount);
+
+    // 每个片区只需记住它的校门（左上角路口）用于片区间连线
+    struct Gate { int id; double x, y; };
+    QVector<Gate> gates(clusterCount);
+
+    QVector<double> xs(perCluster), ys(perCluster);
+    int nextId = firstRoadId;
+    qint64 remaining = junctionCount;
+
+    for (int k = 0; k < clusterCount; ++k)
+    {
+        double ox = (k % clustersPerRow) * clusterPitch + rng.generateDouble() * BLOCK_SPACING * 3;
+        double oy = (k / clustersPerRow) * clusterPitch + rng.generateDouble() * BLOCK_SPACING * 3;
+
+        // 最后一个片区吃掉所有剩余路口，保证总数精确
+        int count = (k == clusterCount - 1) ? static_cast<int>(remaining) : perCluster;
+        int side = (k == clusterCount - 1)
+            ? std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count)))))
+            : clusterSide;
+        if (xs.size() < count)
+        {
+            xs.resize(count);
+            ys.resize(count);
+        }
+        int base = nextId;
+
+        for (int i = 0; i < count; ++i)
+        {
+            int r = i / side, c = i % side;
+            xs[i] = ox + c * BLOCK_SPACING + (rng.generateDouble() - 0.5) * jitter;
+            ys[i] = oy + r * BLOCK_SPACING + (rng.generateDouble() - 0.5) * jitter;
+            out.writeJunction(base + i, xs[i], ys[i]);
+
+            // 片区内：外圈是主干道，内部随机缺失约 15% 的道路，形成不规则街区
+            bool ring = (r == 0 || c == 0 || r == side - 1 || c == side - 1);
+            if (c > 0 && (ring || rng.bounded(100) >= 15))
+            {
+                out.writeEdge(base + i - 1, xs[i - 1], ys[i - 1], base + i, xs[i], ys[i],
+                              (r == 0 || r == side - 1) ? EdgeType::Main : randomMinorType(rng));
+            }
+            if (r > 0 && (ring || rng.bounded(100) >= 15))
+            {
+                out.writeEdge(base + i - side, xs[i - side], ys[i - side], base + i, xs[i], ys[i],
+                              (c == 0 || c == side - 1) ? EdgeType::Main : randomMinorType(rng));
+            }
+            if (rng.generateDouble() < buildingChance)
+            {
+                buildings.place(base + i, xs[i], ys[i], ring);
+            }
+        }
+
+        gates[k] = { base, xs[0], ys[0] };
+        nextId += count;
+        remaining -= count;
+
+        // 与左边、上边的片区相连
+        int col = k % clustersPerRow;
+        if (col > 0)
+        {
+            const Gate& g = gates[k - 1];
+            out.writeEdge(g.id, g.x, g.y, base, xs[0], ys[0], EdgeType::Main);
+        }
+        if (k >= clustersPerRow)
+        {
+            const Gate& g = gates[k - clustersPerRow];
+            out.writeEdge(g.id, g.x, g.y, base, xs[0], ys[0], EdgeType::Main);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+
+    if (args.size() < 4)
+    {
+        qInfo() << "用法: GenerateMap <grid|geometric|campus> <节点数> <输出目录> [随机种子=1]";
+        return 1;
+    }
+
+    const QString kind = args[1];
+    const qint64 total = args[2].toLongLong();
+    quint32 seed = args.size() > 4 ? args[4].toUInt() : 1;
+
+    if (total < 10 || total > 20000000)
+    {
+        qInfo() << "节点数应在 10 到 2000 万之间";
+        return 1;
+    }
+    if (kind != "grid" && kind != "geometric" && kind != "campus")
+    {
+        qInfo() << "未知的拓扑类型:" << kind;
+        return 1;
+    }
+
+    MapWriter out;
+    if (!out.open(args[3]))
+    {
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 约 1/10 是建筑；建筑 ID 从 100 起，路口 ID 从 10000 起（建筑很多时顺延，避免重叠）
+    const qint64 buildingCount = std::max<qint64>(1, total / 10);
+    const qint64 junctionCount = total - buildingCount;
+    const int firstRoadId = static_cast<int>(std::max<qint64>(10000, 100 + buildingCount * 2));
+
+    QRandomGenerator rng(seed);
+    BuildingPlacer buildings{ out, rng };
+    // 大约每 2000 个节点一个校车站，2 ~ 200 个（换乘枚举是站点数的平方，再多没有意义）
+    buildings.stationTarget = static_cast<int>(std::clamp<qint64>(total / 2000, 2, 200));
+    buildings.stationChance = std::min(1.0, buildings.stationTarget * 8.0 / buildingCount);
+
+    if (kind == "grid")
+    {
+        generateGrid(out, buildings, junctionCount, buildingCount, firstRoadId);
+    }
+    else if (kind == "geometric")
+    {
+        generateGeometric(out, buildings, junctionCount, buildingCount, firstRoadId);
+    }
+    else
+    {
+        generateCampus(out, buildings, junctionCount, buildingCount, firstRoadId);
+    }
+
+    if (!out.commit())
+    {
+        qWarning() << "写入输出文件失败";
+        return 1;
+    }
+
+    qInfo() << "生成完成:" << kind << "节点" << out.nodeCount << "条道路" << out.edgeCount
+            << "校车站" << out.stationCount << "耗时" << timer.elapsed() << "ms";
+    return 0;
+}
@@ -0,0 +1,539 @@
+// ============================================================
+// OsmImport.cpp - OpenStreetMap 导入工具
+// 流式读取本地 .osm (XML) 文件，按 highway 标签筛选道路，
+// 投影到 0.91 米/像素 的地图坐标，直接写出 nodes.txt / edges.txt
+//
+// 用法: OsmImport <输入.osm> <nodes.txt> <edges.txt>
+//
+// 两遍扫描，内存只与被道路引用的节点数有关：
+//   第1遍：只看 <way>，统计每个节点被道路引用的次数（>=2 即路口）
+//   第2遍：记录被引用节点的经纬度，逐条 <way> 在路口处切段并立即写出道路
+// 路口之间的形状点只用于累加距离，不会成为节点
+// ============================================================
+
+#include "../model/GraphModel.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QStringConverter>
+#include <QXmlStreamReader>
+#include <QElapsedTimer>
+#include <QPointF>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace {
+
+// 每度纬度 / 经度(赤道) 对应的米数
+const double METERS_PER_DEG_LAT = 110540.0;
+const double METERS_PER_DEG_LON = 111320.0;
+// 建筑/设施点自动接入最近路口的最大距离（米）
+const double POI_SNAP_RADIUS = 60.0;
+const double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+
+struct LatLon
+{
+    double lat = 0.0;
+    double lon = 0.0;
+};
+
+// 一条 OSM way（只保留导入需要的字段）
+struct OsmWay
+{
+    QVector<qint64> refs;
+    QString highway;
+    QString name;
+};
+
+// 带标签的 OSM 点（用于识别建筑/设施）
+struct OsmPoi
+{
+    qint64 id = 0;
+    LatLon pos;
+    QString name;
+    NodeCategory category = NodeCategory::None;
+};
+
+// ============================================================
+// highway 标签 -> 道路类型
+// 返回 false 表示这类 way 不导入（施工中、规划中等）
+// ============================================================
+bool highwayToEdgeType(const QString& highway, EdgeType& type)
+{
+    static const QHash<QString, EdgeType> mapping = {
+        { "footway", EdgeType::Path },       { "pedestrian", EdgeType::Path },
+        { "path", EdgeType::Path },          { "cycleway", EdgeType::Path },
+        { "track", EdgeType::Path },         { "bridleway", EdgeType::Path },
+        { "steps", EdgeType::Stairs },
+        { "corridor", EdgeType::Indoor },
+        { "motorway", EdgeType::Main },      { "motorway_link", EdgeType::Main },
+        { "trunk", EdgeType::Main },         { "trunk_link", EdgeType::Main },
+        { "primary", EdgeType::Main },       { "primary_link", EdgeType::Main },
+        { "secondary", EdgeType::Main },     { "secondary_link", EdgeType::Main },
+        { "tertiary", EdgeType::Main },      { "tertiary_link", EdgeType::Main },
+        { "residential", EdgeType::Normal }, { "service", EdgeType::Normal },
+        { "unclassified", EdgeType::Normal },{ "living_street", EdgeType::Normal },
+        { "road", EdgeType::Normal }
+    };
+
+    auto it = mapping.constFind(highway);
+    if (it == mapping.constEnd())
+    {
+        return false;
+    }
+    type = it.value();
+    return true;
+}
+
+// ============================================================
+// 点标签 -> 节点分类（无名或无法识别的点返回 None）
+// ============================================================
+NodeCategory tagsToCategory(const QHash<QString, QString>& tags)
+{
+    QString amenity = tags.value("amenity");
+    if (amenity == "restaurant" || amenity == "cafe" || amenity == "fast_food" || amenity == "food_court") return NodeCategory::Canteen;
+    if (amenity == "university" || amenity == "college" || amenity == "school") return NodeCategory::Classroom;
+    if (amenity == "bus_station" || tags.value("highway") == "bus_stop") return NodeCategory::BusStation;
+    if (amenity == "library" || amenity == "hospital" || amenity == "clinic" || amenity == "post_office" || amenity == "bank") return NodeCategory::Service;
+    if (tags.contains("shop")) return NodeCategory::Shop;
+    if (tags.value("tourism") == "hotel") return NodeCategory::Hotel;
+    if (tags.value("building") == "dormitory") return NodeCategory::Dorm;
+
+    QString leisure = tags.value("leisure");
+    if (leisure == "park" || leisure == "garden") return NodeCategory::Park;
+    if (leisure == "pitch" || leisure == "sports_centre" || leisure == "stadium") return NodeCategory::Playground;
+    if (tags.contains("historic") || tags.value("tourism") == "attraction") return NodeCategory::Landmark;
+    if (tags.contains("building")) return NodeCategory::Building;
+    return NodeCategory::None;
+}
+
+// 名称要写进逗号分隔的行：逗号换成全角逗号，换行换成空格，否则列会错位
+QString sanitizeName(const QString& name)
+{
+    QString s = name;
+    s.replace(QLatin1Char(','), QChar(0xFF0C));
+    s.replace(QLatin1Char('\r'), QLatin1Char(' '));
+    s.replace(QLatin1Char('\n'), QLatin1Char(' '));
+    return s.trimmed();
+}
+
+// 两点间近似距离（米），城区范围内等距圆柱投影足够精确
+double distanceMeters(const LatLon& a, const LatLon& b)
+{
+    double meanLat = (a.lat + b.lat) * 0.5 * DEG_TO_RAD;
+    double dx = (b.lon - a.lon) * std::cos(meanLat) * METERS_PER_DEG_LON;
+    double dy = (b.lat - a.lat) * METERS_PER_DEG_LAT;
+    return std::hypot(dx, dy);
+}
+
+// ============================================================
+// 流式扫描 .osm 文件
+// wantNodes=false 时完全跳过 <node>，第1遍因此很快
+// ============================================================
+bool scanOsm(const QString& path,
+             bool wantNodes,
+             const std::function<void(qint64, const LatLon&, const QHash<QString, QString>&)>& onNode,
+             const std::function<void(const OsmWay&)>& onWay)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "无法打开 OSM 文件:" << path;
+        return false;
+    }
+
+    QXmlStreamReader xml(&file);
+
+    bool inNode = false;
+    bool inWay = false;
+    qint64 nodeId = 0;
+    LatLon nodePos;
+    QHash<QString, QString> nodeTags;
+    OsmWay way;
+
+    while (!xml.atEnd())
+    {
+        QXmlStreamReader::TokenType token = xml.readNext();
+
+        if (token == QXmlStreamReader::StartElement)
+        {
+            QStringView name = xml.name();
+            QXmlStreamAttributes attrs = xml.attributes();
+
+            if (name == QLatin1String("node"))
+            {
+                if (!wantNodes)
+                {
+                    xml.skipCurrentElement();
+                    continue;
+                }
+                inNode = true;
+                nodeId = attrs.value(QLatin1String("id")).toLongLong();
+                nodePos.lat = attrs.value(QLatin1String("lat")).toDouble();
+                nodePos.lon = attrs.value(QLatin1String("lon")).toDouble();
+                nodeTags.clear();
+            }
+            else if (name == QLatin1String("way"))
+            {
+                inWay = true;
+                way.refs.clear();
+                way.highway.clear();
+                way.name.clear();
+            }
+            else if (name == QLatin1String("nd") && inWay)
+            {
+                way.refs.append(attrs.value(QLatin1String("ref")).toLongLong());
+            }
+            else if (name == QLatin1String("tag"))
+            {
+                QString key = attrs.value(QLatin1String("k")).toString();
+                if (inWay)
+                {
+                    if (key == "highway") way.highway = attrs.value(QLatin1String("v")).toString();
+                    else if (key == "name") way.name = attrs.value(QLatin1String("v")).toString();
+                }
+                else if (inNode)
+                {
+                    nodeTags.insert(key, attrs.value(QLatin1String("v")).toString());
+                }
+            }
+            else if (name == QLatin1String("relation"))
+            {
+                xml.skipCurrentElement();  // 关系不参与导入
+            }
+        }
+        else if (token == QXmlStreamReader::EndElement)
+        {
+            QStringView name = xml.name();
+            if (name == QLatin1String("node") && inNode)
+            {
+                onNode(nodeId, nodePos, nodeTags);
+                inNode = false;
+            }
+            else if (name == QLatin1String("way") && inWay)
+            {
+                onWay(way);
+                inWay = false;
+            }
+        }
+    }
+
+    if (xml.hasError())
+    {
+        qWarning() << "OSM 解析错误:" << xml.errorString() << "行" << xml.lineNumber();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+
+    if (args.size() < 4)
+    {
+        qInfo() << "用法: OsmImport <输入.osm> <nodes.txt> <edges.txt>";
+        qInfo() << "      .osm.pbf 请先转换为 XML，例如: osmium cat in.osm.pbf -o in.osm";
+        return 1;
+    }
+
+    const QString osmPath = args[1];
+    QElapsedTimer timer;
+    timer.start();
+
+    // ---- 第1遍：统计道路对节点的引用次数 ----
+    // 端点额外 +1，保证每条道路的两端都成为路口
+    QHash<qint64, int> refCount;
+    int wayCount = 0;
+    bool ok = scanOsm(osmPath, false,
+        [](qint64, const LatLon&, const QHash<QString, QString>&) {},
+        [&](const OsmWay& way) {
+            EdgeType type;
+            if (way.refs.size() < 2 || !highwayToEdgeType(way.highway, type))
+            {
+                return;
+            }
+            wayCount++;
+            for (qint64 ref : way.refs)
+            {
+                refCount[ref]++;
+            }
+            refCount[way.refs.first()]++;
+            refCount[way.refs.last()]++;
+        });
+    if (!ok)
+    {
+        return 1;
+    }
+    qInfo() << "第1遍完成: 道路" << wayCount << "条, 引用节点" << refCount.size() << "个," << timer.elapsed() << "ms";
+
+    // ---- 第2遍：记录坐标，切段写出道路 ----
+    QSaveFile edgeFile(args[3]);
+    if (!edgeFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning() << "无法写入道路文件:" << args[3];
+        return 1;
+    }
+    QTextStream edgeOut(&edgeFile);
+    edgeOut.setEncoding(QStringConverter::Utf8);
+
+    QHash<qint64, LatLon> coords;       // 被道路引用的节点坐标
+    QVector<OsmPoi> pois;               // 有名字的建筑/设施点
+    QHash<qint64, int> junctionIds;     // OSM 节点 -> 路口 ID
+    QVector<qint64> junctionOrder;      // 按 ID 顺序记录路口
+    QSet<quint64> emittedPairs;         // 已写出的路口对（平行道路只保留第一条）
+    int firstRoadId = -1;               // 路口 ID 起点，第一个路口出现时确定
+    int nextRoadId = -1;
+    int edgeCount = 0;
+
+    // 建筑 ID 从 100 起，路口 ID 从建筑之后起（至少 10000，与 GenerateMap 一致）；
+    // OSM 文件中 <node> 排在 <way> 之前，第一个路口出现时建筑已全部收集
+    auto roadIdBase = [&]() {
+        return static_cast<int>(std::max<qint64>(10000, 100 + qint64(pois.size()) * 2));
+    };
+
+    auto junctionIdOf = [&](qint64 osmId) {
+        auto it = junctionIds.constFind(osmId);
+        if (it != junctionIds.constEnd())
+        {
+            return it.value();
+        }
+        if (firstRoadId < 0)
+        {
+            firstRoadId = roadIdBase();
+            nextRoadId = firstRoadId;
+        }
+        int id = nextRoadId++;
+        junctionIds.insert(osmId, id);
+        junctionOrder.append(osmId);
+        return id;
+    };
+
+    ok = scanOsm(osmPath, true,
+        [&](qint64 id, const LatLon& pos, const QHash<QString, QString>& tags) {
+            if (refCount.contains(id))
+            {
+                coords.insert(id, pos);
+            }
+            QString name = tags.value("name");
+            if (!name.isEmpty())
+            {
+                NodeCategory category = tagsToCategory(tags);
+                if (category != NodeCategory::None)
+                {
+                    pois.append({ id, pos, name, category });
+                }
+            }
+        },
+        [&](const OsmWay& way) {
+            EdgeType type;
+            if (way.refs.size() < 2 || !highwayToEdgeType(way.highway, type))
+            {
+                return;
+            }
+
+            qint64 segStart = -1;
+            double segLength = 0.0;
+            LatLon prev;
+
+            for (qint64 ref : way.refs)
+            {
+                auto c = coords.constFind(ref);
+                if (c == coords.constEnd())
+                {
+                    // 节点不在导出范围内：丢弃当前这一段
+                    segStart = -1;
+                    continue;
+                }
+                bool isJunction = refCount.value(ref) >= 2;
+
+                if (segStart == -1)
+                {
+                    if (isJunction)
+                    {
+                        segStart = ref;
+                        segLength = 0.0;
+                        prev = c.value();
+                    }
+                    continue;
+                }
+
+                segLength += distanceMeters(prev, c.value());
+                prev = c.value();
+
+                if (isJunction)
+                {
+                    if (ref != segStart)
+                    {
+                        int u = junctionIdOf(segStart);
+                        int v = junctionIdOf(ref);
+                        quint64 key = (static_cast<quint64>(std::min(u, v)) << 32) | static_cast<quint32>(std::max(u, v));
+                        if (!emittedPairs.contains(key))
+                        {
+                            emittedPairs.insert(key);
+
+                            Edge e;
+                            e.u = u;
+                            e.v = v;
+                            e.distance = segLength;
+                            e.type = type;
+                            e.slope = 0.0;
+                            QString roadName = sanitizeName(way.name);
+                            e.name = roadName.isEmpty() ? QString("路") : roadName;
+                            edgeOut << GraphModel::formatEdgeLine(e) << "\n";
+                            edgeCount++;
+                        }
+                    }
+                    segStart = ref;
+                    segLength = 0.0;
+                }
+            }
+        });
+    if (!ok)
+    {
+        return 1;
+    }
+    if (firstRoadId < 0)
+    {
+        firstRoadId = roadIdBase();
+    }
+
+    // ---- 投影：以左上角为原点，1 像素 = 0.91 米 ----
+    double minLon = std::numeric_limits<double>::max();
+    double maxLat = std::numeric_limits<double>::lowest();
+    double minLat = std::numeric_limits<double>::max();
+    for (qint64 osmId : junctionOrder)
+    {
+        const LatLon& p = coords[osmId];
+        minLon = std::min(minLon, p.lon);
+        maxLat = std::max(maxLat, p.lat);
+        minLat = std::min(minLat, p.lat);
+    }
+    double cosLat = std::cos((minLat + maxLat) * 0.5 * DEG_TO_RAD);
+
+    auto project = [&](const LatLon& p, double& x, double& y) {
+        x = (p.lon - minLon) * cosLat * METERS_PER_DEG_LON / Config::METERS_PER_PIXEL;
+        y = (maxLat - p.lat) * METERS_PER_DEG_LAT / Config::METERS_PER_PIXEL;
+    };
+
+    // ---- 写出节点：路口为 Ghost，建筑/设施为 Visible ----
+    QSaveFile nodeFile(args[2]);
+    if (!nodeFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning() << "无法写入节点文件:" << args[2];
+        return 1;
+    }
+    QTextStream nodeOut(&nodeFile);
+    nodeOut.setEncoding(QStringConverter::Utf8);
+
+    // 路口按网格分桶，用于把建筑接入最近的路口
+    const double cellPx = POI_SNAP_RADIUS / Config::METERS_PER_PIXEL;
+    QHash<quint64, QVector<int>> junctionGrid;
+    QVector<QPointF> junctionPos(junctionOrder.size());
+    auto cellKey = [](int cx, int cy) {
+        return (static_cast<quint64>(static_cast<quint32>(cx)) << 32) | static_cast<quint32>(cy);
+    };
+
+    for (int i = 0; i < junctionOrder.size(); ++i)
+    {
+        Node n;
+        n.id = firstRoadId + i;
+        n.name = QString("路口_%1").arg(n.id);
+        project(coords[junctionOrder[i]], n.x, n.y);
+        n.z = 30.0;
+        n.type = NodeType::Ghost;
+        n.description = "无";
+        n.category = NodeCategory::Road;
+        nodeOut << GraphModel::formatNodeLine(n) << "\n";
+
+        junctionPos[i] = QPointF(n.x, n.y);
+        int cx = static_cast<int>(std::floor(n.x / cellPx));
+        int cy = static_cast<int>(std::floor(n.y / cellPx));
+        junctionGrid[cellKey(cx, cy)].append(i);
+    }
+
+    int poiCount = 0;
+    int nextBuildingId = 100;
+    for (const OsmPoi& poi : pois)
+    {
+        Node n;
+        if (nextBuildingId >= firstRoadId)
+        {
+            // 只有 <node> 出现在 <way> 之后（未排序的文件）才会发生
+            qWarning() << "建筑 ID 与路口 ID 重叠: 建筑" << pois.size() << "个, 路口 ID 从" << firstRoadId
+                       << "起。请先排序 OSM 文件，例如: osmium sort in.osm -o sorted.osm";
+            return 1;
+        }
+        n.id = nextBuildingId++;
+        n.name = sanitizeName(poi.name);
+        if (n.name.isEmpty())
+        {
+            n.name = QString("建筑_%1").arg(n.id);
+        }
+        project(poi.pos, n.x, n.y);
+        n.z = 30.0;
+        n.type = NodeType::Visible;
+        n.description = "无";
+        n.category = poi.category;
+
+        // 在周围 3x3 个格子里找最近的路口
+        int cx = static_cast<int>(std::floor(n.x / cellPx));
+        int cy = static_cast<int>(std::floor(n.y / cellPx));
+        int best = -1;
+        double bestDist = cellPx;
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                const QVector<int> bucket = junctionGrid.value(cellKey(cx + dx, cy + dy));
+                for (int j : bucket)
+                {
+                    double d = std::hypot(junctionPos[j].x() - n.x, junctionPos[j].y() - n.y);
+                    if (d < bestDist)
+                    {
+                        bestDist = d;
+                        best = j;
+                    }
+                }
+            }
+        }
+        if (best == -1)
+        {
+            continue;  // 附近没有道路，导入了也无法到达
+        }
+
+        nodeOut << GraphModel::formatNodeLine(n) << "\n";
+
+        Edge e;
+        e.u = n.id;
+        e.v = firstRoadId + best;
+        e.distance = bestDist * Config::METERS_PER_PIXEL;
+        e.type = EdgeType::Path;
+        e.slope = 0.0;
+        e.name = "路";
+        edgeOut << GraphModel::formatEdgeLine(e) << "\n";
+        edgeCount++;
+        poiCount++;
+    }
+
+    nodeOut.flush();
+    edgeOut.flush();
+    if (!nodeFile.commit() || !edgeFile.commit())
+    {
+        qWarning() << "写入输出文件失败";
+        return 1;
+    }
+
+    qInfo() << "导入完成: 路口" << junctionOrder.size() << "个, 建筑" << poiCount
+            << "个, 道路" << edgeCount << "条, 耗时" << timer.elapsed() << "ms";
+    return 0;
+}
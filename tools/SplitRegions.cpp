@@ -0,0 +1,45 @@
+// ============================================================
+// SplitRegions.cpp - 地图分区切分工具
+// 把完整的 nodes.txt / edges.txt 按网格切成分区文件和索引，
+// 供主程序在分区模式下按需加载；描述单独写进描述文件，显示时才读
+//
+// 用法: SplitRegions <nodes.txt> <edges.txt> <输出目录> [网格边长=500]
+// ============================================================
+
+#include "../model/GraphModel.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <QDebug>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+
+    if (args.size() < 4)
+    {
+        qInfo() << "用法: SplitRegions <nodes.txt> <edges.txt> <输出目录> [网格边长=500]";
+        return 1;
+    }
+
+    double cellSize = 500.0;
+    if (args.size() > 4)
+    {
+        cellSize = args[4].toDouble();
+    }
+
+    GraphModel model;
+    if (!model.loadData(args[1], args[2]))
+    {
+        return 1;
+    }
+
+    if (!model.saveRegions(args[3], cellSize))
+    {
+        qInfo() << "切分失败";
+        return 1;
+    }
+
+    qInfo() << "切分完成:" << args[3];
+    return 0;
+}
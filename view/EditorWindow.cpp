@@ -1,5 +1,8 @@
 #include "EditorWindow.h"
 #include <QtWidgets/QMessageBox>
+#include <QtWidgets/QStatusBar>
+#include <QtWidgets/QFileDialog>
+#include <QtCore/QFileInfo>
 #include <QtCore/QCoreApplication>
 #include <cmath>
 
@@ -53,6 +56,16 @@ EditorWindow::EditorWindow(GraphModel* sharedModel, QWidget *parent)
     // 5. 撤销操作
     connect(mapWidget, &MapWidget::undoRequested, this, &EditorWindow::onUndoRequested, Qt::QueuedConnection);
 
+    // 6. 后台保存状态 -> 状态栏
+    connect(model->saveScheduler(), &SaveScheduler::statsChanged, this, &EditorWindow::onSaveStatsChanged);
+
+    // 7. 模型提交一批编辑 -> 只按变化更新场景
+    connect(model->notifier(), &GraphNotifier::graphChanged, this, &EditorWindow::onGraphChanged);
+
+    // 8. 框选 / 整组拖动 -> 批量面板与批量平移
+    connect(mapWidget, &MapWidget::selectionChanged, this, &EditorWindow::onSelectionChanged);
+    connect(mapWidget, &MapWidget::nodesMoved, this, &EditorWindow::onNodesMoved);
+
     // 初始化地图显示
     refreshMap();
     
@@ -62,14 +75,100 @@ EditorWindow::EditorWindow(GraphModel* sharedModel, QWidget *parent)
 
 // ============================================================
 // 刷新地图显示
-// 从模型中加载最新的节点和边数据
+// 从模型中加载最新的节点和边数据（仅用于初始化，编辑后走增量更新）
 // ============================================================
 void EditorWindow::refreshMap()
 {
     if (model && mapWidget)
     {
-        mapWidget->drawMap(model->getAllNodes(), model->getAllEdges());
+        mapWidget->drawMap(*model->snapshot());
+    }
+}
+
+// ============================================================
+// 模型提交了一批编辑（包括热重载的外部修改）
+// 交给地图按变化增量更新
+// ============================================================
+void EditorWindow::onGraphChanged(const GraphDiff& diff)
+{
+    if (!mapWidget) return;
+
+    mapWidget->applyGraphDiff(diff, model);
+
+    // 连通性高亮打开时随编辑更新（增删道路都可能改变孤岛和桥）
+    if (btnConnectivity->isChecked()) refreshConnectivityHighlight();
+}
+
+// ============================================================
+// 拓扑清理：合并重叠路口、在交叉处补路口
+// 先列出方案供确认，确认后作为一批编辑执行（可一次撤销）
+// ============================================================
+void EditorWindow::onTopologyClean()
+{
+    TopologyPlan plan = TopologyCleaner::plan(model->getAllNodes(), model->getAllEdges());
+    if (plan.isEmpty()) {
+        statusLabel->setText("拓扑检查通过：没有重叠节点或无路口的交叉");
+        return;
+    }
+
+    QMessageBox box(this);
+    box.setWindowTitle("拓扑清理");
+    box.setText(QString("将合并 %1 个重叠节点，新建 %2 个路口，切开 %3 条道路。")
+                    .arg(plan.merges.size()).arg(plan.junctions.size()).arg(plan.splits.size()));
+    box.setInformativeText("整批修改可一次撤销。展开详情查看每一项。");
+    box.setDetailedText(plan.describe().join("\n"));
+    box.setStandardButtons(QMessageBox::Apply | QMessageBox::Cancel);
+    if (box.exec() != QMessageBox::Apply) return;
+
+    GraphDiff diff = model->applyTopologyPlan(plan);
+    statusLabel->setText(QString("拓扑清理完成：节点 +%1 -%2，道路 +%3 -%4")
+                             .arg(diff.addedNodes.size()).arg(diff.removedNodes.size())
+                             .arg(diff.addedEdges.size()).arg(diff.removedEdges.size()));
+}
+
+// ============================================================
+// 导入草稿：选择节点草稿，同目录下的道路草稿（nodes -> edges）一并导入
+// 导入成功后草稿被改名为 *.imported，再点一次不会重复导入
+// ============================================================
+void EditorWindow::onImportDraft()
+{
+    QString nodesPath = QFileDialog::getOpenFileName(this, "选择节点草稿", QString("nodes_draft.txt"),
+                                                     "草稿文件 (*.txt);;所有文件 (*)");
+    if (nodesPath.isEmpty()) return;
+
+    QFileInfo info(nodesPath);
+    QString edgesName = info.fileName();
+    edgesName.replace("nodes", "edges");
+    QString edgesPath = info.dir().filePath(edgesName);
+
+    int count = model->importDraft(nodesPath, edgesPath);
+    if (count < 0) {
+        QMessageBox::warning(this, "导入草稿", "无法读取草稿文件：" + nodesPath);
+        return;
     }
+    statusLabel->setText(QString("草稿导入完成：节点 %1 个（可一次撤销）").arg(count));
+    emit dataChanged();
+}
+
+// ============================================================
+// 连通性分析：孤岛（不在主路网上的节点）与桥（断开即分裂路网的道路）
+// ============================================================
+void EditorWindow::refreshConnectivityHighlight()
+{
+    if (!btnConnectivity->isChecked()) {
+        mapWidget->setConnectivityHighlight(QSet<int>(), QSet<int>());
+        statusLabel->setText("已关闭连通性高亮");
+        return;
+    }
+
+    ConnectivityProfile profile = (connectivityProfileCombo->currentIndex() == 1)
+                                      ? ConnectivityProfile::Vehicle : ConnectivityProfile::Foot;
+    QSet<int> islands = model->islandNodes(profile);
+    QVector<int> bridgeList = model->bridgeEdges(profile);
+    QSet<int> bridges(bridgeList.cbegin(), bridgeList.cend());
+
+    mapWidget->setConnectivityHighlight(islands, bridges);
+    statusLabel->setText(QString("孤岛节点 %1 个 · 桥 %2 条").arg(islands.size()).arg(bridges.size()));
 }
 
 void EditorWindow::setupUi() {
@@ -133,6 +232,37 @@ void EditorWindow::setupUi() {
     connect(btnUndo, &QPushButton::clicked, this, &EditorWindow::onUndoRequested);
     toolLayout->addWidget(btnUndo);
 
+    QPushButton* btnRedo = new QPushButton("↪️ 重做");
+    btnRedo->setStyleSheet("QPushButton { background-color: #F2F2F7; border-radius: 6px; padding: 6px 12px; border: 1px solid #D1D1D6; }");
+    connect(btnRedo, &QPushButton::clicked, this, &EditorWindow::onRedoRequested);
+    toolLayout->addWidget(btnRedo);
+
+    // 连通性：红色节点是孤岛，紫色道路是桥；档案决定哪些道路可走
+    btnConnectivity = new QPushButton("🧭 连通性");
+    btnConnectivity->setCheckable(true);
+    btnConnectivity->setStyleSheet(
+        "QPushButton { background-color: #F2F2F7; border-radius: 6px; padding: 6px 12px; border: 1px solid #D1D1D6; } "
+        "QPushButton:checked { background-color: #AF52DE; color: white; }");
+    connect(btnConnectivity, &QPushButton::toggled, this, &EditorWindow::refreshConnectivityHighlight);
+    toolLayout->addWidget(btnConnectivity);
+
+    connectivityProfileCombo = new QComboBox();
+    connectivityProfileCombo->addItems({"步行", "骑行"});
+    connect(connectivityProfileCombo, &QComboBox::currentIndexChanged, this, [this]() {
+        if (btnConnectivity->isChecked()) refreshConnectivityHighlight();
+    });
+    toolLayout->addWidget(connectivityProfileCombo);
+
+    QPushButton* btnTopology = new QPushButton("🧹 拓扑清理");
+    btnTopology->setStyleSheet("QPushButton { background-color: #F2F2F7; border-radius: 6px; padding: 6px 12px; border: 1px solid #D1D1D6; }");
+    connect(btnTopology, &QPushButton::clicked, this, &EditorWindow::onTopologyClean);
+    toolLayout->addWidget(btnTopology);
+
+    QPushButton* btnImportDraft = new QPushButton("📥 导入草稿");
+    btnImportDraft->setStyleSheet("QPushButton { background-color: #F2F2F7; border-radius: 6px; padding: 6px 12px; border: 1px solid #D1D1D6; }");
+    connect(btnImportDraft, &QPushButton::clicked, this, &EditorWindow::onImportDraft);
+    toolLayout->addWidget(btnImportDraft);
+
     toolLayout->addStretch();
     statusLabel = new QLabel("就绪 (修改即时生效)");
     statusLabel->setStyleSheet("color: #007AFF; font-weight: bold; font-size: 12px;");
@@ -145,6 +275,12 @@ void EditorWindow::setupUi() {
 
     mainLayout->addWidget(leftContainer, 1);
     mainLayout->addWidget(rightPanelStack);
+
+    // --- 状态栏：后台保存耗时 / 排队数量 ---
+    saveStatsLabel = new QLabel();
+    saveStatsLabel->setStyleSheet("color: #8E8E93; font-size: 12px;");
+    statusBar()->addPermanentWidget(saveStatsLabel);
+    onSaveStatsChanged();
 }
 
 void EditorWindow::setupRightPanel() {
@@ -252,6 +388,58 @@ void EditorWindow::setupRightPanel() {
 
     edgeLayout->addStretch();
     rightPanelStack->addWidget(edgePropPanel);
+
+    // --- 多选批量操作页 ---
+    selectionPanel = new QWidget();
+    QVBoxLayout* selLayout = new QVBoxLayout(selectionPanel);
+    selLayout->setAlignment(Qt::AlignTop);
+    selLayout->setSpacing(15);
+    selLayout->setContentsMargins(20, 30, 20, 20);
+
+    QLabel* selTitle = new QLabel("批量编辑");
+    selTitle->setStyleSheet("font-size: 18px; font-weight: bold; color: #1C1C1E;");
+    selLayout->addWidget(selTitle);
+
+    selectionInfoLabel = new QLabel();
+    selectionInfoLabel->setStyleSheet("color: #8E8E93;");
+    selLayout->addWidget(selectionInfoLabel);
+
+    QLabel* selHint = new QLabel("空白处拖动框选，Shift 追加/切换；\n拖动任一选中节点可整体平移");
+    selHint->setStyleSheet("color: #8E8E93; font-size: 11px;");
+    selLayout->addWidget(selHint);
+
+    auto addApplyRow = [this, selLayout](const QString& title, QComboBox* combo, void (EditorWindow::*slot)()) {
+        selLayout->addWidget(new QLabel(title));
+        QHBoxLayout* row = new QHBoxLayout();
+        row->addWidget(combo, 1);
+        QPushButton* apply = new QPushButton("应用");
+        apply->setStyleSheet("QPushButton { background-color: #F2F2F7; border-radius: 6px; padding: 6px 12px; border: 1px solid #D1D1D6; }");
+        connect(apply, &QPushButton::clicked, this, slot);
+        row->addWidget(apply);
+        selLayout->addLayout(row);
+    };
+
+    bulkCatCombo = new QComboBox();
+    bulkCatCombo->addItems({"None", "Dorm", "Canteen", "Service", "Square", "Gate", "Road", 
+                            "Park", "Shop", "Playground", "Landmark", "Lake", "Building", 
+                            "Classroom", "Hotel", "BusStation"});
+    addApplyRow("节点功能分类:", bulkCatCombo, &EditorWindow::onBulkSetCategory);
+
+    bulkNodeTypeCombo = new QComboBox();
+    bulkNodeTypeCombo->addItems({"建筑 (Visible)", "路口 (Ghost)"});
+    addApplyRow("节点类型:", bulkNodeTypeCombo, &EditorWindow::onBulkSetNodeType);
+
+    bulkEdgeTypeCombo = new QComboBox();
+    bulkEdgeTypeCombo->addItems({"普通道路 (Normal)", "主干道 (Main)", "小径 (Path)", "室内 (Indoor)", "楼梯 (Stairs)"});
+    addApplyRow("选区内道路类型:", bulkEdgeTypeCombo, &EditorWindow::onBulkSetEdgeType);
+
+    QPushButton* btnBulkDelete = new QPushButton("🗑️ 删除选中节点");
+    btnBulkDelete->setStyleSheet("background-color: #FF3B30; color: white; padding: 8px; border-radius: 5px; margin-top: 20px;");
+    connect(btnBulkDelete, &QPushButton::clicked, this, &EditorWindow::onBulkDelete);
+    selLayout->addWidget(btnBulkDelete);
+
+    selLayout->addStretch();
+    rightPanelStack->addWidget(selectionPanel);
 }
 
 // =========================================================
@@ -270,8 +458,7 @@ void EditorWindow::onLiveNodePropChanged() {
     QString selectedCat = nodeCatCombo->currentText();
     n.category = Node::stringToCategory(selectedCat);
     
-    model->updateNode(n); // 触发 autoSave
-    refreshMap();
+    model->updateNode(n); // 追加到编辑日志，场景由 onGraphChanged 增量更新
     statusLabel->setText("已保存: " + n.name);
 }
 
@@ -287,8 +474,7 @@ void EditorWindow::onLiveEdgePropChanged() {
     e.name = edgeNameEdit->text();
     e.description = edgeDescEdit->text();
 
-    model->addOrUpdateEdge(e); // 触发 autoSave
-    refreshMap();
+    model->addOrUpdateEdge(e); // 追加到编辑日志，场景由 onGraphChanged 增量更新
     statusLabel->setText("道路属性已更新");
 }
 
@@ -359,12 +545,9 @@ void EditorWindow::onEmptySpaceClicked(double x, double y)
             nodeType = NodeType::Ghost;
         }
         
-        // 调用模型添加节点
+        // 调用模型添加节点（地图由 onGraphChanged 增量更新）
         int newNodeId = model->addNode(x, y, nodeType);
         
-        // 刷新地图显示
-        refreshMap();
-        
         // 显示新节点的属性面板
         showNodeProperty(newNodeId);
         
@@ -376,18 +559,23 @@ void EditorWindow::onNodeMoved(int id, double x, double y) {
     Node n = model->getNode(id);
     n.x = x; n.y = y;
     model->updateNode(n); 
-    refreshMap();
     if (currentNodeId == id) showNodeProperty(id);
 }
 
 void EditorWindow::onUndoRequested() {
     if (model->canUndo()) {
         model->undo(); 
-        refreshMap();
         statusLabel->setText("撤销成功");
     }
 }
 
+void EditorWindow::onRedoRequested() {
+    if (model->canRedo()) {
+        model->redo();
+        statusLabel->setText("重做成功");
+    }
+}
+
 void EditorWindow::showNodeProperty(int id) {
     currentNodeId = id;
     Node n = model->getNode(id);
@@ -399,7 +587,7 @@ void EditorWindow::showNodeProperty(int id) {
     nodeCatCombo->blockSignals(true);
 
     nodeNameEdit->setText(n.name);
-    nodeDescEdit->setText(n.description);
+    nodeDescEdit->setText(model->nodeDescription(id));
     nodeZEdit->setText(QString::number(n.z)); 
     nodeCoordLabel->setText(QString("(%1, %2)").arg((int)n.x).arg((int)n.y));
     
@@ -428,7 +616,6 @@ void EditorWindow::onDeleteNode() {
         mapWidget->setActiveEdge(-1, -1);
         model->deleteNode(currentNodeId);
         currentNodeId = -1;
-        refreshMap();
         rightPanelStack->setCurrentWidget(emptyPanel);
     }
 }
@@ -443,7 +630,7 @@ void EditorWindow::onEdgeConnectionRequested(int idA, int idB) {
         Node a = model->getNode(idA);
         Node b = model->getNode(idB);
         double pixelDist = std::hypot(a.x - b.x, a.y - b.y);
-        double realDist = pixelDist * 0.91;
+        double realDist = pixelDist * Config::METERS_PER_PIXEL;
 
         Edge e;
         e.u = idA; e.v = idB;
@@ -454,7 +641,6 @@ void EditorWindow::onEdgeConnectionRequested(int idA, int idB) {
         e.description = "";
         
         model->addOrUpdateEdge(e); 
-        refreshMap();
         statusLabel->setText("自动连线成功");
     }
     
@@ -475,7 +661,7 @@ void EditorWindow::showEdgePanel(int u, int v) {
 
         edgeDisconnectBtn->setEnabled(true);
         edgeNameEdit->setText(e->name);
-        edgeDescEdit->setText(e->description);
+        edgeDescEdit->setText(model->edgeDescription(e->id));
         edgeSlopeCheck->setChecked(std::abs(e->slope) > 0.01);
         edgeTypeCombo->setCurrentIndex(static_cast<int>(e->type));
 
@@ -489,12 +675,149 @@ void EditorWindow::showEdgePanel(int u, int v) {
 void EditorWindow::onDisconnectEdge() {
     if (currentEdgeU != -1) {
         model->deleteEdge(currentEdgeU, currentEdgeV);
-        refreshMap();
         rightPanelStack->setCurrentWidget(emptyPanel);
         mapWidget->setActiveEdge(-1, -1);
     }
 }
 
+// =========================================================
+//  多选与批量操作
+//  每个批量操作是模型中的一批：一项撤销、一次保存、一次场景增量
+// =========================================================
+
+void EditorWindow::onSelectionChanged(const QVector<int>& nodeIds) {
+    selectedNodeIds = nodeIds;
+
+    if (nodeIds.size() == 1) {
+        showNodeProperty(nodeIds.first());
+        return;
+    }
+    if (nodeIds.isEmpty()) {
+        if (rightPanelStack->currentWidget() == selectionPanel) rightPanelStack->setCurrentWidget(emptyPanel);
+        return;
+    }
+
+    currentNodeId = -1;
+    selectionInfoLabel->setText(QString("已选中 %1 个节点，%2 条道路")
+                                    .arg(nodeIds.size())
+                                    .arg(selectedEdgeIds().size()));
+    rightPanelStack->setCurrentWidget(selectionPanel);
+}
+
+// 两端都在选区内的道路
+QVector<int> EditorWindow::selectedEdgeIds() {
+    QSet<int> selected(selectedNodeIds.cbegin(), selectedNodeIds.cend());
+    GraphSnapshotPtr snap = model->snapshot();
+
+    QVector<int> edgeIds;
+    for (int id : selectedNodeIds) {
+        for (const AdjEdge& e : snap->adjacency().value(snap->nodes().denseOf(id))) {
+            // 邻接表中每条道路正反各一份，只取 u < v 的那一份
+            if (e.u < e.v && selected.contains(e.v)) {
+                int edgeId = model->edgeIdBetween(e.u, e.v);
+                if (edgeId >= 0) edgeIds.append(edgeId);
+            }
+        }
+    }
+    return edgeIds;
+}
+
+void EditorWindow::onNodesMoved(const QVector<int>& nodeIds, double dx, double dy) {
+    model->beginBatch("平移节点");
+    for (int id : nodeIds) {
+        Node* n = model->getNodePtr(id);
+        if (!n) continue;
+        Node moved = *n;
+        moved.x += dx; moved.y += dy;
+        model->updateNode(moved);
+    }
+    model->commit();
+    statusLabel->setText(QString("已平移 %1 个节点").arg(nodeIds.size()));
+}
+
+void EditorWindow::onBulkDelete() {
+    if (selectedNodeIds.isEmpty()) return;
+    const QVector<int> ids = selectedNodeIds;
+
+    model->beginBatch("删除节点");
+    for (int id : ids) model->deleteNode(id);
+    model->commit();
+
+    mapWidget->clearSelection();
+    statusLabel->setText(QString("已删除 %1 个节点").arg(ids.size()));
+}
+
+void EditorWindow::onBulkSetCategory() {
+    NodeCategory cat = Node::stringToCategory(bulkCatCombo->currentText());
+
+    model->beginBatch("批量设置分类");
+    for (int id : selectedNodeIds) {
+        Node* n = model->getNodePtr(id);
+        if (!n || n->type == NodeType::Ghost) continue;  // 路口固定为 Road
+        Node changed = *n;
+        changed.category = cat;
+        model->updateNode(changed);
+    }
+    model->commit();
+    statusLabel->setText("分类已批量更新");
+}
+
+void EditorWindow::onBulkSetNodeType() {
+    NodeType type = (bulkNodeTypeCombo->currentIndex() == 1) ? NodeType::Ghost : NodeType::Visible;
+
+    model->beginBatch("批量设置类型");
+    for (int id : selectedNodeIds) {
+        Node* n = model->getNodePtr(id);
+        if (!n || n->type == type) continue;
+        Node changed = *n;
+        changed.type = type;
+        // 与单个编辑保持一致：路口一律归为 Road，建筑不沿用 Road
+        if (type == NodeType::Ghost) changed.category = NodeCategory::Road;
+        else if (changed.category == NodeCategory::Road) changed.category = NodeCategory::None;
+        model->updateNode(changed);
+    }
+    model->commit();
+    statusLabel->setText("节点类型已批量更新");
+}
+
+void EditorWindow::onBulkSetEdgeType() {
+    EdgeType type = static_cast<EdgeType>(bulkEdgeTypeCombo->currentIndex());
+    const QVector<int> edgeIds = selectedEdgeIds();
+
+    model->beginBatch("批量设置道路类型");
+    for (int edgeId : edgeIds) {
+        const Edge* e = model->edgeById(edgeId);
+        if (!e || e->type == type) continue;
+        Edge changed = *e;
+        changed.type = type;
+        model->addOrUpdateEdge(changed);
+    }
+    model->commit();
+    statusLabel->setText(QString("已更新 %1 条道路").arg(edgeIds.size()));
+}
+
+// ============================================================
+// 刷新状态栏中的后台保存信息
+// ============================================================
+void EditorWindow::onSaveStatsChanged()
+{
+    SaveScheduler* scheduler = model->saveScheduler();
+    if (!scheduler || !saveStatsLabel) return;
+
+    QString text = QString("💾 上次保存 %1 ms | 排队 %2")
+                       .arg(scheduler->lastLatencyMs())
+                       .arg(scheduler->queueDepth());
+    if (scheduler->isSaving())
+    {
+        text += " | 写盘中...";
+    }
+    if (!scheduler->lastSaveOk())
+    {
+        text += " | ⚠️ 保存失败";
+    }
+    saveStatsLabel->setText(text);
+}
+
 void EditorWindow::onSaveFile() {
     QString appDir = QCoreApplication::applicationDirPath();
     if (model->saveData(appDir + "/Data/nodes.txt", appDir + "/Data/edges.txt")) {
@@ -32,6 +32,7 @@ private slots:
     void onEdgeConnectionRequested(int idA, int idB);
     void onNodeMoved(int id, double x, double y);
     void onUndoRequested();
+    void onRedoRequested();
 
     // --- 模式与功能 ---
     void onModeChanged(int id);
@@ -43,17 +44,42 @@ private slots:
     void onLiveNodePropChanged();
     void onLiveEdgePropChanged();
 
+    // --- 后台保存状态 ---
+    void onSaveStatsChanged();
+
+    // --- 模型变化 -> 增量更新场景 ---
+    void onGraphChanged(const GraphDiff& diff);
+
+    // --- 多选与批量操作 ---
+    void onSelectionChanged(const QVector<int>& nodeIds);
+    void onNodesMoved(const QVector<int>& nodeIds, double dx, double dy);
+    void onBulkDelete();
+    void onBulkSetCategory();
+    void onBulkSetNodeType();
+    void onBulkSetEdgeType();
+
+    // --- 连通性分析 ---
+    void refreshConnectivityHighlight();
+
+    // --- 拓扑清理 ---
+    void onTopologyClean();
+
+    // --- 导入草稿 ---
+    void onImportDraft();
+
 private:
     GraphModel* model;
     MapWidget* mapWidget;
 
     QButtonGroup* modeGroup;
     QLabel* statusLabel;
+    QLabel* saveStatsLabel;     // 状态栏：保存耗时与排队数量
 
     QStackedWidget* rightPanelStack;
     QWidget* emptyPanel;
     QWidget* nodePropPanel;
     QWidget* edgePropPanel;
+    QWidget* selectionPanel;
 
     // --- 节点属性控件 ---
     QLineEdit *nodeNameEdit;
@@ -72,10 +98,22 @@ private:
     QComboBox *edgeTypeCombo;       // 道路类型
     int currentEdgeU = -1, currentEdgeV = -1;
 
+    // --- 多选批量控件 ---
+    QLabel* selectionInfoLabel;
+    QComboBox* bulkCatCombo;
+    QComboBox* bulkNodeTypeCombo;
+    QComboBox* bulkEdgeTypeCombo;
+    QVector<int> selectedNodeIds;
+
+    // --- 连通性高亮 ---
+    QPushButton* btnConnectivity;
+    QComboBox* connectivityProfileCombo;
+
     // --- 内部辅助函数 ---
     void setupUi();
     void setupRightPanel();
     void refreshMap();
     void showNodeProperty(int id);
     void showEdgePanel(int u, int v);
+    QVector<int> selectedEdgeIds();
 };
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <QtWidgets/QComboBox>
 #include <QtWidgets/QSpinBox> // 替换 QTimeEdit
 #include <QtCore/QVector>
+#include <QtCore/QFutureWatcher>
 #include <QtWidgets/QListWidget>
 #include "../model/GraphModel.h"
 #include "MapWidget.h"
@@ -27,11 +28,16 @@ public:
 private slots:
     void onMapNodeClicked(int nodeId, QString name, bool isLeftClick);
     void onModeSearch(TransportMode mode);
+    void onRoutesReady();
     void onRouteButtonClicked(int routeIndex);
     void onRouteHovered(const PathRecommendation& recommendation);
     void onRouteUnhovered();
     void onOpenEditor();
+    void onClosureMenu();
     void onMapDataChanged();
+    void onMapViewChanged(const QRectF& visibleRect);
+    void onGraphChanged(const GraphDiff& diff);
+    void onDataReloaded(const ReloadDiff& diff);
 
 private:
     GraphModel* model;
@@ -58,6 +64,7 @@ private:
     QPushButton* btnBus;
 
     QPushButton* openEditorBtn;
+    QPushButton* closureBtn;    // 道路封闭菜单
     QLabel* statusLabel;
 
     // 结果面板
@@ -67,6 +74,10 @@ private:
     QVector<RouteButton*> routeButtons;
     QVector<PathRecommendation> currentRecommendations;
 
+    // 后台路径规划
+    QFutureWatcher<QVector<PathRecommendation>>* routeWatcher;
+    TransportMode pendingSearchMode = TransportMode::Walk;
+
     int currentStartId = -1;
     int currentEndId = -1;
 
@@ -80,4 +91,5 @@ private:
     void clearRoutePanel();
     void resetAllButtonStyles();
     void updateButtonStyle(QPushButton* btn, bool isSelected, bool isLate);
+    void applyClosureChange(const QString& status);
 };
\ No newline at end of file
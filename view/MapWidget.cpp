@@ -4,6 +4,8 @@
 #include <QtWidgets/QGraphicsTextItem>
 #include <QtWidgets/QGraphicsObject> 
 #include "HoverBubble.h"
+#include "../model/GraphModel.h"
+#include "../model/GraphSnapshot.h"
 #include <QtGui/QMouseEvent>
 #include <QtCore/QDebug>
 #include <cmath>
@@ -22,12 +24,6 @@
 //  辅助函数与类
 // =========================================================
 
-static long long makeEdgeKey(int u, int v) {
-    int minId = std::min(u, v);
-    int maxId = std::max(u, v);
-    return (static_cast<long long>(minId) << 32) | maxId;
-}
-
 class HaloItem : public QGraphicsObject {
 public:
     HaloItem(const QPointF& center, double radius, QGraphicsItem* parent = nullptr)
@@ -151,6 +147,11 @@ MapWidget::MapWidget(QWidget *parent) : QGraphicsView(parent)
     connect(horizontalScrollBar(), &QScrollBar::valueChanged, this, updateWeatherPos);
     connect(verticalScrollBar(), &QScrollBar::valueChanged, this, updateWeatherPos);
 
+    // 视野变化通知（分区模式下用于按需加载）
+    auto notifyViewChanged = [this]() { emit viewChanged(visibleSceneRect()); };
+    connect(horizontalScrollBar(), &QScrollBar::valueChanged, this, notifyViewChanged);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, notifyViewChanged);
+
     // 创建天气效果覆盖层
     weatherOverlay = new WeatherOverlay();
     weatherOverlay->setZValue(1000);  // 最高层级
@@ -158,9 +159,9 @@ MapWidget::MapWidget(QWidget *parent) : QGraphicsView(parent)
 }
 
 void MapWidget::setActiveEdge(int u, int v) {
+    // 选中道路不改变任何图元，只记录状态，不必整图重绘
     activeEdgeU = u;
     activeEdgeV = v;
-    drawMap(cachedNodes, cachedEdges);
 }
 
 void MapWidget::stopHoverAnimations() {
@@ -171,21 +172,21 @@ void MapWidget::stopHoverAnimations() {
 void MapWidget::setShowGhostNodes(bool show) {
     if (m_showGhostNodes != show) {
         m_showGhostNodes = show;
-        drawMap(cachedNodes, cachedEdges);
+        rebuildScene();
     }
 }
 
 void MapWidget::setShowEdges(bool show) {
     if (m_showEdges != show) {
         m_showEdges = show;
-        drawMap(cachedNodes, cachedEdges);
+        rebuildScene();
     }
 }
 
 void MapWidget::setNodeSizeMultiplier(double mult) {
     if (m_nodeSizeMultiplier != mult) {
         m_nodeSizeMultiplier = mult;
-        drawMap(cachedNodes, cachedEdges);
+        rebuildScene();
     }
 }
 
@@ -194,7 +195,16 @@ void MapWidget::setNodeSizeMultiplier(double mult) {
 // ---------------------------------------------------------
 // view/MapWidget.cpp
 
-void MapWidget::drawMap(const QVector<Node>& nodes, const QVector<Edge>& edges)
+void MapWidget::drawMap(const GraphSnapshot& graph)
+{
+    // 只增加引用计数，不复制节点、道路及其字符串
+    cachedNodes = graph.nodes();
+    cachedEdges = graph.edges();
+    cachedEdgeIndex = graph.edgeSlots();
+    rebuildScene();
+}
+
+void MapWidget::rebuildScene()
 {
     // 1. 停止所有动画和定时器，切断对 item 的引用
     if (animationTimer->isActive()) animationTimer->stop();
@@ -211,10 +221,12 @@ void MapWidget::drawMap(const QVector<Node>& nodes, const QVector<Edge>& edges)
     nodeGraphicsItems.clear();
     nodeLabelItems.clear();
     edgeGraphicsItems.clear();
-    nodeConnectedEdgeKeys.clear();
+    nodeConnectedEdgeIds.clear();
     
     activeTrackItem = nullptr;
     activeGrowthItem = nullptr;
+    rubberBandItem = nullptr;
+    isRubberBanding = false;
     hoveredNodeId = -1; // 重置悬停状态
     hoveredEdgeIndex = -1;
 
@@ -226,78 +238,321 @@ void MapWidget::drawMap(const QVector<Node>& nodes, const QVector<Edge>& edges)
             delete item;
         }
     }
-    
-    // 更新缓存数据
-    cachedNodes = nodes;
-    cachedEdges = edges;
 
     // 4. 重绘边 (Edge) - 仅当 m_showEdges 为 true 时绘制
-    if (m_showEdges) {
-        // 先画边，这样边会在节点下面
-        for(long long i=0; i<edges.size(); ++i) {
-            const Edge& e = edges[i];
-            
-            // 查找端点坐标
-            QPointF uPos, vPos;
-            bool uFound=false, vFound=false;
-            for(const auto& n : nodes) {
-                if(n.id == e.u) { uPos = QPointF(n.x, n.y); uFound=true; }
-                if(n.id == e.v) { vPos = QPointF(n.x, n.y); vFound=true; }
-                if(uFound && vFound) break;
-            }
-            if(!uFound || !vFound) continue;
-
-            QGraphicsLineItem* lineItem = scene->addLine(QLineF(uPos, vPos), edgePenForType(e.type));
-            lineItem->setZValue(e.type == EdgeType::Stairs ? 6 : 5); 
-            
-            // 记录映射
-            long long key = makeEdgeKey(e.u, e.v);
-            edgeGraphicsItems.insert(key, lineItem);
-            
-            nodeConnectedEdgeKeys[e.u].append(key);
-            nodeConnectedEdgeKeys[e.v].append(key);
-        }
+    // 先画边，这样边会在节点下面（跳过已删除道路留下的墓碑）
+    for (const Edge& e : std::as_const(cachedEdges)) {
+        if (e.id >= 0) createEdgeItem(e);
     }
 
     // 5. 重绘节点 (Node)
-    QFont nameFont("Microsoft YaHei", 8);
-    for(const auto& n : nodes) {
-        // 如果不显示幽灵节点且当前是 Ghost，则跳过
-        if (!m_showGhostNodes && n.type == NodeType::Ghost) continue;
+    for (const Node& n : std::as_const(cachedNodes)) createNodeItems(n);
+}
 
-        // 节点大小：Ghost节点8px，Visible节点12px，乘以放大倍数
-        double baseR = (n.type == NodeType::Ghost) ? 8.0 : 12.0;
-        double r = baseR * m_nodeSizeMultiplier;
-        
-        // 节点圆圈
-        QGraphicsEllipseItem* el = scene->addEllipse(-r/2, -r/2, r, r);
-        el->setPos(n.x, n.y);
-        el->setZValue(10);
+// ---------------------------------------------------------
+//  单个图元的创建与删除（整图重绘和增量更新共用）
+// ---------------------------------------------------------
+void MapWidget::createEdgeItem(const Edge& e) {
+    if (!m_showEdges) return;
+
+    // 查找端点坐标
+    const Node* a = cachedNode(e.u);
+    const Node* b = cachedNode(e.v);
+    if (!a || !b) return;
+
+    QGraphicsLineItem* lineItem = scene->addLine(QLineF(a->x, a->y, b->x, b->y), edgePenForType(e.type));
+    lineItem->setZValue(e.type == EdgeType::Stairs ? 6 : 5); 
+    
+    // 记录映射（按稳定的道路 ID），起点 ID 存在图元上，拖动时据此更新对应端点
+    lineItem->setData(0, e.u);
+    if (e.id >= 0) {
+        edgeGraphicsItems.insert(e.id, lineItem);
+        nodeConnectedEdgeIds[e.u].append(e.id);
+        nodeConnectedEdgeIds[e.v].append(e.id);
+        if (bridgeEdgeIds.contains(e.id)) updateBridgeLook(e.id, true);
+    }
+}
+
+void MapWidget::removeEdgeItem(int edgeId, int u, int v) {
+    QGraphicsLineItem* line = edgeGraphicsItems.take(edgeId);
+    if (line) { scene->removeItem(line); delete line; }
+    if (nodeConnectedEdgeIds.contains(u)) nodeConnectedEdgeIds[u].removeAll(edgeId);
+    if (nodeConnectedEdgeIds.contains(v)) nodeConnectedEdgeIds[v].removeAll(edgeId);
+}
+
+void MapWidget::createNodeItems(const Node& n) {
+    // 如果不显示幽灵节点且当前是 Ghost，则跳过
+    if (!m_showGhostNodes && n.type == NodeType::Ghost) return;
+
+    // 节点大小：Ghost节点8px，Visible节点12px，乘以放大倍数
+    double baseR = (n.type == NodeType::Ghost) ? 8.0 : 12.0;
+    double r = baseR * m_nodeSizeMultiplier;
+    
+    // 节点圆圈
+    QGraphicsEllipseItem* el = scene->addEllipse(-r/2, -r/2, r, r);
+    el->setPos(n.x, n.y);
+    el->setZValue(10);
+    
+    if (n.type == NodeType::Ghost) {
+        el->setPen(QPen(Qt::NoPen));
+        el->setBrush(QColor(0, 0, 0, 40)); 
+    } else {
+        // POI节点使用浅灰色样式
+        el->setPen(QPen(Qt::white, 2.5 * m_nodeSizeMultiplier));
+        el->setBrush(QColor("#8E8E93")); // 浅灰色
+    }
+    
+    // 节点 ID 存在图元上：框选时由场景的空间索引查到图元，再映射回节点
+    el->setData(1, n.id);
+    nodeGraphicsItems.insert(n.id, el);
+    if (selectedNodeIds.contains(n.id)) updateSelectionLook(n.id, true);
+    if (islandNodeIds.contains(n.id)) updateIslandLook(n.id, true);
+
+    // 节点文字 (仅 Visible 节点)
+    if (n.type == NodeType::Visible) {
+        QGraphicsTextItem* label = scene->addText(n.name, QFont("Microsoft YaHei", 8));
+        QRectF bd = label->boundingRect();
+        label->setPos(n.x - bd.width()/2.0, n.y + r/2.0 + 2.0);
+        label->setDefaultTextColor(QColor("#1C1C1E"));
+        label->setZValue(12);
+        nodeLabelItems.insert(n.id, label);
         
-        if (n.type == NodeType::Ghost) {
-            el->setPen(QPen(Qt::NoPen));
-            el->setBrush(QColor(0, 0, 0, 40)); 
+        // 简单防遮挡：如果文字重叠则隐藏（可选优化）
+        // 这里为了性能暂不处理复杂的碰撞检测
+    }
+}
+
+void MapWidget::removeNodeItems(int nodeId) {
+    QGraphicsEllipseItem* el = nodeGraphicsItems.take(nodeId);
+    if (el) { scene->removeItem(el); delete el; }
+    QGraphicsTextItem* label = nodeLabelItems.take(nodeId);
+    if (label) { scene->removeItem(label); delete label; }
+}
+
+// 把节点图元、文字和相连道路的端点移到节点当前坐标（拖动中与拖动结束共用）
+void MapWidget::placeNodeItems(const Node& n) {
+    QGraphicsEllipseItem* el = nodeGraphicsItems.value(n.id);
+    if (el) el->setPos(n.x, n.y);
+
+    QGraphicsTextItem* label = nodeLabelItems.value(n.id);
+    if (label) {
+        double r = ((n.type == NodeType::Ghost) ? 8.0 : 12.0) * m_nodeSizeMultiplier;
+        QRectF bd = label->boundingRect();
+        label->setPos(n.x - bd.width()/2.0, n.y + r/2.0 + 2.0);
+    }
+
+    for (int edgeId : nodeConnectedEdgeIds.value(n.id)) {
+        QGraphicsLineItem* line = edgeGraphicsItems.value(edgeId);
+        if (!line) continue;
+        // 起点 ID 存在图元上，据此判断移动哪一端
+        QLineF l = line->line();
+        if (line->data(0).toInt() == n.id) l.setP1(QPointF(n.x, n.y));
+        else l.setP2(QPointF(n.x, n.y));
+        line->setLine(l);
+    }
+}
+
+// ---------------------------------------------------------
+//  按模型提交的一批变化增量更新
+// ---------------------------------------------------------
+void MapWidget::applyGraphDiff(const GraphDiff& diff, GraphModel* model)
+{
+    QVector<int> removedNodes(diff.removedNodes.cbegin(), diff.removedNodes.cend());
+    QVector<int> removedEdges(diff.removedEdges.cbegin(), diff.removedEdges.cend());
+
+    QVector<Node> changedNodes;
+    changedNodes.reserve(diff.addedNodes.size() + diff.modifiedNodes.size());
+    for (const QSet<int>* ids : { &diff.addedNodes, &diff.modifiedNodes }) {
+        for (int id : *ids) {
+            if (Node* n = model->getNodePtr(id)) changedNodes.append(*n);
+        }
+    }
+
+    QVector<Edge> changedEdges;
+    changedEdges.reserve(diff.addedEdges.size() + diff.modifiedEdges.size());
+    for (const QSet<int>* ids : { &diff.addedEdges, &diff.modifiedEdges }) {
+        for (int id : *ids) {
+            if (const Edge* e = model->edgeById(id)) changedEdges.append(*e);
+        }
+    }
+
+    applyGraphChanges(removedNodes, removedEdges, changedNodes, changedEdges);
+}
+
+// ---------------------------------------------------------
+//  增量更新：只改动变化的节点和道路
+// ---------------------------------------------------------
+void MapWidget::applyGraphChanges(const QVector<int>& removedNodeIds, const QVector<int>& removedEdgeIds,
+                                  const QVector<Node>& changedNodes, const QVector<Edge>& changedEdges)
+{
+    // 悬停气泡可能指向将被删除的图元或过期的道路下标，先收掉
+    stopHoverAnimations();
+    clearHoverItems();
+    hoveredNodeId = -1;
+    hoveredEdgeIndex = -1;
+
+    // 从缓存中删除一项：用最后一项填补空位，只需修正一个下标
+    // （节点表自己管理空位，直接 remove 即可；道路表里从快照带来的墓碑不进下标表）
+    auto eraseCachedEdge = [this](int id) {
+        int idx = cachedEdgeIndex.value(id, -1);
+        if (idx < 0) return;
+        int last = cachedEdges.size() - 1;
+        if (idx != last) {
+            cachedEdges[idx] = cachedEdges[last];
+            if (cachedEdges[idx].id >= 0) cachedEdgeIndex[cachedEdges[idx].id] = idx;
+        }
+        cachedEdges.removeLast();
+        cachedEdgeIndex.remove(id);
+    };
+
+    // 1. 删除道路
+    for (int edgeId : removedEdgeIds) {
+        int idx = cachedEdgeIndex.value(edgeId, -1);
+        if (idx < 0) continue;
+        removeEdgeItem(edgeId, cachedEdges[idx].u, cachedEdges[idx].v);
+        eraseCachedEdge(edgeId);
+    }
+
+    // 2. 删除节点（相连道路已在上一步处理）
+    bool selectionShrunk = false;
+    for (int nodeId : removedNodeIds) {
+        removeNodeItems(nodeId);
+        nodeConnectedEdgeIds.remove(nodeId);
+        cachedNodes.remove(nodeId);
+        selectionShrunk |= selectedNodeIds.remove(nodeId);
+    }
+
+    // 3. 新增 / 修改节点
+    for (const Node& n : changedNodes) {
+        if (const Node* old = cachedNode(n.id)) {
+            // 只是换了位置（拖动结束、批量平移）：原地移动图元，不重建
+            bool sameLook = (old->type == n.type && old->name == n.name);
+            cachedNodes.insert(n);
+            if (sameLook) {
+                placeNodeItems(n);
+                continue;
+            }
         } else {
-            // POI节点使用浅灰色样式
-            el->setPen(QPen(Qt::white, 2.5 * m_nodeSizeMultiplier));
-            el->setBrush(QColor("#8E8E93")); // 浅灰色
+            cachedNodes.insert(n);
         }
-        
-        nodeGraphicsItems.insert(n.id, el);
-
-        // 节点文字 (仅 Visible 节点)
-        if (n.type == NodeType::Visible) {
-            QGraphicsTextItem* label = scene->addText(n.name, nameFont);
-            QRectF bd = label->boundingRect();
-            label->setPos(n.x - bd.width()/2.0, n.y + r/2.0 + 2.0);
-            label->setDefaultTextColor(QColor("#1C1C1E"));
-            label->setZValue(12);
-            nodeLabelItems.insert(n.id, label);
-            
-            // 简单防遮挡：如果文字重叠则隐藏（可选优化）
-            // 这里为了性能暂不处理复杂的碰撞检测
+        removeNodeItems(n.id);
+        createNodeItems(n);
+        placeNodeItems(n);
+    }
+
+    // 4. 新增 / 修改道路（类型可能变了，直接重建图元）
+    for (const Edge& e : changedEdges) {
+        int idx = cachedEdgeIndex.value(e.id, -1);
+        if (idx >= 0) {
+            removeEdgeItem(e.id, cachedEdges[idx].u, cachedEdges[idx].v);
+            cachedEdges[idx] = e;
+        } else {
+            cachedEdgeIndex.insert(e.id, cachedEdges.size());
+            cachedEdges.append(e);
         }
+        createEdgeItem(e);
     }
+
+    // 连线模式下已选中的第一个点被重建后，恢复高亮
+    if (connectFirstNodeId != -1) updateNodeHighlight(connectFirstNodeId, true);
+
+    if (selectionShrunk) emit selectionChanged(selectedNodes());
+}
+
+// ---------------------------------------------------------
+//  多选
+// ---------------------------------------------------------
+QVector<int> MapWidget::selectedNodes() const {
+    return QVector<int>(selectedNodeIds.cbegin(), selectedNodeIds.cend());
+}
+
+void MapWidget::clearSelection() {
+    if (selectedNodeIds.isEmpty()) return;
+    const QSet<int> old = selectedNodeIds;
+    selectedNodeIds.clear();
+    for (int id : old) updateSelectionLook(id, false);
+    emit selectionChanged(QVector<int>());
+}
+
+void MapWidget::updateSelectionLook(int nodeId, bool selected) {
+    QGraphicsEllipseItem* el = nodeGraphicsItems.value(nodeId);
+    if (!el) return;
+    if (selected) {
+        // 选中样式：蓝色描边，浮在普通节点之上
+        el->setPen(QPen(QColor("#007AFF"), 3.0 * m_nodeSizeMultiplier));
+        el->setZValue(11);
+        return;
+    }
+    const Node* n = cachedNode(nodeId);
+    bool ghost = (n && n->type == NodeType::Ghost);
+    el->setPen(ghost ? QPen(Qt::NoPen) : QPen(Qt::white, 2.5 * m_nodeSizeMultiplier));
+    el->setZValue(10);
+}
+
+// ---------------------------------------------------------
+//  连通性高亮：孤岛节点红色填充，桥加粗紫色
+// ---------------------------------------------------------
+void MapWidget::setConnectivityHighlight(const QSet<int>& islandNodes, const QSet<int>& bridgeEdges) {
+    for (int id : islandNodeIds) if (!islandNodes.contains(id)) updateIslandLook(id, false);
+    for (int id : bridgeEdgeIds) if (!bridgeEdges.contains(id)) updateBridgeLook(id, false);
+    islandNodeIds = islandNodes;
+    bridgeEdgeIds = bridgeEdges;
+    for (int id : islandNodeIds) updateIslandLook(id, true);
+    for (int id : bridgeEdgeIds) updateBridgeLook(id, true);
+}
+
+void MapWidget::updateIslandLook(int nodeId, bool island) {
+    QGraphicsEllipseItem* el = nodeGraphicsItems.value(nodeId);
+    if (!el) return;
+    if (island) { el->setBrush(QColor("#FF3B30")); return; }
+    const Node* n = cachedNode(nodeId);
+    bool ghost = (n && n->type == NodeType::Ghost);
+    el->setBrush(ghost ? QColor(0, 0, 0, 40) : QColor("#8E8E93"));
+}
+
+void MapWidget::updateBridgeLook(int edgeId, bool bridge) {
+    QGraphicsLineItem* line = edgeGraphicsItems.value(edgeId);
+    int idx = cachedEdgeIndex.value(edgeId, -1);
+    if (!line || idx < 0) return;
+    EdgeType type = cachedEdges.at(idx).type;
+    if (bridge) {
+        QPen pen(QColor("#AF52DE")); pen.setWidth(5); pen.setCapStyle(Qt::RoundCap);
+        line->setPen(pen);
+        line->setZValue(7);
+    } else {
+        line->setPen(edgePenForType(type));
+        line->setZValue(type == EdgeType::Stairs ? 6 : 5);
+    }
+}
+
+// 框选结束：用场景自带的 BSP 空间索引查询矩形内的节点图元，不遍历全部节点
+void MapWidget::finishRubberBand(bool additive) {
+    isRubberBanding = false;
+    QRectF area;
+    if (rubberBandItem) {
+        area = rubberBandItem->rect();
+        scene->removeItem(rubberBandItem);
+        delete rubberBandItem;
+        rubberBandItem = nullptr;
+    }
+
+    if (!additive) {
+        const QSet<int> old = selectedNodeIds;
+        selectedNodeIds.clear();
+        for (int id : old) updateSelectionLook(id, false);
+    }
+
+    // 几乎没拖动视为单击空白：只清空选择
+    if (area.width() >= 3.0 || area.height() >= 3.0) {
+        const QList<QGraphicsItem*> hits = scene->items(area, Qt::IntersectsItemBoundingRect);
+        for (QGraphicsItem* item : hits) {
+            QVariant id = item->data(1);
+            if (!id.isValid()) continue;
+            selectedNodeIds.insert(id.toInt());
+            updateSelectionLook(id.toInt(), true);
+        }
+    }
+    emit selectionChanged(selectedNodes());
 }
 
 // =========================================================
@@ -321,7 +576,7 @@ void MapWidget::mousePressEvent(QMouseEvent *event)
         if (currentMode == EditMode::None) {
             int hitId = findNodeAt(scenePos);
             if (hitId != -1) {
-                QString name; for(const auto&n:cachedNodes) if(n.id==hitId) name=n.name;
+                const Node* hit = cachedNode(hitId); QString name = hit ? hit->name : QString();
                 fadeOutHoverItems(); emit nodeClicked(hitId, name, false); 
             }
         } else {
@@ -341,6 +596,38 @@ void MapWidget::mousePressEvent(QMouseEvent *event)
     // 3. 左键处理
     if (event->button() == Qt::LeftButton) {
         int hitId = findNodeAt(scenePos);
+
+        // 多选 (仅可编辑的浏览模式)：
+        // Shift+点击节点切换选中；空白处按下开始框选；按住已选中的节点拖动整组
+        if (m_isEditable && currentMode == EditMode::None) {
+            bool shift = event->modifiers().testFlag(Qt::ShiftModifier);
+            if (hitId != -1 && shift) {
+                bool nowSelected = !selectedNodeIds.contains(hitId);
+                if (nowSelected) selectedNodeIds.insert(hitId);
+                else selectedNodeIds.remove(hitId);
+                updateSelectionLook(hitId, nowSelected);
+                emit selectionChanged(selectedNodes());
+                event->accept(); return;
+            }
+            if (hitId == -1) {
+                fadeOutHoverItems();
+                isRubberBanding = true;
+                rubberBandAdditive = shift;
+                rubberOrigin = scenePos;
+                rubberBandItem = scene->addRect(QRectF(scenePos, scenePos), QPen(QColor("#007AFF"), 0, Qt::DashLine), QColor(0, 122, 255, 30));
+                rubberBandItem->setZValue(90);
+                event->accept(); return;
+            }
+            if (selectedNodeIds.size() > 1 && selectedNodeIds.contains(hitId)) {
+                isGroupDragging = true;
+                groupDragOrigin = scenePos;
+                lastScenePos = scenePos;
+                setCursor(Qt::SizeAllCursor);
+                event->accept(); return;
+            }
+            // 单击未选中的节点：回到单选编辑
+            clearSelection();
+        }
         
         // 判断是否允许拖拽
         bool canDrag = false;
@@ -355,7 +642,7 @@ void MapWidget::mousePressEvent(QMouseEvent *event)
         if (canDrag && hitId != -1) {
             emit nodeEditClicked(hitId, (currentMode != EditMode::None)); 
             draggingNodeId = hitId; 
-            // drawMap(cachedNodes, cachedEdges); // <--- 【删除】这里其实不用重绘，直接拖就行
+            // rebuildScene(); // <--- 【删除】这里其实不用重绘，直接拖就行
             isNodeDragging = true; 
             lastScenePos = scenePos;
             setCursor(Qt::SizeAllCursor); 
@@ -369,7 +656,7 @@ void MapWidget::mousePressEvent(QMouseEvent *event)
         if (currentMode == EditMode::None) {
             if (hitId != -1) {
                 fadeOutHoverItems(); 
-                QString name; for(const auto&n:cachedNodes) if(n.id==hitId) name=n.name;
+                const Node* hit = cachedNode(hitId); QString name = hit ? hit->name : QString();
                 emit nodeClicked(hitId, name, true); 
                 if (m_isEditable) {
                     emit nodeEditClicked(hitId, false);
@@ -419,62 +706,40 @@ void MapWidget::mouseMoveEvent(QMouseEvent *event)
         return;
     }
     
+    // 框选：更新选框
+    if (isRubberBanding) {
+        if (rubberBandItem) rubberBandItem->setRect(QRectF(rubberOrigin, scenePos).normalized());
+        event->accept();
+        return;
+    }
+
+    // 整组拖动：移动所有选中节点的图元，松开时一次提交
+    if (isGroupDragging) {
+        double dx = scenePos.x() - lastScenePos.x();
+        double dy = scenePos.y() - lastScenePos.y();
+        lastScenePos = scenePos;
+        for (int id : selectedNodeIds) {
+            Node* n = cachedNodes.find(id);
+            if (!n) continue;
+            n->x += dx; n->y += dy;
+            placeNodeItems(*n);
+        }
+        event->accept();
+        return;
+    }
+
     // 2. 节点拖拽逻辑 (保持流畅性)
     if (isNodeDragging && draggingNodeId != -1) {
         double dx = scenePos.x() - lastScenePos.x();
         double dy = scenePos.y() - lastScenePos.y();
         
-        // 更新数据模型
-        double newX = 0, newY = 0;
-        for(auto& n : cachedNodes) {
-            if(n.id == draggingNodeId) {
-                n.x += dx; n.y += dy;
-                newX = n.x; newY = n.y;
-                lastScenePos = scenePos; 
-                break;
-            }
-        }
-        
-        // 更新图元位置 (不重绘，高性能)
-        if (nodeGraphicsItems.contains(draggingNodeId)) {
-            auto item = nodeGraphicsItems[draggingNodeId];
-            if (item && item->scene() == scene) {
-                QRectF rect = item->rect();
-                item->setRect(newX - rect.width()/2.0, newY - rect.height()/2.0, rect.width(), rect.height());
-            }
-        }
-        
-        // 更新文字位置
-        if (nodeLabelItems.contains(draggingNodeId)) {
-            auto text = nodeLabelItems[draggingNodeId];
-            if (text && text->scene() == scene) {
-                double r = 12.0; 
-                QRectF bd = text->boundingRect();
-                text->setPos(newX - bd.width()/2.0, newY + r + 6);
-            }
-        }
+        // 更新缓存中的坐标
+        if (Node* n = cachedNodes.find(draggingNodeId)) {
+            n->x += dx; n->y += dy;
+            lastScenePos = scenePos;
 
-        // 更新相连边位置
-        if (nodeConnectedEdgeKeys.contains(draggingNodeId)) {
-            const auto& keys = nodeConnectedEdgeKeys[draggingNodeId];
-            for(long long key : keys) {
-                if (edgeGraphicsItems.contains(key)) {
-                    auto line = edgeGraphicsItems[key];
-                    if (line && line->scene() == scene) { 
-                        QLineF l = line->line();
-                        QPointF p1 = l.p1();
-                        QPointF p2 = l.p2();
-                        
-                        // 简单的距离判断，决定更新哪一端
-                        if ((p1 - QPointF(newX - dx, newY - dy)).manhattanLength() < 20.0) { 
-                            l.setP1(QPointF(newX, newY));
-                        } else {
-                            l.setP2(QPointF(newX, newY));
-                        }
-                        line->setLine(l);
-                    }
-                }
-            }
+            // 只移动这个节点的图元、文字和相连的边 (不重绘，高性能)
+            placeNodeItems(*n);
         }
         event->accept(); 
         return; 
@@ -494,7 +759,7 @@ void MapWidget::mouseMoveEvent(QMouseEvent *event)
             if (hoveredNodeId != hitNode || hoveredEdgeIndex != -1) {
                 stopHoverAnimations(); clearHoverItems(); 
                 hoveredNodeId = hitNode; hoveredEdgeIndex = -1;
-                for (const auto& n : cachedNodes) { if (n.id == hitNode) { showNodeHoverBubble(n); break; } }
+                if (const Node* n = cachedNode(hitNode)) showNodeHoverBubble(*n);
             }
             event->accept(); return;
         }
@@ -503,14 +768,14 @@ void MapWidget::mouseMoveEvent(QMouseEvent *event)
         int edgeIdx = findEdgeAt(scenePos, closest, u, v);
         
         if (edgeIdx != -1) {
-            QString newName = cachedEdges[edgeIdx].name;
-            QString oldName = (hoveredEdgeIndex != -1 && hoveredEdgeIndex < cachedEdges.size()) ? cachedEdges[hoveredEdgeIndex].name : "";
+            QString newName = cachedEdges.at(edgeIdx).name;
+            QString oldName = (hoveredEdgeIndex != -1 && hoveredEdgeIndex < cachedEdges.size()) ? cachedEdges.at(hoveredEdgeIndex).name : "";
             bool sameRoad = (!newName.isEmpty() && newName != "路" && newName == oldName);
 
             if (!sameRoad && (hoveredEdgeIndex != edgeIdx || hoveredNodeId != -1)) {
                 stopHoverAnimations(); clearHoverItems();
                 hoveredEdgeIndex = edgeIdx; hoveredNodeId = -1;
-                showEdgeHoverBubble(cachedEdges[edgeIdx], closest);
+                showEdgeHoverBubble(cachedEdges.at(edgeIdx), closest);
             } else if (sameRoad) {
                 hoveredEdgeIndex = edgeIdx;
             }
@@ -534,20 +799,34 @@ void MapWidget::mouseReleaseEvent(QMouseEvent *event)
         return;
     }
 
+    // 框选结束
+    if (isRubberBanding && event->button() == Qt::LeftButton) {
+        finishRubberBand(rubberBandAdditive);
+        event->accept();
+        return;
+    }
+
+    // 整组拖动结束：一次发出总位移
+    if (isGroupDragging && event->button() == Qt::LeftButton) {
+        isGroupDragging = false;
+        setCursor(Qt::ArrowCursor);
+        QPointF delta = lastScenePos - groupDragOrigin;
+        if (!delta.isNull()) emit nodesMoved(selectedNodes(), delta.x(), delta.y());
+        event->accept();
+        return;
+    }
+
     // 2. 【核心修复】拖拽结束逻辑
     if (isNodeDragging) {
         if (draggingNodeId != -1) {
             // A. 从缓存中找到当前节点移动后的最终位置
             // (mouseMoveEvent 里已经更新了 cachedNodes 的坐标，这里直接读)
             double finalX = 0, finalY = 0;
-            bool found = false;
-            for(const auto& n : cachedNodes) {
-                if(n.id == draggingNodeId) {
-                    finalX = n.x;
-                    finalY = n.y;
-                    found = true;
-                    break;
-                }
+            const Node* moved = cachedNode(draggingNodeId);
+            bool found = (moved != nullptr);
+            if (found) {
+                finalX = moved->x;
+                finalY = moved->y;
             }
 
             // B. 发送正确的保存信号
@@ -588,9 +867,14 @@ void MapWidget::wheelEvent(QWheelEvent *event) {
             double factor = minScale / currentTransformScale; if (factor < 1.0) this->scale(factor, factor);
         } else this->scale(1.0 / scaleFactor, 1.0 / scaleFactor);
     }
+    emit viewChanged(visibleSceneRect());
     event->accept();
 }
 
+QRectF MapWidget::visibleSceneRect() const {
+    return mapToScene(viewport()->rect()).boundingRect();
+}
+
 void MapWidget::highlightPath(const QVector<int>& pathNodeIds, double animationDuration) {
     if (currentPathNodeIds == pathNodeIds && animationTimer->isActive()) return;
     clearPathHighlight();
@@ -599,9 +883,9 @@ void MapWidget::highlightPath(const QVector<int>& pathNodeIds, double animationD
     animationProgress = 0.0; animationStartTime = QDateTime::currentMSecsSinceEpoch();
 
     QPainterPath fullPath;
-    QMap<int, Node> nodeMap; for(const auto& n : cachedNodes) nodeMap.insert(n.id, n);
-    Node start = nodeMap[pathNodeIds[0]]; fullPath.moveTo(start.x, start.y);
-    for(int i=1; i<pathNodeIds.size(); ++i) { Node n = nodeMap[pathNodeIds[i]]; fullPath.lineTo(n.x, n.y); }
+    auto pointOf = [this](int id) { const Node* n = cachedNode(id); return n ? QPointF(n->x, n->y) : QPointF(); };
+    fullPath.moveTo(pointOf(pathNodeIds[0]));
+    for(int i=1; i<pathNodeIds.size(); ++i) fullPath.lineTo(pointOf(pathNodeIds[i]));
     
     QPen trackPen(QColor(0, 122, 255, 40)); trackPen.setWidth(8); 
     trackPen.setCapStyle(Qt::RoundCap); trackPen.setJoinStyle(Qt::RoundJoin);
@@ -625,18 +909,18 @@ void MapWidget::drawPathGrowthAnimation() {
         activeGrowthItem = nullptr; 
     }
     
-    QMap<int, Node> nodeMap; for(const auto& n : cachedNodes) nodeMap.insert(n.id, n);
-    QPainterPath currPath; Node n0 = nodeMap[currentPathNodeIds[0]]; currPath.moveTo(n0.x, n0.y);
+    // 每帧都会调用：按缓存索引取坐标，不再每帧重建 ID -> 节点 的映射
+    auto pointOf = [this](int id) { const Node* n = cachedNode(id); return n ? QPointF(n->x, n->y) : QPointF(); };
+    QPainterPath currPath; QPointF p0 = pointOf(currentPathNodeIds[0]); currPath.moveTo(p0);
     double totalSegs = currentPathNodeIds.size() - 1; double currentPos = animationProgress * totalSegs;
     int segIndex = (int)currentPos; double segLocalProgress = currentPos - segIndex;
-    QPointF tipPos(n0.x, n0.y);
+    QPointF tipPos = p0;
     for (int i = 0; i < segIndex && i < totalSegs; ++i) {
-        Node n = nodeMap[currentPathNodeIds[i+1]]; currPath.lineTo(n.x, n.y); tipPos = QPointF(n.x, n.y);
+        tipPos = pointOf(currentPathNodeIds[i+1]); currPath.lineTo(tipPos);
     }
     if (segIndex < totalSegs) {
-        Node start = nodeMap[currentPathNodeIds[segIndex]]; Node end = nodeMap[currentPathNodeIds[segIndex+1]];
-        double dx = end.x - start.x; double dy = end.y - start.y;
-        tipPos = QPointF(start.x + dx*segLocalProgress, start.y + dy*segLocalProgress); currPath.lineTo(tipPos);
+        QPointF start = pointOf(currentPathNodeIds[segIndex]); QPointF end = pointOf(currentPathNodeIds[segIndex+1]);
+        tipPos = start + (end - start) * segLocalProgress; currPath.lineTo(tipPos);
     }
     QPen growPen(QColor("#007AFF")); growPen.setWidth(5); 
     growPen.setCapStyle(Qt::RoundCap); growPen.setJoinStyle(Qt::RoundJoin);
@@ -674,6 +958,7 @@ void MapWidget::resizeEvent(QResizeEvent *event) {
         weatherOverlay->setPos(sceneTopLeft);
         weatherOverlay->setOverlayRect(QRectF(0, 0, event->size().width(), event->size().height()));
     }
+    emit viewChanged(visibleSceneRect());
 }
 void MapWidget::leaveEvent(QEvent *event) { Q_UNUSED(event); fadeOutHoverItems(); }
 
@@ -707,13 +992,14 @@ int MapWidget::findNodeAt(const QPointF& pos)
 
 int MapWidget::findEdgeAt(const QPointF& pos, QPointF& closestPoint, int& outU, int& outV) {
     if (cachedEdges.isEmpty() || cachedNodes.isEmpty()) return -1;
-    QMap<int, Node> nodeMap; for (const auto& n : cachedNodes) nodeMap.insert(n.id, n);
     int bestIdx = -1; double bestDist = 1e18; QPointF bestPt; int bu=-1, bv=-1; 
     const double threshold = 20.0; 
     for (int i = 0; i < cachedEdges.size(); ++i) {
-        const auto& e = cachedEdges[i];
-        if (!nodeMap.contains(e.u) || !nodeMap.contains(e.v)) continue;
-        const auto& a = nodeMap[e.u]; const auto& b = nodeMap[e.v];
+        const auto& e = cachedEdges.at(i);
+        if (e.id < 0) continue;
+        const Node* na = cachedNode(e.u); const Node* nb = cachedNode(e.v);
+        if (!na || !nb) continue;
+        const Node& a = *na; const Node& b = *nb;
         QPointF p(pos.x(), pos.y()); QPointF A(a.x, a.y), B(b.x, b.y);
         QPointF AB = B - A; double ab2 = AB.x()*AB.x() + AB.y()*AB.y();
         if (ab2 <= 1e-6) continue;
@@ -727,6 +1013,10 @@ int MapWidget::findEdgeAt(const QPointF& pos, QPointF& closestPoint, int& outU,
     return -1;
 }
 
+const Node* MapWidget::cachedNode(int id) const {
+    return cachedNodes.find(id);
+}
+
 QPen MapWidget::edgePenForType(EdgeType type) const {
     QColor c(160, 160, 165); int width = 3;
     switch (type) {
@@ -867,7 +1157,7 @@ void MapWidget::showNodeHoverBubble(const Node& node) {
     const QColor bubbleColor(255, 255, 255, 215); 
     HoverBubble* hb = new HoverBubble();
     hb->setIsEdge(false); hb->setBaseColor(bubbleColor);
-    hb->setContent(node.name, node.description);
+    hb->setContent(node.name, m_nodeDescription ? m_nodeDescription(node.id) : node.description);
     hb->setCenterAt(QPointF(node.x, node.y));
     hb->setZValue(100);
     double screenW = this->viewport()->width();
@@ -888,34 +1178,31 @@ void MapWidget::showEdgeHoverBubble(const Edge& edge, const QPointF& closestPoin
 
     stopHoverAnimations(); killDyingItems(); clearHoverItems();
     
-    QMap<int, Node> nodeMap; 
-    for (const auto& n : cachedNodes) nodeMap.insert(n.id, n);
-
     QVector<const Edge*> sameNameEdges;
-    for (const auto& e : cachedEdges) {
-        if (e.name == edge.name) {
+    for (const auto& e : std::as_const(cachedEdges)) {
+        if (e.id >= 0 && e.name == edge.name) {
             sameNameEdges.append(&e);
         }
     }
 
     for (const Edge* e : sameNameEdges) {
-        if (!nodeMap.contains(e->u) || !nodeMap.contains(e->v)) continue;
-        Node u = nodeMap[e->u]; 
-        Node v = nodeMap[e->v];
-        auto* glow = new GlowItem(QPointF(u.x, u.y), QPointF(v.x, v.y), 24.0); 
+        const Node* u = cachedNode(e->u); const Node* v = cachedNode(e->v);
+        if (!u || !v) continue;
+        auto* glow = new GlowItem(QPointF(u->x, u->y), QPointF(v->x, v->y), 24.0); 
         scene->addItem(glow); 
         hoverItems.push_back(glow);
     }
 
-    if (!nodeMap.contains(edge.u) || !nodeMap.contains(edge.v)) return;
-    Node u = nodeMap[edge.u]; Node v = nodeMap[edge.v];
+    const Node* pu = cachedNode(edge.u); const Node* pv = cachedNode(edge.v);
+    if (!pu || !pv) return;
+    const Node u = *pu; const Node v = *pv;
 
     const QColor baseEdgeColor = edgePenForType(edge.type).color();
     QColor bubbleColor = baseEdgeColor.lighter(170); bubbleColor.setAlpha(225); 
     
     HoverBubble* hb = new HoverBubble();
     hb->setIsEdge(true); hb->setBaseColor(bubbleColor);
-    hb->setContent(edge.name, edge.description);
+    hb->setContent(edge.name, (m_edgeDescription && edge.id >= 0) ? m_edgeDescription(edge.id) : edge.description);
     
     QPointF A(u.x, u.y), B(v.x, v.y);
     hb->setEdgeLine(A, B);
@@ -932,9 +1219,10 @@ void MapWidget::showEdgeHoverBubble(const Edge& edge, const QPointF& closestPoin
 
 void MapWidget::setEditMode(EditMode mode) {
     currentMode = mode;
+    clearSelection();
     connectFirstNodeId = -1; setActiveEdge(-1, -1); 
     clearPathHighlight(); fadeOutHoverItems(); 
-    drawMap(cachedNodes, cachedEdges); 
+    rebuildScene(); 
 }
 
 // =========================================================
@@ -965,6 +1253,7 @@ void MapWidget::updateNodeHighlight(int nodeId, bool highlight)
             ellipse->setPen(p);
             ellipse->setBrush(QColor("#8E8E93")); // 浅灰色
             ellipse->setZValue(10);
+            if (islandNodeIds.contains(nodeId)) updateIslandLook(nodeId, true);
         }
     }
 }
\ No newline at end of file
@@ -7,16 +7,25 @@
 #include <QtWidgets/QGraphicsPathItem> 
 #include <QtWidgets/QGraphicsTextItem>
 #include <QtWidgets/QGraphicsEllipseItem> 
+#include <QtWidgets/QGraphicsRectItem>
 #include <QtGui/QMouseEvent>
 #include <QtGui/QWheelEvent>
 #include <QtCore/QTimer>
 #include <QtCore/QMap>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QtCore/QPointer>
 #include <QtCore/QVariantAnimation>
 #include <QtCore/QPropertyAnimation>
+#include <functional>
 #include "../GraphData.h"
+#include "../model/NodeTable.h"
 #include "WeatherOverlay.h" 
 
+class GraphModel;
+class GraphSnapshot;
+struct GraphDiff;
+
 enum class EditMode {
     None,           
     ConnectEdge,    
@@ -32,7 +41,13 @@ public:
 
     void setEditable(bool editable) { m_isEditable = editable; }
 
-    void drawMap(const QVector<Node>& nodes, const QVector<Edge>& edges);
+    // 整图重绘：节点表、道路表与快照共享存储，不复制
+    void drawMap(const GraphSnapshot& graph);
+    // 按一批编辑的结果增量更新场景：先删后改，changed 中不存在的对象视为新增
+    void applyGraphChanges(const QVector<int>& removedNodeIds, const QVector<int>& removedEdgeIds,
+                           const QVector<Node>& changedNodes, const QVector<Edge>& changedEdges);
+    // 同上，变化的 ID 先从模型换成最新的节点 / 道路（编辑器和主窗口共用）
+    void applyGraphDiff(const GraphDiff& diff, GraphModel* model);
     void setBackgroundImage(const QString& path);
     void setEditMode(EditMode mode);
     EditMode getEditMode() const { return currentMode; }
@@ -52,6 +67,22 @@ public:
     void pauseHoverAnimations();
     void resumeHoverAnimations();
 
+    // 当前视口在场景坐标中的范围（用于按需加载分区）
+    QRectF visibleSceneRect() const;
+
+    // 多选：框选 / Shift+点击得到的节点
+    QVector<int> selectedNodes() const;
+    void clearSelection();
+
+    // 连通性分析结果：孤岛节点与桥（道路 ID），传空集合即清除
+    void setConnectivityHighlight(const QSet<int>& islandNodes, const QSet<int>& bridgeEdges);
+
+    // 悬停气泡的描述按 ID 向模型要（分区模式下描述不随节点加载）；未设置时用缓存里自带的
+    void setDescriptionSource(std::function<QString(int)> nodeDesc, std::function<QString(int)> edgeDesc) {
+        m_nodeDescription = std::move(nodeDesc);
+        m_edgeDescription = std::move(edgeDesc);
+    }
+
 signals:
     void nodeClicked(int nodeId, QString name, bool isLeftClick);
     void nodeEditClicked(int nodeId, bool isCtrlPressed);
@@ -59,6 +90,9 @@ signals:
     void edgeConnectionRequested(int idA, int idB);
     void nodeMoved(int id, double x, double y);
     void undoRequested();
+    void viewChanged(const QRectF& visibleSceneRect);  // 平移 / 缩放 / 改变大小后发出
+    void selectionChanged(const QVector<int>& nodeIds); // 多选集合变化
+    void nodesMoved(const QVector<int>& nodeIds, double dx, double dy); // 整组拖动结束
 
 protected:
     void mousePressEvent(QMouseEvent *event) override;
@@ -84,8 +118,21 @@ private:
 
     bool m_isEditable = false;
 
-    QVector<Node> cachedNodes;
-    QVector<Edge> cachedEdges;
+    std::function<QString(int)> m_nodeDescription;  // 节点 ID -> 描述
+    std::function<QString(int)> m_edgeDescription;  // 道路 ID -> 描述
+
+    // 与模型快照隐式共享，增量更新或拖动时才各自分离
+    NodeTable cachedNodes;
+    QVector<Edge> cachedEdges;          // 可能含 id = -1 的墓碑，遍历时跳过
+    QHash<int, int> cachedEdgeIndex;    // 道路 ID -> cachedEdges 下标
+    const Node* cachedNode(int id) const;   // 按 ID 取缓存的节点，O(1)；不存在返回 nullptr
+
+    void rebuildScene();                    // 用缓存的节点和道路重建全部图元
+    void createNodeItems(const Node& n);
+    void removeNodeItems(int nodeId);
+    void placeNodeItems(const Node& n);
+    void createEdgeItem(const Edge& e);
+    void removeEdgeItem(int edgeId, int u, int v);
     
     int findNodeAt(const QPointF& pos);
     int findEdgeAt(const QPointF& pos, QPointF& closestPoint, int& outU, int& outV);
@@ -100,6 +147,25 @@ private:
     QPointF lastScenePos;
     
     int connectFirstNodeId = -1;
+
+    // --- 多选 ---
+    QSet<int> selectedNodeIds;
+    bool isRubberBanding = false;
+    bool rubberBandAdditive = false;
+    QPointF rubberOrigin;
+    QGraphicsRectItem* rubberBandItem = nullptr;
+    bool isGroupDragging = false;
+    QPointF groupDragOrigin;
+
+    void updateSelectionLook(int nodeId, bool selected);
+    void finishRubberBand(bool additive);
+
+    // --- 连通性高亮 ---
+    QSet<int> islandNodeIds;
+    QSet<int> bridgeEdgeIds;
+
+    void updateIslandLook(int nodeId, bool island);
+    void updateBridgeLook(int edgeId, bool bridge);
     QVector<QGraphicsItem*> editTempItems; 
 
     int activeEdgeU = -1;
@@ -115,9 +181,9 @@ private:
     
     QMap<int, QGraphicsEllipseItem*> nodeGraphicsItems; 
     QMap<int, QGraphicsTextItem*> nodeLabelItems; 
-    QMap<long long, QGraphicsLineItem*> edgeGraphicsItems; 
+    QMap<int, QGraphicsLineItem*> edgeGraphicsItems;    // 道路 ID -> 图元
     
-    QMap<int, QVector<long long>> nodeConnectedEdgeKeys;
+    QMap<int, QVector<int>> nodeConnectedEdgeIds;       // 节点 ID -> 相连道路 ID
 
     QVector<int> hiddenLabelNodeIds;
     QVector<QPointer<QAbstractAnimation>> hoverAnims;
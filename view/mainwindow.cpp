@@ -13,6 +13,8 @@
 #include <QtWidgets/QListWidget>
 #include <QtWidgets/QFrame>
 #include <QtWidgets/QButtonGroup>
+#include <QtWidgets/QMenu>
+#include <QtWidgets/QInputDialog>
 
 // ==========================================================================
 //  【辅助类】自动补零的 SpinBox (比如显示 08 而不是 8)
@@ -135,12 +137,20 @@ MainWindow::MainWindow(QWidget *parent)
     // 创建数据模型和地图组件
     model = new GraphModel();
     mapWidget = new MapWidget(this);
+
+    // 后台路径规划的结果回到界面线程处理
+    routeWatcher = new QFutureWatcher<QVector<PathRecommendation>>(this);
+    connect(routeWatcher, &QFutureWatcherBase::finished, this, &MainWindow::onRoutesReady);
     
     // 配置地图显示模式
     mapWidget->setEditMode(EditMode::None);  // 主界面不可编辑
     mapWidget->setShowEdges(false);          // 不显示所有边
     mapWidget->setNodeSizeMultiplier(2.0);   // 节点放大2倍
 
+    // 悬停气泡的描述按需向模型要（分区地图的描述不常驻内存）
+    mapWidget->setDescriptionSource([this](int id) { return model->nodeDescription(id); },
+                                    [this](int id) { return model->edgeDescription(id); });
+
     // 创建界面UI
     setupUi();
 
@@ -148,18 +158,33 @@ MainWindow::MainWindow(QWidget *parent)
     connect(mapWidget, &MapWidget::nodeClicked, this, &MainWindow::onMapNodeClicked);
     connect(openEditorBtn, &QPushButton::clicked, this, &MainWindow::onOpenEditor);
 
+    // 退出前写完后台排队中的保存
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+        model->flushPendingSaves();
+    });
+
     // 获取应用程序所在目录
     QString appDir = QCoreApplication::applicationDirPath();
     
     // 加载地图数据和校车时刻表
-    bool mapLoaded = model->loadData(appDir + "/Data/nodes.txt", appDir + "/Data/edges.txt");
+    // 如果存在分区索引，则按分区按需加载（多校区 / 城市级地图）
+    bool mapLoaded = false;
+    QString regionIndexPath = appDir + "/Data/regions/index.txt";
+    if (QFileInfo::exists(regionIndexPath))
+    {
+        mapLoaded = model->loadRegionIndex(regionIndexPath);
+    }
+    if (!mapLoaded)
+    {
+        mapLoaded = model->loadData(appDir + "/Data/nodes.txt", appDir + "/Data/edges.txt");
+    }
     bool scheduleLoaded = model->loadSchedule(appDir + "/Data/bus_schedule.csv");
 
     // 根据加载结果更新界面
     if (mapLoaded)
     {
         // 在地图上绘制节点和边
-        mapWidget->drawMap(model->getAllNodes(), model->getAllEdges());
+        mapWidget->drawMap(*model->snapshot());
         
         // 设置背景地图图片
         mapWidget->setBackgroundImage(appDir + "/Data/map.png");
@@ -173,6 +198,23 @@ MainWindow::MainWindow(QWidget *parent)
         {
             statusLabel->setText("注意：校车时刻表加载失败");
         }
+
+        // 分区模式：按视野加载分区；地图只读，不开放编辑器
+        if (model->isRegionMode())
+        {
+            connect(mapWidget, &MapWidget::viewChanged, this, &MainWindow::onMapViewChanged);
+            QTimer::singleShot(0, this, [this]() {
+                onMapViewChanged(mapWidget->visibleSceneRect());
+            });
+            openEditorBtn->setEnabled(false);
+            openEditorBtn->setToolTip("分区加载模式下地图只读，请在完整地图上编辑后重新切分");
+        }
+        // 单文件地图：Data 下的文件被外部改写时热重载，地图只按变化增量更新
+        else if (model->enableHotReload())
+        {
+            connect(model->notifier(), &GraphNotifier::graphChanged, this, &MainWindow::onGraphChanged);
+            connect(model->dataReloader(), &DataReloader::reloaded, this, &MainWindow::onDataReloaded);
+        }
     }
     else
     {
@@ -664,7 +706,16 @@ void MainWindow::setupUi() {
     statusLabel = new QLabel("Ready");
     statusLabel->setStyleSheet("color: #8E8E93; font-size: 12px; background: transparent;");
     
+    // 道路封闭：菜单每次弹出时按当前封闭集重建
+    closureBtn = new QPushButton("🚧 道路封闭");
+    closureBtn->setCursor(Qt::PointingHandCursor);
+    closureBtn->setStyleSheet(openEditorBtn->styleSheet());
+    QMenu* closureMenu = new QMenu(closureBtn);
+    closureBtn->setMenu(closureMenu);
+    connect(closureMenu, &QMenu::aboutToShow, this, &MainWindow::onClosureMenu);
+
     bottomLayout->addWidget(openEditorBtn);
+    bottomLayout->addWidget(closureBtn);
     bottomLayout->addWidget(statusLabel, 1);
     panelLayout->addLayout(bottomLayout);
 
@@ -780,7 +831,10 @@ void MainWindow::onModeSearch(TransportMode mode)
 
     // 调用核心算法：多策略路径推荐
     // 会返回最多3种方案：极限冲刺、懒人养生、经济适用
-    QVector<PathRecommendation> results = model->getMultiStrategyRoutes(
+    // 在后台线程上、针对发起时刻的图快照计算，编辑器可以同时修改地图；
+    // 再次查询时旧的结果会被丢弃
+    pendingSearchMode = mode;
+    routeWatcher->setFuture(model->getMultiStrategyRoutesAsync(
         currentStartId,
         currentEndId,
         currentWaypoints,
@@ -789,7 +843,20 @@ void MainWindow::onModeSearch(TransportMode mode)
         currentTime,
         classTime,
         checkLate
-    );
+    ));
+}
+
+// ============================================================
+// 后台路径规划完成
+// ============================================================
+void MainWindow::onRoutesReady()
+{
+    if (routeWatcher->isCanceled())
+    {
+        return;
+    }
+    QVector<PathRecommendation> results = routeWatcher->result();
+    TransportMode mode = pendingSearchMode;
 
     // 更新按钮样式：高亮当前交通方式
     QPushButton* currentModeButton = nullptr;
@@ -967,18 +1034,137 @@ void MainWindow::onOpenEditor()
     editor->show();
 }
 
+// ============================================================
+// 道路封闭菜单
+// 无障碍预设（整类封闭楼梯）、按路名封闭、逐个开关已有的封闭
+// ============================================================
+void MainWindow::onClosureMenu()
+{
+    const QString stairsName = "避开楼梯";
+    EdgeAccess& access = model->edgeAccess();
+    QMenu* menu = closureBtn->menu();
+    menu->clear();
+
+    QAction* stairsAction = menu->addAction("♿ 避开楼梯（无障碍）");
+    stairsAction->setCheckable(true);
+    stairsAction->setChecked(access.isActive(stairsName));
+    connect(stairsAction, &QAction::toggled, this, [this, stairsName](bool on) {
+        EdgeAccess& access = model->edgeAccess();
+        if (!access.names().contains(stairsName))
+        {
+            access.define(stairsName, {}, edgeTypeBit(EdgeType::Stairs));
+        }
+        access.setActive(stairsName, on);
+        applyClosureChange(on ? "已避开楼梯" : "已取消避开楼梯");
+    });
+
+    QAction* roadAction = menu->addAction("封闭道路…");
+    connect(roadAction, &QAction::triggered, this, [this]() {
+        bool ok = false;
+        QString road = QInputDialog::getText(this, "封闭道路", "路名（同名的全部路段都封闭）：",
+                                             QLineEdit::Normal, QString(), &ok).trimmed();
+        if (!ok || road.isEmpty())
+        {
+            return;
+        }
+        QString name = "封闭 " + road;
+        model->edgeAccess().defineRoads(name, {road});
+        model->edgeAccess().setActive(name, true);
+        applyClosureChange("已封闭：" + road);
+    });
+
+    // 已有的封闭：勾选表示启用
+    QStringList others = access.names();
+    others.removeAll(stairsName);
+    if (!others.isEmpty())
+    {
+        menu->addSeparator();
+        for (const QString& name : others)
+        {
+            QAction* action = menu->addAction(name);
+            action->setCheckable(true);
+            action->setChecked(access.isActive(name));
+            connect(action, &QAction::toggled, this, [this, name](bool on) {
+                model->edgeAccess().setActive(name, on);
+                applyClosureChange((on ? "已启用：" : "已停用：") + name);
+            });
+        }
+    }
+
+    if (!access.names().isEmpty())
+    {
+        menu->addSeparator();
+        QAction* clearAction = menu->addAction("清除全部封闭");
+        connect(clearAction, &QAction::triggered, this, [this]() {
+            EdgeAccess& access = model->edgeAccess();
+            for (const QString& name : access.names())
+            {
+                access.remove(name);
+            }
+            applyClosureChange("已清除全部封闭");
+        });
+    }
+}
+
+// ============================================================
+// 封闭变化后：提示，并按新的封闭重新规划正在显示的路线
+// ============================================================
+void MainWindow::applyClosureChange(const QString& status)
+{
+    statusLabel->setText(status);
+    if (!currentRecommendations.isEmpty() && currentStartId != -1 && currentEndId != -1)
+    {
+        onModeSearch(pendingSearchMode);
+    }
+}
+
 // ============================================================
 // 地图数据被编辑器修改后的回调
 // ============================================================
 void MainWindow::onMapDataChanged()
 {
     // 重新绘制地图
-    mapWidget->drawMap(model->getAllNodes(), model->getAllEdges());
+    mapWidget->drawMap(*model->snapshot());
     
     // 更新状态提示
     statusLabel->setText("地图数据已更新");
 }
 
+// ============================================================
+// 模型提交了一批变化（编辑器编辑或热重载）：增量更新地图
+// ============================================================
+void MainWindow::onGraphChanged(const GraphDiff& diff)
+{
+    mapWidget->applyGraphDiff(diff, model);
+}
+
+// ============================================================
+// 数据文件被外部改写并已重新加载
+// ============================================================
+void MainWindow::onDataReloaded(const ReloadDiff& diff)
+{
+    statusLabel->setText(QString("数据文件已更新：节点 %1 处、道路 %2 处、车站时刻 %3 处")
+                             .arg(diff.upsertNodes.size() + diff.removedNodes.size())
+                             .arg(diff.upsertEdges.size() + diff.removedEdges.size())
+                             .arg(diff.upsertSchedules.size() + diff.removedStations.size()));
+}
+
+// ============================================================
+// 视野变化：分区模式下加载进入视野的分区
+// ============================================================
+void MainWindow::onMapViewChanged(const QRectF& visibleRect)
+{
+    // 向外多加载半屏，平移时不容易看到空白
+    double mx = visibleRect.width() * 0.5;
+    double my = visibleRect.height() * 0.5;
+    QRectF area = visibleRect.adjusted(-mx, -my, mx, my);
+
+    if (model->ensureRegionsLoaded(area) > 0)
+    {
+        mapWidget->drawMap(*model->snapshot());
+    }
+}
+
 /**
  * @brief 处理地图节点点击事件
  * * 当用户在地图上点击某个节点（建筑物或路口）时，MapWidget 会发送此信号。